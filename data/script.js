@@ -488,22 +488,42 @@ class IgnitionController {
 let pollingInterval;
 let ignitionController;
 const POLLING_INTERVAL = 1000;
+let statusEvents = null;
+let lastStatus = {};
 
 document.addEventListener('DOMContentLoaded', function () {
     console.log('Bobcat Ignition Controller Initializing...');
     ignitionController = new IgnitionController();
-    startPolling();
-    // No initial status update call needed, interval handles it? 
-    // Better to call one immediately
-    updateStatus();
+    startStatusStream();
 });
 
+// The controller pushes a full status on connect, then only changed fields
+function startStatusStream() {
+    if (!window.EventSource) {
+        startPolling();
+        updateStatus();
+        return;
+    }
+    statusEvents = new EventSource('/events');
+    statusEvents.addEventListener('status', event => {
+        Object.assign(lastStatus, JSON.parse(event.data));
+        if (ignitionController && ignitionController.demoMode.active) return;
+        updateDashboard(lastStatus);
+    });
+    statusEvents.onopen = stopPolling;
+    // Poll while the browser reconnects the stream
+    statusEvents.onerror = () => {
+        if (!pollingInterval) startPolling();
+    };
+}
+
 function updateStatus() {
     if (ignitionController && ignitionController.demoMode.active) return;
 
     fetch('/status')
         .then(response => response.json())
         .then(data => {
+            lastStatus = data;
             updateDashboard(data);
         })
         .catch(error => {
@@ -619,7 +639,10 @@ function stopPolling() {
     }
 }
 
-window.addEventListener('beforeunload', stopPolling);
+window.addEventListener('beforeunload', () => {
+    stopPolling();
+    if (statusEvents) statusEvents.close();
+});
 
 // Prevent zoom on double-tap
 let lastTouchEnd = 0;
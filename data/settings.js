@@ -26,6 +26,7 @@ class SettingsManager {
         document.getElementById('minOilPressure').value = 69;
         document.getElementById('minVoltage').value = 11.0;
         document.getElementById('maxVoltage').value = 15.0;
+        document.getElementById('sleepWakeVoltage').value = 11.8;
         
         // Sensor Calibration (fuel low threshold only, calibration handled automatically)
         document.getElementById('fuelLowThreshold').value = 15;
@@ -45,12 +46,17 @@ class SettingsManager {
     if (this.settings.minOilPressure != null) document.getElementById('minOilPressure').value = this.settings.minOilPressure;
     if (this.settings.minVoltage != null) document.getElementById('minVoltage').value = this.settings.minVoltage;
     if (this.settings.maxVoltage != null) document.getElementById('maxVoltage').value = this.settings.maxVoltage;
+    if (this.settings.sleepWakeVoltage != null) document.getElementById('sleepWakeVoltage').value = this.settings.sleepWakeVoltage;
     if (this.settings.minHydPressure != null) {
         const el = document.getElementById('minHydPressure');
         if (el) el.value = this.settings.minHydPressure;
     }
         
         // WiFi Configuration (SSID only, never populate password for security)
+        if (this.settings.homeSSID != null) document.getElementById('homeSSID').value = this.settings.homeSSID;
+        for (const id of ['homeStaticIP', 'homeGateway', 'homeSubnet']) {
+            if (this.settings[id] != null) document.getElementById(id).value = this.settings[id];
+        }
         if (this.settings.wifiSSID) document.getElementById('wifiSSID').value = this.settings.wifiSSID;
         // Never populate password for security
         
@@ -94,8 +100,14 @@ class SettingsManager {
             minHydPressure: parseInt(document.getElementById('minHydPressure').value || '0'),
             minVoltage: parseFloat(document.getElementById('minVoltage').value),
             maxVoltage: parseFloat(document.getElementById('maxVoltage').value),
+            sleepWakeVoltage: parseFloat(document.getElementById('sleepWakeVoltage').value),
             
             // WiFi Configuration
+            homeSSID: document.getElementById('homeSSID').value,
+            homePassword: document.getElementById('homePassword').value,
+            homeStaticIP: document.getElementById('homeStaticIP').value.trim(),
+            homeGateway: document.getElementById('homeGateway').value.trim(),
+            homeSubnet: document.getElementById('homeSubnet').value.trim() || '255.255.255.0',
             wifiSSID: document.getElementById('wifiSSID').value,
             wifiPassword: document.getElementById('wifiPassword').value,
             
@@ -114,33 +126,41 @@ class SettingsManager {
                 return;
             }
 
-            // Post each field individually as { key, value } to match backend API
-            const posts = [];
-            const postSetting = (key, value) => fetch('/api/settings', {
+            // One request for every field; the controller validates them
+            // together and writes flash once
+            const batch = {
+                glowDuration: settings.glowDuration,
+                crankingTimeout: settings.crankingTimeout,
+                cooldownDuration: settings.cooldownDuration,
+                maxTemp: settings.maxTemp,
+                minOilPressure: settings.minOilPressure,
+                minVoltage: settings.minVoltage,
+                maxVoltage: settings.maxVoltage
+            };
+            if (!Number.isNaN(settings.sleepWakeVoltage)) batch.sleepWakeVoltage = settings.sleepWakeVoltage;
+            if (!Number.isNaN(settings.minHydPressure)) batch.minHydPressure = settings.minHydPressure;
+            // An empty home SSID means access point only
+            batch.homeSSID = settings.homeSSID;
+            if (settings.homePassword) batch.homePassword = settings.homePassword;
+            // Empty static IP = DHCP
+            batch.homeStaticIP = settings.homeStaticIP;
+            batch.homeGateway = settings.homeGateway;
+            batch.homeSubnet = settings.homeSubnet;
+            if (settings.wifiSSID) batch.wifiSSID = settings.wifiSSID;
+            if (settings.wifiPassword) batch.wifiPassword = settings.wifiPassword;
+            if (!Number.isNaN(settings.fuelLevelLowThreshold)) batch.fuelLevelLowThreshold = settings.fuelLevelLowThreshold;
+
+            const response = await fetch('/api/settings', {
                 method: 'POST',
                 headers: { 'Content-Type': 'application/json' },
-                body: JSON.stringify({ key, value: String(value) })
+                body: JSON.stringify(batch)
             });
-
-            posts.push(postSetting('glowDuration', settings.glowDuration));
-            posts.push(postSetting('crankingTimeout', settings.crankingTimeout));
-            posts.push(postSetting('cooldownDuration', settings.cooldownDuration));
-            posts.push(postSetting('maxTemp', settings.maxTemp));
-            posts.push(postSetting('minOilPressure', settings.minOilPressure));
-            posts.push(postSetting('minVoltage', settings.minVoltage));
-            posts.push(postSetting('maxVoltage', settings.maxVoltage));
-            if (!Number.isNaN(settings.minHydPressure)) posts.push(postSetting('minHydPressure', settings.minHydPressure));
-            if (settings.wifiSSID) posts.push(postSetting('wifiSSID', settings.wifiSSID));
-            if (settings.wifiPassword) posts.push(postSetting('wifiPassword', settings.wifiPassword));
-            if (!Number.isNaN(settings.fuelLevelLowThreshold)) posts.push(postSetting('fuelLevelLowThreshold', settings.fuelLevelLowThreshold));
-
-            const results = await Promise.all(posts.map(p => p.catch(e => e)));
-            const allOk = results.every(r => r && r.ok);
-            if (allOk) {
+            const result = await response.json().catch(() => ({}));
+            if (response.ok) {
                 this.showStatus('Settings saved successfully!', 'success');
                 this.settings = settings;
             } else {
-                this.showStatus('Some settings failed to save', 'error');
+                this.showStatus(result.message || 'Settings were not saved', 'error');
             }
         } catch (error) {
             console.error('Error saving settings:', error);
@@ -172,6 +192,7 @@ class SettingsManager {
         if (settings.minVoltage < 10.0 || settings.minVoltage > 13.0) return false;
         if (settings.maxVoltage < 13.0 || settings.maxVoltage > 16.0) return false;
         if (settings.maxVoltage <= settings.minVoltage) return false;
+        if (settings.sleepWakeVoltage < 0 || settings.sleepWakeVoltage > 14.0) return false;
         
         return true;
     }
@@ -253,9 +274,8 @@ class SettingsManager {
 document.addEventListener('DOMContentLoaded', () => {
     window.settingsManager = new SettingsManager();
     
-    // Update power status every 5 seconds
-    updatePowerStatus();
-    setInterval(updatePowerStatus, 5000);
+    // Power and WiFi status are pushed over /events (polled if the stream drops)
+    startStatusStream();
     
     // Start auto-refresh for sensor data
     refreshSensorData();
@@ -263,38 +283,68 @@ document.addEventListener('DOMContentLoaded', () => {
 
     // Initial load
     loadAllSettings();
-    updateWiFiStatus(); // Initial check
-
-    // Set up a timer to periodically update WiFi status
-    setInterval(updateWiFiStatus, 5000); // Update every 5 seconds
 });
 
-function updateWiFiStatus() {
+let statusEvents = null;
+let statusPollInterval = null;
+let lastStatus = {};
+
+function startStatusStream() {
+    if (!window.EventSource) {
+        pollStatus();
+        statusPollInterval = setInterval(pollStatus, 5000);
+        return;
+    }
+    statusEvents = new EventSource('/events');
+    statusEvents.addEventListener('status', event => {
+        Object.assign(lastStatus, JSON.parse(event.data));
+        renderStatus(lastStatus);
+    });
+    statusEvents.onopen = () => {
+        if (statusPollInterval) clearInterval(statusPollInterval);
+        statusPollInterval = null;
+    };
+    statusEvents.onerror = () => {
+        if (!statusPollInterval) statusPollInterval = setInterval(pollStatus, 5000);
+    };
+}
+
+function pollStatus() {
     fetch('/status')
         .then(response => response.json())
         .then(data => {
-            const homeStatusEl = document.getElementById('homeNetworkStatus');
-            if (data.wifi_connected) {
-                const ip = data.wifi_ip || 'connected';
-                homeStatusEl.textContent = `Connected (${ip})`;
-                homeStatusEl.classList.remove('error');
-                homeStatusEl.classList.add('success');
-            } else {
-                homeStatusEl.textContent = 'Not Connected';
-                homeStatusEl.classList.remove('success');
-                homeStatusEl.classList.add('error');
-            }
-
-            const apStatusEl = document.getElementById('apStatus');
-            apStatusEl.textContent = data.ap_ip ? `Active at ${data.ap_ip}` : 'AP Active';
+            lastStatus = data;
+            renderStatus(data);
         })
         .catch(error => {
-            console.error('Error fetching WiFi status:', error);
+            console.error('Error fetching status:', error);
             document.getElementById('homeNetworkStatus').textContent = 'Error';
             document.getElementById('apStatus').textContent = 'Error';
         });
 }
 
+function renderStatus(data) {
+    updateWiFiStatus(data);
+    updatePowerStatus(data);
+}
+
+function updateWiFiStatus(data) {
+    const homeStatusEl = document.getElementById('homeNetworkStatus');
+    if (data.wifi_connected) {
+        const ip = data.wifi_ip || 'connected';
+        homeStatusEl.textContent = `Connected (${ip})`;
+        homeStatusEl.classList.remove('error');
+        homeStatusEl.classList.add('success');
+    } else {
+        homeStatusEl.textContent = 'Not Connected';
+        homeStatusEl.classList.remove('success');
+        homeStatusEl.classList.add('error');
+    }
+
+    const apStatusEl = document.getElementById('apStatus');
+    apStatusEl.textContent = data.ap_ip ? `Active at ${data.ap_ip}` : 'AP Active';
+}
+
 function loadAllSettings() {
     fetch('/api/settings')
         .then(response => response.json())
@@ -499,11 +549,8 @@ function showAutoSaveStatus() {
 }
 
 // Power management functions
-async function updatePowerStatus() {
+function updatePowerStatus(data) {
     try {
-        const response = await fetch('/status');
-        const data = await response.json();
-
         // Update sleep mode status
         const sleepModeElement = document.getElementById('sleepStatus');
         if (sleepModeElement) {
@@ -539,7 +586,7 @@ async function toggleSleepMode() {
         const result = await response.json();
         if (result.success) {
             window.settingsManager.showStatus(result.message || 'Sleep mode toggled', 'success');
-            updatePowerStatus();
+            // The new sleep mode arrives over /events once the control loop applies it
         } else {
             window.settingsManager.showStatus('Failed to toggle sleep mode', 'error');
         }
@@ -0,0 +1,81 @@
+/*
+ * Host Arduino Shim for Bobcat Ignition Controller (env:native only)
+ * Just enough of the Arduino API for the control core to compile on Linux:
+ * types, pin constants, map() and a Serial that writes to stdout. Pin, ADC
+ * and clock access is deliberately absent - core code goes through hal.h.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define LOW          0x0
+#define HIGH         0x1
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// Serial on stdout. setEnabled(false) silences it for benchmarks.
+class HostSerial {
+public:
+    HostSerial() : enabled(true) {}
+
+    void begin(unsigned long) {}
+    void flush() { if (enabled) fflush(stdout); }
+    void setEnabled(bool on) { enabled = on; }
+
+    size_t write(uint8_t c) { return enabled ? fwrite(&c, 1, 1, stdout) : 1; }
+    size_t write(const uint8_t* data, size_t len) { return enabled ? fwrite(data, 1, len, stdout) : len; }
+
+    size_t print(const char* s) { return out("%s", s); }
+    size_t print(char c) { return out("%c", c); }
+    size_t print(int v) { return out("%d", v); }
+    size_t print(unsigned int v) { return out("%u", v); }
+    size_t print(long v) { return out("%ld", v); }
+    size_t print(unsigned long v) { return out("%lu", v); }
+    size_t print(double v, int digits = 2) { return out("%.*f", digits, v); }
+
+    size_t println() { return out("\r\n"); }
+    template <typename T>
+    size_t println(T v) { size_t n = print(v); return n + println(); }
+    size_t println(double v, int digits) { size_t n = print(v, digits); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        if (!enabled) {
+            return 0;
+        }
+        va_list args;
+        va_start(args, format);
+        int n = vprintf(format, args);
+        va_end(args);
+        return n > 0 ? n : 0;
+    }
+
+private:
+    bool enabled;
+
+    size_t out(const char* format, ...) {
+        if (!enabled) {
+            return 0;
+        }
+        va_list args;
+        va_start(args, format);
+        int n = vprintf(format, args);
+        va_end(args);
+        return n > 0 ? n : 0;
+    }
+};
+
+extern HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
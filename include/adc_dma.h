@@ -0,0 +1,25 @@
+/*
+ * Continuous ADC Engine Header for Bobcat Ignition Controller
+ * ADC1 runs in continuous (DMA) mode over all analog inputs; a reader task
+ * hands the conversions to adc_ingest.h, one lock-free ring per channel
+ */
+
+#ifndef ADC_DMA_H
+#define ADC_DMA_H
+
+#include <Arduino.h>
+#include "adc_ingest.h"
+
+// Configure ADC1 continuous mode and start the reader task.
+// Returns false if the driver could not be started (callers fall back to analogRead).
+bool startAdcDma();
+bool isAdcDmaRunning();
+
+// Stop the conversions and the reader task and release the driver (before
+// deep sleep)
+void stopAdcDma();
+
+// DMA frames handed over by the driver
+uint32_t adcDmaFramesRead();
+
+#endif // ADC_DMA_H
@@ -0,0 +1,53 @@
+/*
+ * ADC Sample Ingest Header for Bobcat Ignition Controller
+ * Raw ADC1 conversions, from the DMA reader task or any other source, are
+ * routed by channel into one AdcRing per analog input. No Arduino
+ * dependencies: the host runner feeds it from a fake source.
+ */
+
+#ifndef ADC_INGEST_H
+#define ADC_INGEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "adc_ring.h"
+
+// Analog inputs sampled by the engine (order matches ADC_DMA_PINS in adc_dma.cpp)
+enum AdcChannelId {
+    ADC_CH_BATTERY,
+    ADC_CH_ENGINE_TEMP,
+    ADC_CH_OIL_PRESSURE,
+    ADC_CH_FUEL_LEVEL,
+    ADC_CH_HYD_PRESSURE,
+    ADC_CHANNEL_COUNT
+};
+
+// ADC1 has channels 0-7
+constexpr uint8_t ADC1_CHANNEL_COUNT = 8;
+
+// Bytes per conversion in a DMA frame (ESP32 "type 1" format: a
+// little-endian word, channel in bits 12-15, 12-bit result below)
+constexpr size_t ADC_DMA_RESULT_BYTES = 2;
+
+// 256 samples per channel = 64 ms of history at the default 4 kHz per channel
+typedef AdcRing<256> AdcChannelRing;
+
+// ADC1 channel of each input, in AdcChannelId order. Until this is called
+// (or for a negative entry) conversions are dropped.
+void adcSetChannelMap(const int8_t adc1Channels[ADC_CHANNEL_COUNT]);
+
+// Producer only: one conversion, or a whole DMA frame of them. The frame
+// variant returns the number of conversions it held.
+void adcDmaIngestSample(uint8_t adc1Channel, uint16_t value);
+size_t adcDmaIngestFrame(const uint8_t* frame, size_t length);
+
+// Ring for one channel (always valid, empty until samples arrive)
+const AdcChannelRing& adcRing(AdcChannelId channel);
+
+// Mean of the most recent `samples` conversions on a channel
+uint16_t adcAverage(AdcChannelId channel, size_t samples);
+
+// Conversions on channels we don't sample
+uint32_t adcDmaSamplesDropped();
+
+#endif // ADC_INGEST_H
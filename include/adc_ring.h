@@ -0,0 +1,122 @@
+/*
+ * ADC Sample Ring for Bobcat Ignition Controller
+ * Lock-free single-producer ring of 12-bit samples with window and
+ * decimated-average readers. No Arduino dependencies.
+ */
+
+#ifndef ADC_RING_H
+#define ADC_RING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// One producer (the DMA reader task) pushes, any number of consumers read.
+// Readers copy from the tail of the ring and retry if the producer lapped
+// the region they were copying, so they never see a torn window.
+template <size_t N>
+class AdcRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "Ring size must be a power of two");
+
+public:
+    AdcRing() : written(0) {
+        for (size_t i = 0; i < N; i++) {
+            samples[i] = 0;
+        }
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+    // Producer only
+    void push(uint16_t sample) {
+        uint32_t index = written.load(std::memory_order_relaxed);
+        samples[index & (N - 1)] = sample;
+        written.store(index + 1, std::memory_order_release);
+    }
+
+    // Total samples ever pushed (wraps at 2^32)
+    uint32_t count() const {
+        return written.load(std::memory_order_acquire);
+    }
+
+    // Copy the most recent samples, oldest first. Returns how many were copied.
+    size_t window(uint16_t* out, size_t maxSamples) const {
+        for (;;) {
+            uint32_t end = written.load(std::memory_order_acquire);
+            size_t available = readable(end);
+            size_t n = maxSamples < available ? maxSamples : available;
+            uint32_t start = end - n;
+            for (size_t i = 0; i < n; i++) {
+                out[i] = samples[(start + i) & (N - 1)];
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!lapped(start)) {
+                return n;
+            }
+        }
+    }
+
+    // Mean of the most recent samples (0 if the ring is empty)
+    uint16_t average(size_t maxSamples) const {
+        for (;;) {
+            uint32_t end = written.load(std::memory_order_acquire);
+            size_t available = readable(end);
+            size_t n = maxSamples < available ? maxSamples : available;
+            if (n == 0) {
+                return 0;
+            }
+            uint32_t start = end - n;
+            uint32_t sum = 0;
+            for (size_t i = 0; i < n; i++) {
+                sum += samples[(start + i) & (N - 1)];
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!lapped(start)) {
+                return (uint16_t)((sum + n / 2) / n);
+            }
+        }
+    }
+
+    // Boxcar-decimate the most recent (outCount * factor) samples into
+    // outCount averages, oldest first. Returns how many outputs were written.
+    size_t decimate(uint16_t* out, size_t outCount, size_t factor) const {
+        if (factor == 0) {
+            return 0;
+        }
+        for (;;) {
+            uint32_t end = written.load(std::memory_order_acquire);
+            size_t available = readable(end) / factor;
+            size_t n = outCount < available ? outCount : available;
+            uint32_t start = end - n * factor;
+            for (size_t i = 0; i < n; i++) {
+                uint32_t sum = 0;
+                for (size_t j = 0; j < factor; j++) {
+                    sum += samples[(start + i * factor + j) & (N - 1)];
+                }
+                out[i] = (uint16_t)((sum + factor / 2) / factor);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!lapped(start)) {
+                return n;
+            }
+        }
+    }
+
+private:
+    // Readers see at most N - 1 samples: slot `written` aliases the oldest
+    // one and may be mid-write by the producer.
+    static size_t readable(uint32_t end) {
+        return end < N - 1 ? end : N - 1;
+    }
+
+    // True if the producer may have overwritten the slot at `start` while we read
+    bool lapped(uint32_t start) const {
+        uint32_t now = written.load(std::memory_order_relaxed);
+        return (uint32_t)(now - start) >= N;
+    }
+
+    uint16_t samples[N];
+    std::atomic<uint32_t> written;
+};
+
+#endif // ADC_RING_H
@@ -0,0 +1,90 @@
+/*
+ * Boot Profile Header for Bobcat Ignition Controller
+ * Where boot time goes: the duration of each setup() phase and the uptime
+ * at which the controller became usable (HTTP server up, first control
+ * tick, home network address). The profile lives in uninitialized RTC
+ * memory, so after a reboot or a deep sleep wake the previous boot's
+ * profile is still there
+ * to compare against. Served at /api/boot-profile and printed at the end
+ * of setup().
+ */
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stdint.h>
+#include "json_writer.h"
+
+// X(id, JSON key) - in boot order
+#define BOOT_PHASES(X) \
+  X(BOOT_PHASE_CORE,           "core")            /* App start to setup(): Arduino core, constructors */ \
+  X(BOOT_PHASE_CONSOLE,        "console")         /* Serial.begin(), log task */ \
+  X(BOOT_PHASE_WAKE,           "wake")            /* Wake-up cause, resume block */ \
+  X(BOOT_PHASE_SETTINGS,       "settings")        /* g_settingsManager.begin(): NVS open and read */ \
+  X(BOOT_PHASE_SETTINGS_PRINT, "settings_print")  /* Every setting printed to Serial */ \
+  X(BOOT_PHASE_PINS,           "pins")            /* initializePins(), calibration from NVS */ \
+  X(BOOT_PHASE_SENSORS,        "sensors")         /* Sampling task, ADC DMA, sleep mode */ \
+  X(BOOT_PHASE_FILESYSTEM,     "filesystem")      /* LittleFS.begin() */ \
+  X(BOOT_PHASE_WIFI_AP,        "wifi_ap")         /* WiFi mode, access point, station task */ \
+  X(BOOT_PHASE_ROUTES,         "routes")          /* Web handlers, ElegantOTA */ \
+  X(BOOT_PHASE_SERVER,         "server")          /* server.begin() */ \
+  X(BOOT_PHASE_OTA,            "ota")             /* ArduinoOTA configuration */
+
+#define BOOT_MILESTONES(X) \
+  X(BOOT_SETUP_DONE,  "setup_done_us")   /* setup() returned */ \
+  X(BOOT_HTTP_READY,  "http_ready_us")   /* server.begin() returned */ \
+  X(BOOT_FIRST_TICK,  "first_tick_us")   /* First control tick completed */ \
+  X(BOOT_STATION_IP,  "station_ip_us")   /* Home network address obtained */
+
+#define BOOT_ENUM_ENTRY(id, key) id,
+enum BootPhase : uint8_t { BOOT_PHASES(BOOT_ENUM_ENTRY) BOOT_PHASE_COUNT };
+enum BootMilestone : uint8_t { BOOT_MILESTONES(BOOT_ENUM_ENTRY) BOOT_MILESTONE_COUNT };
+#undef BOOT_ENUM_ENTRY
+
+#define BOOT_KEY_ENTRY(id, key) JSON_KEY(key),
+constexpr JsonKey BOOT_PHASE_KEYS[] = { BOOT_PHASES(BOOT_KEY_ENTRY) };
+constexpr JsonKey BOOT_MILESTONE_KEYS[] = { BOOT_MILESTONES(BOOT_KEY_ENTRY) };
+#undef BOOT_KEY_ENTRY
+
+// Times are µs of uptime, which starts with the application clock (after
+// the bootloader); 0 = not reached
+struct BootProfile {
+  uint32_t phaseUs[BOOT_PHASE_COUNT];          // Duration
+  uint32_t milestoneUs[BOOT_MILESTONE_COUNT];  // Uptime when reached
+  uint32_t bootCount;                          // Boots since power-on
+  bool wake;                                   // Boot was a deep sleep wake
+};
+
+// First thing in setup(): moves the last boot's profile aside and starts a
+// new one (records BOOT_PHASE_CORE)
+void startBootProfile(bool wake);
+
+// Phases may be skipped but not nested
+void startBootPhase(BootPhase phase);
+void endBootPhase(BootPhase phase);
+
+// Record the current uptime for `milestone`; only the first call counts
+void markBootMilestone(BootMilestone milestone);
+uint32_t bootMilestoneUs(BootMilestone milestone);
+
+bool bootFromDeepSleep();
+BootProfile currentBootProfile();
+bool previousBootProfile(BootProfile& profile);   // False after a power-on
+
+void printBootProfile();   // Serial, one line per phase
+
+template <typename Sink>
+void writeBootProfileJson(JsonWriter<Sink>& json, const BootProfile& profile) {
+  json.field(JSON_KEY("boot_count"), (unsigned long)profile.bootCount);
+  json.field(JSON_KEY("wake"), profile.wake);
+  json.beginObject(JSON_KEY("phases_us"));
+  for (uint8_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+    json.field(BOOT_PHASE_KEYS[i], (unsigned long)profile.phaseUs[i]);
+  }
+  json.endObject();
+  for (uint8_t i = 0; i < BOOT_MILESTONE_COUNT; i++) {
+    json.field(BOOT_MILESTONE_KEYS[i], (unsigned long)profile.milestoneUs[i]);
+  }
+}
+
+#endif // BOOT_PROFILE_H
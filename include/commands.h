@@ -0,0 +1,58 @@
+/*
+ * Control Command Queue Header for Bobcat Ignition Controller
+ * Web handlers submit typed commands; the control loop applies them in
+ * order at the top of each tick, one state machine step per command, and
+ * records the outcome of each one
+ */
+
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include <Arduino.h>
+
+enum CommandType : uint8_t {
+  CMD_KEY_POSITION,       // arg = position 0-3
+  CMD_KEY_START_HOLD,     // arg = 1 held, 0 released
+  CMD_EMERGENCY_STOP,
+  CMD_TOGGLE_LIGHTS,
+  CMD_LEGACY_START,       // virtualStartButton()
+  CMD_POWER_ON,
+  CMD_POWER_OFF,
+  CMD_OVERRIDE_START,
+  CMD_TOGGLE_SLEEP_MODE,
+  CMD_SLEEP_NOW
+};
+
+enum CommandResult : uint8_t {
+  CMD_RESULT_PENDING,     // Queued, not yet applied by the control loop
+  CMD_RESULT_APPLIED,
+  CMD_RESULT_REJECTED,    // Control loop refused it (e.g. unsafe to sleep)
+  CMD_RESULT_UNKNOWN      // Too old to still be tracked, or never issued
+};
+
+struct Command {
+  CommandType type;
+  int32_t arg;
+};
+
+// Any task. Returns the command's sequence number, or 0 if the queue is full.
+// Sequences are the commands' places in the queue, so they are applied in
+// sequence order even when several tasks submit at once.
+uint32_t submitCommand(CommandType type, int32_t arg = 0);
+
+// Control loop only: apply every queued command in submission order and
+// run `step` (one ignition state machine step) after each, so edges - a
+// light toggle, a start press and release, a key move - are executed one by
+// one rather than merged. Returns the number of commands processed.
+uint32_t processPendingCommands(void (*step)());
+
+// Outcome of a submitted command (recent commands only)
+CommandResult getCommandResult(uint32_t sequence);
+const char* commandResultToString(CommandResult result);
+
+// Queue statistics. Every command up to the last applied sequence has
+// been applied (it never moves backwards).
+uint32_t lastAppliedCommandSequence();
+uint32_t commandsDropped();
+
+#endif // COMMANDS_H
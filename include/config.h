@@ -7,6 +7,9 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 // ============================================================================
 // DIGITAL OUTPUT PINS - Relay Control (Active HIGH) - LILYGO T-Relay 4-Channel
 // ============================================================================
@@ -49,6 +52,23 @@ extern const int SLEEP_ENABLE_PIN;         // GPIO12 - Enable deep sleep mode (o
 // ============================================================================
 extern const unsigned long SLEEP_TIMEOUT;         // Time before auto-sleep (milliseconds)
 extern const unsigned long ACTIVITY_TIMEOUT;      // Inactivity timeout for sleep (milliseconds)
+extern const unsigned long SLEEP_BOOT_GRACE_PERIOD; // No auto-sleep right after boot (milliseconds)
+
+// ============================================================================
+// POWER PROFILES (between deep sleeps, power_manager.h)
+// ============================================================================
+extern const int POWER_FULL_CPU_MHZ;          // CPU clock while a profile holds the locks
+extern const int POWER_IDLE_CPU_MAX_MHZ;      // Idle: highest clock under frequency scaling
+extern const int POWER_IDLE_CPU_MIN_MHZ;      // Idle: clock when no lock is held (XTAL)
+extern const float POWER_IDLE_CURRENT_MA;     // Nominal supply current per profile (mA), for /api/power
+extern const float POWER_CLIENT_CURRENT_MA;
+extern const float POWER_ENGINE_CURRENT_MA;
+
+// ============================================================================
+// DEEP SLEEP MONITOR (ULP coprocessor, ulp_monitor.h)
+// ============================================================================
+extern const unsigned long ULP_SAMPLE_INTERVAL;   // Battery sample and seat bar poll period (ms)
+extern const unsigned long ULP_HISTORY_WINDOW;    // Span of one battery min/max history entry (ms)
 
 // ============================================================================
 // DIESEL ENGINE TIMING CONSTANTS
@@ -56,6 +76,63 @@ extern const unsigned long ACTIVITY_TIMEOUT;      // Inactivity timeout for slee
 extern const unsigned long GLOW_PLUG_DURATION;    // Glow plug preheat time
 extern const unsigned long IGNITION_TIMEOUT;      // Max cranking time
 extern const unsigned long COOLDOWN_DURATION;     // Post-shutdown cooldown
+extern const unsigned long GLOW_COUNTDOWN_INTERVAL; // Glow plug countdown message period
+
+// ============================================================================
+// CONTROL LOOP SCHEDULING
+// ============================================================================
+extern const unsigned long CONTROL_HOUSEKEEPING_INTERVAL; // Max time the control task sleeps without a deadline
+
+// ============================================================================
+// CONTROL TASK AND CORE PLACEMENT
+// ============================================================================
+extern const int CONTROL_CORE;                     // Control task, sensor sampling, ADC DMA
+extern const int NETWORK_CORE;                     // WiFi, web server, OTA, logging, status, settings, station
+extern const int CONTROL_TASK_PRIORITY;
+extern const uint32_t CONTROL_TASK_STACK_SIZE;
+extern const unsigned long OTA_POLL_INTERVAL;      // loop() period: OTA only (ms)
+
+// ============================================================================
+// SENSOR SAMPLING TASK
+// ============================================================================
+extern const unsigned long SENSOR_SAMPLE_INTERVAL; // Fixed sampling period (milliseconds)
+extern const int SENSOR_TASK_PRIORITY;             // FreeRTOS priority of the sampling task
+extern const uint32_t SENSOR_TASK_STACK_SIZE;      // Sampling task stack (bytes)
+extern const uint32_t ADC_DMA_SAMPLE_RATE;         // Continuous ADC1 conversion rate, all channels (Hz)
+extern const size_t ADC_DMA_AVERAGE_SAMPLES;       // Conversions averaged per published sample
+
+// ============================================================================
+// LOGGING
+// ============================================================================
+extern const int LOG_TASK_PRIORITY;                // FreeRTOS priority of the log drain task
+extern const uint32_t LOG_TASK_STACK_SIZE;         // Log drain task stack (bytes)
+extern const size_t TRACE_BUFFER_SIZE;             // Control input trace ring (bytes, two segments)
+
+// ============================================================================
+// WEB STATUS PUSH (/events)
+// ============================================================================
+extern const unsigned long STATUS_STATE_POLL_INTERVAL;   // State/relay change detection period (ms)
+extern const unsigned long STATUS_SENSOR_PUSH_INTERVAL;  // Sensor/timer/WiFi field push period (ms)
+extern const unsigned long STATUS_LONG_POLL_TIMEOUT;     // Longest a /status?since= request is held (ms)
+extern const int STATUS_PUSH_TASK_PRIORITY;
+extern const uint32_t STATUS_PUSH_TASK_STACK_SIZE;
+
+// ============================================================================
+// SETTINGS STORAGE
+// ============================================================================
+extern const unsigned long SETTINGS_COMMIT_DELAY;  // Quiet period before changed settings are written to flash (ms)
+extern const int SETTINGS_TASK_PRIORITY;
+extern const uint32_t SETTINGS_TASK_STACK_SIZE;
+
+// ============================================================================
+// WIFI STATION (home network)
+// ============================================================================
+extern const unsigned long WIFI_RECONNECT_MIN_DELAY;  // First retry after a drop or failed attempt (ms)
+extern const unsigned long WIFI_RECONNECT_MAX_DELAY;  // Backoff ceiling (ms)
+extern const unsigned long WIFI_ATTEMPT_TIMEOUT;      // Attempt without GOT_IP or a disconnect counts as a drop (ms)
+extern const int WIFI_TASK_PRIORITY;
+extern const uint32_t WIFI_TASK_STACK_SIZE;
+
 // SENSOR CALIBRATION CONSTANTS - Only for sensors we're using
 // ============================================================================
 extern const float TEMP_SENSOR_OFFSET;       // Temperature sensor offset (°C)
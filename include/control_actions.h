@@ -0,0 +1,237 @@
+/*
+ * Control Actions Table for Bobcat Ignition Controller
+ * The /control vocabulary, declared once at compile time. An action name
+ * is found with one perfect-hash probe and one compare, and the request
+ * body is scanned in place - no document, no String, no heap.
+ */
+
+#ifndef CONTROL_ACTIONS_H
+#define CONTROL_ACTIONS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "commands.h"
+
+namespace ControlActions {
+
+// What the handler reads from the body into the command argument
+enum Arg : uint8_t {
+  ARG_NONE,
+  ARG_POSITION,   // "position": 0-3
+  ARG_HELD        // "held": true/false
+};
+
+struct Action {
+  const char* name;
+  uint8_t length;
+  CommandType command;
+  Arg arg;
+  const char* message;   // Reply on success (nullptr = built by the handler)
+};
+
+constexpr uint8_t length(const char* s) {
+  return *s ? 1 + length(s + 1) : 0;
+}
+
+constexpr Action A(const char* name, CommandType command, Arg arg, const char* message) {
+  return Action{name, length(name), command, arg, message};
+}
+
+constexpr Action ACTIONS[] = {
+  A("key_position",      CMD_KEY_POSITION,      ARG_POSITION, nullptr),
+  A("key_start_hold",    CMD_KEY_START_HOLD,    ARG_HELD,     nullptr),
+  A("emergency_stop",    CMD_EMERGENCY_STOP,    ARG_NONE,     "Emergency stop activated"),
+  A("lights",            CMD_TOGGLE_LIGHTS,     ARG_NONE,     "Lights toggled"),
+  A("start",             CMD_LEGACY_START,      ARG_NONE,     "Legacy start command"),
+  A("power_on",          CMD_POWER_ON,          ARG_NONE,     "Legacy power on command"),
+  A("shutdown",          CMD_POWER_OFF,         ARG_NONE,     "Legacy shutdown command"),
+  A("override",          CMD_OVERRIDE_START,    ARG_NONE,     "Override start command"),
+  A("sleep_now",         CMD_SLEEP_NOW,         ARG_NONE,     "Entering sleep mode immediately"),
+  A("toggle_sleep_mode", CMD_TOGGLE_SLEEP_MODE, ARG_NONE,     nullptr),
+};
+
+constexpr uint8_t ACTION_COUNT = sizeof(ACTIONS) / sizeof(ACTIONS[0]);
+constexpr uint8_t SLOT_COUNT = 16;
+constexpr int8_t NO_ACTION = -1;
+
+// Length, first and last character; unique for every name (checked below)
+constexpr uint8_t hash(const char* name, uint8_t len) {
+  return (uint8_t)(len + (uint8_t)name[0] * 7 + (uint8_t)name[len - 1] * 2) % SLOT_COUNT;
+}
+
+struct Slots {
+  int8_t action[SLOT_COUNT];
+};
+
+constexpr Slots buildSlots() {
+  Slots slots = {};
+  for (uint8_t s = 0; s < SLOT_COUNT; s++) {
+    slots.action[s] = NO_ACTION;
+  }
+  for (uint8_t i = 0; i < ACTION_COUNT; i++) {
+    slots.action[hash(ACTIONS[i].name, ACTIONS[i].length)] = i;
+  }
+  return slots;
+}
+
+constexpr Slots SLOTS = buildSlots();
+
+// ---------------------------------------------------------------------------
+// Compile-time checks
+// ---------------------------------------------------------------------------
+constexpr bool perfectHash() {
+  for (uint8_t i = 0; i < ACTION_COUNT; i++) {
+    if (SLOTS.action[hash(ACTIONS[i].name, ACTIONS[i].length)] != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(ACTION_COUNT <= SLOT_COUNT, "More control actions than hash slots");
+static_assert(perfectHash(), "Two control actions share a hash slot - change the multipliers in hash()");
+
+// ---------------------------------------------------------------------------
+// Lookup and body parsing
+// ---------------------------------------------------------------------------
+inline const Action* find(const char* name, size_t len) {
+  if (len == 0 || len > 255) {
+    return nullptr;
+  }
+  int8_t i = SLOTS.action[hash(name, (uint8_t)len)];
+  if (i == NO_ACTION || ACTIONS[i].length != len || memcmp(ACTIONS[i].name, name, len) != 0) {
+    return nullptr;
+  }
+  return &ACTIONS[i];
+}
+
+// Fields of a /control body; `action` points into the request buffer
+struct Request {
+  const char* action;
+  size_t actionLength;
+  int32_t position;   // 0 when absent, -1 when not an integer
+  bool held;
+};
+
+inline const char* skipSpace(const char* p, const char* end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+    p++;
+  }
+  return p;
+}
+
+// A string without escapes (none of the keys or actions need them)
+inline const char* scanString(const char* p, const char* end, const char*& text, size_t& len) {
+  if (p >= end || *p != '"') {
+    return nullptr;
+  }
+  text = ++p;
+  while (p < end && *p != '"') {
+    if (*p == '\\') {
+      return nullptr;
+    }
+    p++;
+  }
+  if (p >= end) {
+    return nullptr;
+  }
+  len = p - text;
+  return p + 1;
+}
+
+inline bool equals(const char* text, size_t len, const char* literal) {
+  return strlen(literal) == len && memcmp(text, literal, len) == 0;
+}
+
+inline int32_t parseInt(const char* text, size_t len) {
+  size_t i = (len > 0 && text[0] == '-') ? 1 : 0;
+  if (i == len || len - i > 9) {
+    return -1;
+  }
+  int32_t value = 0;
+  for (; i < len; i++) {
+    if (text[i] < '0' || text[i] > '9') {
+      return -1;
+    }
+    value = value * 10 + (text[i] - '0');
+  }
+  return text[0] == '-' ? -value : value;
+}
+
+// Flat object of strings, numbers and literals; false on anything else.
+// Unknown keys are skipped.
+inline bool parse(const char* body, size_t len, Request& request) {
+  request = Request{nullptr, 0, 0, false};
+  const char* end = body + len;
+  const char* p = skipSpace(body, end);
+  if (p >= end || *p++ != '{') {
+    return false;
+  }
+  p = skipSpace(p, end);
+  if (p < end && *p == '}') {
+    return true;
+  }
+  for (;;) {
+    const char* key;
+    size_t keyLength;
+    p = scanString(skipSpace(p, end), end, key, keyLength);
+    if (p == nullptr) {
+      return false;
+    }
+    p = skipSpace(p, end);
+    if (p >= end || *p++ != ':') {
+      return false;
+    }
+    p = skipSpace(p, end);
+
+    const char* value;
+    size_t valueLength;
+    bool quoted = p < end && *p == '"';
+    if (quoted) {
+      p = scanString(p, end, value, valueLength);
+      if (p == nullptr) {
+        return false;
+      }
+    } else {
+      value = p;
+      while (p < end && *p != ',' && *p != '}' && *p != ' ' && *p != '\r' && *p != '\n' && *p != '\t') {
+        if (*p == '{' || *p == '[' || *p == '"') {
+          return false;
+        }
+        p++;
+      }
+      valueLength = p - value;
+      if (valueLength == 0) {
+        return false;
+      }
+    }
+
+    if (equals(key, keyLength, "action")) {
+      if (!quoted) {
+        return false;
+      }
+      request.action = value;
+      request.actionLength = valueLength;
+    } else if (equals(key, keyLength, "position")) {
+      request.position = quoted ? -1 : parseInt(value, valueLength);
+    } else if (equals(key, keyLength, "held")) {
+      request.held = !quoted && equals(value, valueLength, "true");
+    }
+
+    p = skipSpace(p, end);
+    if (p >= end) {
+      return false;
+    }
+    if (*p == '}') {
+      return true;
+    }
+    if (*p++ != ',') {
+      return false;
+    }
+  }
+}
+
+} // namespace ControlActions
+
+#endif // CONTROL_ACTIONS_H
@@ -0,0 +1,98 @@
+/*
+ * Control Loop Scheduler Header for Bobcat Ignition Controller
+ * The control loop sleeps until its next known deadline (glow expiry,
+ * crank timeout, countdown, sleep timeout, housekeeping) or until an
+ * incoming command or a change of a digital input wakes it, instead of
+ * polling every 10 ms
+ */
+
+#ifndef CONTROL_SCHEDULER_H
+#define CONTROL_SCHEDULER_H
+
+#include <stdint.h>
+
+enum ControlTimer : uint8_t {
+  TIMER_GLOW_EXPIRY,       // Glow plugs reach GLOW_PLUG_DURATION
+  TIMER_CRANK_TIMEOUT,     // Starter reaches IGNITION_TIMEOUT
+  TIMER_GLOW_COUNTDOWN,    // Next glow countdown message
+  TIMER_SLEEP,             // Inactivity sleep timeout
+  TIMER_HOUSEKEEPING,      // Safety checks on the analog readings
+  CONTROL_TIMER_COUNT
+};
+
+// Set of one-shot deadlines keyed by ControlTimer, on a wrapping millisecond
+// clock supplied by the caller. With a handful of fixed timers a linear scan
+// beats a heap, and arming/cancelling is O(1).
+class DeadlineScheduler {
+public:
+  DeadlineScheduler() : armedMask(0) {}
+
+  void arm(ControlTimer timer, uint32_t due) {
+    deadlines[timer] = due;
+    armedMask |= 1u << timer;
+  }
+
+  void cancel(ControlTimer timer) {
+    armedMask &= ~(1u << timer);
+  }
+
+  bool isArmed(ControlTimer timer) const {
+    return (armedMask >> timer) & 1u;
+  }
+
+  // Milliseconds from `now` until the earliest armed deadline, capped at
+  // maxWait (0 if a deadline is already due)
+  uint32_t timeUntilNext(uint32_t now, uint32_t maxWait) const {
+    uint32_t wait = maxWait;
+    for (uint8_t t = 0; t < CONTROL_TIMER_COUNT; t++) {
+      if (!((armedMask >> t) & 1u)) {
+        continue;
+      }
+      int32_t remaining = (int32_t)(deadlines[t] - now);
+      if (remaining <= 0) {
+        return 0;
+      }
+      if ((uint32_t)remaining < wait) {
+        wait = remaining;
+      }
+    }
+    return wait;
+  }
+
+  // Disarm and return (as a bit mask) every timer that is due at `now`
+  uint32_t takeExpired(uint32_t now) {
+    uint32_t expired = 0;
+    for (uint8_t t = 0; t < CONTROL_TIMER_COUNT; t++) {
+      if (((armedMask >> t) & 1u) && (int32_t)(deadlines[t] - now) <= 0) {
+        expired |= 1u << t;
+      }
+    }
+    armedMask &= ~expired;
+    return expired;
+  }
+
+private:
+  uint32_t deadlines[CONTROL_TIMER_COUNT];
+  uint32_t armedMask;
+};
+
+// One control-loop pass: sleep check, queued commands, ignition state
+// machine, engine vitals and safety checks (shared by the control task and
+// host runners)
+void runControlTick();
+
+// Call once from the task that runs the control loop
+void registerControlTask();
+
+// Any task: wake the control loop now (a command was queued, an input changed)
+void wakeControlLoop();
+
+// Re-arm the control deadlines from the current g_systemState
+void scheduleControlDeadlines();
+
+// Block the control task until the next deadline or a wake-up, recording
+// the pass that just ended and how late a deadline wake-up was
+// (task_monitor.h). Returns the mask of timers that expired.
+uint32_t waitForNextControlEvent();
+
+#endif // CONTROL_SCHEDULER_H
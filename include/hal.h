@@ -0,0 +1,95 @@
+/*
+ * Hardware Abstraction Layer Header for Bobcat Ignition Controller
+ * Clock, GPIO, ADC, NVS and CRC32 access for the control core. On the ESP32 these
+ * are inline forwards to the Arduino core; the host build (env:native)
+ * links src/host/hal_host.cpp instead, with a virtual clock and simulated
+ * pins, so the state machine and conversions run unmodified on Linux.
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Pin levels and modes (same values as the Arduino core)
+static const uint8_t HAL_LOW = 0;
+static const uint8_t HAL_HIGH = 1;
+
+#ifdef ARDUINO
+// ============================================================================
+// ESP32 - thin inline forwards, no overhead on the relay path
+// ============================================================================
+#include <Arduino.h>
+#include <Preferences.h>
+#include <esp_rom_crc.h>
+
+inline uint32_t halMillis() { return millis(); }
+inline uint32_t halMicros() { return micros(); }
+inline void halDelay(uint32_t ms) { delay(ms); }
+inline void halPinMode(uint8_t pin, uint8_t mode) { pinMode(pin, mode); }
+inline void halDigitalWrite(uint8_t pin, uint8_t level) { digitalWrite(pin, level); }
+inline int halDigitalRead(uint8_t pin) { return digitalRead(pin); }
+inline uint16_t halAnalogRead(uint8_t pin) { return analogRead(pin); }
+
+// CRC-32 (IEEE 802.3, as zlib) from the ROM; pass the previous result to continue
+inline uint32_t halCrc32(uint32_t crc, const void* data, size_t len) {
+  return esp_rom_crc32_le(crc, (const uint8_t*)data, len);
+}
+
+// Namespaced key/value storage
+typedef Preferences HalNvs;
+
+#else
+// ============================================================================
+// Host - implemented in src/host/hal_host.cpp
+// ============================================================================
+#include <Arduino.h>   // host/include shim: Serial, pin modes, map()
+
+uint32_t halMillis();
+uint32_t halMicros();                  // Virtual clock in µs (no time passes within a ms)
+void halDelay(uint32_t ms);            // Advances the virtual clock
+void halPinMode(uint8_t pin, uint8_t mode);
+void halDigitalWrite(uint8_t pin, uint8_t level);
+int halDigitalRead(uint8_t pin);
+uint16_t halAnalogRead(uint8_t pin);
+uint32_t halCrc32(uint32_t crc, const void* data, size_t len);   // Table-driven, same results as the ROM
+
+// In-memory stand-in for Preferences (same subset of the API)
+class HalNvs {
+public:
+    HalNvs();
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBytes(const char* key, const void* value, size_t len);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+    size_t getBytesLength(const char* key);
+    size_t putFloat(const char* key, float value);
+    float getFloat(const char* key, float defaultValue = 0.0f);
+    size_t putInt(const char* key, int32_t value);
+    int32_t getInt(const char* key, int32_t defaultValue = 0);
+    size_t putBool(const char* key, bool value);
+    bool getBool(const char* key, bool defaultValue = false);
+
+private:
+    char ns[16];
+    bool opened;
+    bool readOnly;
+};
+
+// Host-only controls used by runners, simulators and replay
+void halHostSetTime(uint32_t ms);
+void halHostSetDigitalInput(uint8_t pin, uint8_t level);
+void halHostSetAnalogInput(uint8_t pin, uint16_t value);
+uint8_t halHostDigitalOutput(uint8_t pin);
+uint32_t halHostDigitalWrites();        // Total halDigitalWrite() calls
+void halHostResetNvs();                 // Erase every namespace
+uint32_t halHostNvsWrites();            // Total put*/clear/remove calls
+uint32_t halHostNvsReads();             // Total get*/getBytesLength calls
+#endif
+
+#endif // HAL_H
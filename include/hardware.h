@@ -11,19 +11,27 @@
 #include "system_state.h"  // For g_systemState access
 
 // ============================================================================
-// RUNTIME CALIBRATION VARIABLES - Loaded from preferences
-// ============================================================================
-extern float runtime_battery_divider;
-extern float runtime_temp_scale;
-extern float runtime_pressure_scale;
-extern float runtime_hyd_pressure_scale;
-extern int runtime_fuel_empty;
-extern int runtime_fuel_full;
+// RUNTIME CALIBRATION - Loaded from preferences
+// ============================================================================
+// Published as one snapshot: a reader never sees the divider of one
+// calibration with the fuel range of another
+struct CalibrationConstants {
+  float batteryDivider;
+  float tempScale;
+  float pressureScale;
+  float hydPressureScale;
+  int fuelEmpty;
+  int fuelFull;
+};
+
+CalibrationConstants getCalibration();   // Lock-free, any task
+uint32_t calibrationGeneration();        // Increments on every reload
+void publishCalibration(const CalibrationConstants& calibration);  // Single writer
 
 // ============================================================================
 // HARDWARE INITIALIZATION
 // ============================================================================
-void initializePins();
+void initializePins();            // Also loads calibration unless one was already published
 void loadCalibrationConstants();  // Load calibration from preferences
 
 // ============================================================================
@@ -34,6 +42,15 @@ void controlGlowPlugs(bool enable);      // Glow plug relay control
 void controlStarter(bool enable);        // Starter solenoid relay
 void controlLights(bool enable);         // Both front and back lights relay
 
+// Last commanded relay outputs (bit set = energized)
+enum RelayBit : uint8_t {
+  RELAY_MAIN_POWER = 1 << 0,
+  RELAY_GLOW_PLUGS = 1 << 1,
+  RELAY_STARTER    = 1 << 2,
+  RELAY_LIGHTS     = 1 << 3
+};
+uint8_t getRelayStates();
+
 // ============================================================================
 // VIRTUAL BUTTON FUNCTIONS - Web Interface Control
 // ============================================================================
@@ -52,6 +69,22 @@ float readBatteryVoltage();    // Battery voltage (V)
 float readFuelLevel();         // Fuel level (%)
 float readHydraulicPressure(); // Hydraulic pressure (kPa)
 
+// Conversions from raw ADC counts (used by the sampling task, which takes
+// one calibration snapshot per sample)
+float convertEngineTemp(int rawValue, const CalibrationConstants& calibration);  // Advances the moving-average filter
+float convertBatteryVoltage(int rawValue, const CalibrationConstants& calibration);
+float convertFuelLevel(int rawValue, const CalibrationConstants& calibration);
+
+// Coolant temperature moving average, kept across deep sleep (resume_state.h)
+constexpr int TEMP_FILTER_SIZE = 10;
+struct TempFilterState {
+  float readings[TEMP_FILTER_SIZE];
+  uint8_t index;
+  bool initialized;
+};
+TempFilterState getTempFilter();
+void restoreTempFilter(const TempFilterState& filter);  // Before sampling starts
+
 // ============================================================================
 // DIGITAL INPUT READING FUNCTIONS
 // ============================================================================
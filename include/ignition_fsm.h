@@ -0,0 +1,219 @@
+/*
+ * Ignition State Machine Table for Bobcat Ignition Controller
+ * Every (state, event) pair maps to a next state and a set of relay/timer
+ * actions. The table is built at compile time and checked for completeness,
+ * so one control tick is a handful of array lookups. No Arduino dependencies.
+ * A lookup costs about a third more than the same transitions written as a
+ * switch (host benchmark: ~7 vs ~5 ns per step); with at most four steps per
+ * tick that is noise, and only the table can be checked by static_assert.
+ */
+
+#ifndef IGNITION_FSM_H
+#define IGNITION_FSM_H
+
+#include <stdint.h>
+#include "config.h"
+
+namespace IgnitionFsm {
+
+constexpr uint8_t STATE_COUNT = ERROR + 1;
+
+// Inputs, in the order runIgnitionSequence() feeds them each tick
+enum Event : uint8_t {
+  EV_KEY_OFF,          // Key in OFF
+  EV_KEY_ON,           // Key in ON, start not held
+  EV_KEY_GLOW,         // Key in GLOW, start not held
+  EV_KEY_START_TAP,    // Key at START or start held, but not both (momentary)
+  EV_KEY_CRANK,        // Key at START and start held
+  EV_GLOW_EXPIRED,     // Glow plugs energized for GLOW_PLUG_DURATION
+  EV_CRANK_TIMEOUT,    // Starter energized for IGNITION_TIMEOUT
+  EV_EMERGENCY_STOP,   // Web emergency stop
+  EVENT_COUNT
+};
+
+// Side effects applied by the caller, in bit order
+enum Action : uint16_t {
+  ACT_NONE              = 0,
+  ACT_MAIN_ON           = 1 << 0,
+  ACT_MAIN_OFF          = 1 << 1,
+  ACT_GLOW_ON           = 1 << 2,
+  ACT_GLOW_OFF          = 1 << 3,
+  ACT_STARTER_ON        = 1 << 4,
+  ACT_STARTER_OFF       = 1 << 5,
+  ACT_LIGHTS_OFF        = 1 << 6,
+  ACT_GLOW_TIMER_START  = 1 << 7,   // glowPlugStartTime = now
+  ACT_GLOW_TIMER_RESUME = 1 << 8,   // Restart the glow timer only if idle or expired
+  ACT_CRANK_TIMER_START = 1 << 9,   // ignitionStartTime = startHoldTime = now
+  ACT_KEY_TO_ON         = 1 << 10   // Key springs back to ON
+};
+
+struct Transition {
+  uint8_t next;
+  uint16_t actions;
+  const char* message;   // Logged when the transition fires (nullptr = silent)
+  bool defined;
+};
+
+constexpr Transition T(uint8_t next, uint16_t actions, const char* message = nullptr) {
+  return Transition{next, actions, message, true};
+}
+
+// Common action sets
+constexpr uint16_t ALL_OFF = ACT_MAIN_OFF | ACT_GLOW_OFF | ACT_STARTER_OFF | ACT_LIGHTS_OFF;
+constexpr uint16_t ESTOP = ACT_GLOW_OFF | ACT_STARTER_OFF | ACT_KEY_TO_ON;
+constexpr uint16_t CRANK = ACT_CRANK_TIMER_START | ACT_STARTER_ON;
+constexpr uint16_t DIRECT_START = CRANK | ACT_GLOW_TIMER_START | ACT_GLOW_ON;
+constexpr uint16_t RELEASE = ACT_STARTER_OFF | ACT_GLOW_OFF | ACT_KEY_TO_ON;
+
+constexpr const char* MSG_ESTOP = "EMERGENCY STOP activated - stopping engine processes only";
+
+// Rows: SystemState. Columns: Event (same order as the enum above).
+constexpr Transition TABLE[STATE_COUNT][EVENT_COUNT] = {
+  // OFF
+  { T(OFF, ACT_NONE),
+    T(ON, ACT_MAIN_ON, "KEY ON - System energized"),
+    T(ON, ACT_MAIN_ON, "KEY ON - System energized"),
+    T(ON, ACT_MAIN_ON, "KEY ON - System energized"),
+    T(ON, ACT_MAIN_ON, "KEY ON - System energized"),
+    T(OFF, ACT_GLOW_OFF),
+    T(OFF, ACT_STARTER_OFF),
+    T(OFF, ACT_GLOW_OFF | ACT_STARTER_OFF, MSG_ESTOP) },   // Energizes nothing; the key stays OFF
+  // ON
+  { T(OFF, ALL_OFF, "KEY OFF - System shutdown"),
+    T(ON, ACT_NONE),
+    T(GLOW_PLUG, ACT_GLOW_TIMER_RESUME | ACT_GLOW_ON, "GLOW PLUG position - Starting/resuming glow plug heating"),
+    T(START, DIRECT_START, "Direct START - Auto-activating glow plugs and cranking"),
+    T(START, DIRECT_START, "Direct START - Auto-activating glow plugs and cranking"),
+    T(ON, ACT_GLOW_OFF, "Glow plug timer expired while in ON position"),
+    T(ON, ACT_STARTER_OFF),
+    T(ON, ESTOP, MSG_ESTOP) },
+  // GLOW_PLUG
+  { T(OFF, ALL_OFF, "KEY OFF during glow plug heating"),
+    T(ON, ACT_NONE, "Key returned to ON - pausing glow plug heating"),
+    T(GLOW_PLUG, ACT_NONE),
+    T(START, CRANK, "START position - Engine cranking"),
+    T(START, CRANK, "START position - Engine cranking"),
+    T(ON, ACT_GLOW_OFF | ACT_KEY_TO_ON, "Glow plug heating complete - automatically returning to ON position"),
+    T(GLOW_PLUG, ACT_STARTER_OFF),
+    T(ON, ESTOP, MSG_ESTOP) },
+  // START
+  { T(OFF, ALL_OFF, "KEY OFF during start"),
+    T(ON, RELEASE, "Start key released - returning to ON position"),
+    T(ON, RELEASE, "Start key released - returning to ON position"),
+    T(ON, RELEASE, "Start key released - returning to ON position"),
+    T(START, ACT_NONE),
+    T(START, ACT_GLOW_OFF),
+    T(START, ACT_STARTER_OFF, "Engine start timeout - stopping cranking (release key)"),
+    T(ON, ESTOP, MSG_ESTOP) },
+  // RUNNING
+  { T(OFF, ALL_OFF, "KEY OFF - Engine shutdown (should stop engine manually first)"),
+    T(RUNNING, ACT_NONE),
+    T(RUNNING, ACT_NONE),
+    T(START, CRANK, "HOT RESTART - Engine already running, brief cranking"),
+    T(START, CRANK, "HOT RESTART - Engine already running, brief cranking"),
+    T(RUNNING, ACT_GLOW_OFF),
+    T(RUNNING, ACT_STARTER_OFF),
+    T(ON, ESTOP, MSG_ESTOP) },
+  // LOW_OIL_PRESSURE
+  { T(OFF, ALL_OFF, "KEY OFF - System shutdown"),
+    T(LOW_OIL_PRESSURE, ACT_NONE),
+    T(LOW_OIL_PRESSURE, ACT_NONE),
+    T(START, CRANK, "FORCED START during alert condition"),
+    T(START, CRANK, "FORCED START during alert condition"),
+    T(LOW_OIL_PRESSURE, ACT_GLOW_OFF),
+    T(LOW_OIL_PRESSURE, ACT_STARTER_OFF),
+    T(ON, ESTOP, MSG_ESTOP) },
+  // HIGH_TEMPERATURE
+  { T(OFF, ALL_OFF, "KEY OFF - System shutdown"),
+    T(HIGH_TEMPERATURE, ACT_NONE),
+    T(HIGH_TEMPERATURE, ACT_NONE),
+    T(START, CRANK, "FORCED START during alert condition"),
+    T(START, CRANK, "FORCED START during alert condition"),
+    T(HIGH_TEMPERATURE, ACT_GLOW_OFF),
+    T(HIGH_TEMPERATURE, ACT_STARTER_OFF),
+    T(ON, ESTOP, MSG_ESTOP) },
+  // ERROR
+  { T(OFF, ALL_OFF, "KEY OFF - System shutdown"),
+    T(ERROR, ACT_NONE),
+    T(ERROR, ACT_NONE),
+    T(START, CRANK, "OVERRIDE START from error state"),
+    T(START, CRANK, "OVERRIDE START from error state"),
+    T(ERROR, ACT_GLOW_OFF),
+    T(ERROR, ACT_STARTER_OFF),
+    T(ON, ESTOP, MSG_ESTOP) },
+};
+
+// ---------------------------------------------------------------------------
+// Compile-time checks
+// ---------------------------------------------------------------------------
+constexpr bool tableComplete() {
+  for (uint8_t s = 0; s < STATE_COUNT; s++) {
+    for (uint8_t e = 0; e < EVENT_COUNT; e++) {
+      if (!TABLE[s][e].defined || TABLE[s][e].next >= STATE_COUNT) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+constexpr bool noConflictingActions() {
+  for (uint8_t s = 0; s < STATE_COUNT; s++) {
+    for (uint8_t e = 0; e < EVENT_COUNT; e++) {
+      uint16_t a = TABLE[s][e].actions;
+      if (((a & ACT_MAIN_ON) && (a & ACT_MAIN_OFF)) ||
+          ((a & ACT_GLOW_ON) && (a & ACT_GLOW_OFF)) ||
+          ((a & ACT_STARTER_ON) && (a & ACT_STARTER_OFF))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Key OFF must always de-energize everything, the starter may only be
+// energized on the way into START, and an emergency stop energizes nothing
+// (from OFF it leaves the key alone too: ON would power up on the next step)
+constexpr bool safetyInvariants() {
+  for (uint8_t s = 0; s < STATE_COUNT; s++) {
+    if (s != OFF && (TABLE[s][EV_KEY_OFF].next != OFF || TABLE[s][EV_KEY_OFF].actions != ALL_OFF)) {
+      return false;
+    }
+    if (TABLE[s][EV_EMERGENCY_STOP].actions & (ACT_MAIN_ON | ACT_GLOW_ON | ACT_STARTER_ON)) {
+      return false;
+    }
+    if (s == OFF && (TABLE[s][EV_EMERGENCY_STOP].next != OFF || (TABLE[s][EV_EMERGENCY_STOP].actions & ACT_KEY_TO_ON))) {
+      return false;
+    }
+    for (uint8_t e = 0; e < EVENT_COUNT; e++) {
+      if ((TABLE[s][e].actions & ACT_STARTER_ON) && TABLE[s][e].next != START) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static_assert(sizeof(TABLE) / sizeof(TABLE[0]) == STATE_COUNT, "Ignition table needs one row per SystemState");
+static_assert(tableComplete(), "Ignition table has an undefined (state, event) entry");
+static_assert(noConflictingActions(), "Ignition table entry switches a relay both on and off");
+static_assert(safetyInvariants(), "Ignition table violates a safety invariant");
+
+// ---------------------------------------------------------------------------
+// Lookups
+// ---------------------------------------------------------------------------
+constexpr Event classifyKey(int keyPosition, bool startHeld) {
+  return keyPosition == 0                    ? EV_KEY_OFF
+       : (keyPosition >= 3 && startHeld)     ? EV_KEY_CRANK
+       : (keyPosition >= 3 || startHeld)     ? EV_KEY_START_TAP
+       : keyPosition == 2                    ? EV_KEY_GLOW
+                                             : EV_KEY_ON;
+}
+
+constexpr const Transition& step(uint8_t state, Event event) {
+  return TABLE[state < STATE_COUNT ? state : (uint8_t)ERROR][event];
+}
+
+} // namespace IgnitionFsm
+
+#endif // IGNITION_FSM_H
@@ -0,0 +1,290 @@
+/*
+ * Streaming JSON Writer for Bobcat Ignition Controller
+ * Writes JSON straight into a response stream or a fixed buffer through a
+ * small chunk on the stack: no document tree, no String, no heap. Keys are
+ * quoted at compile time (JSON_KEY), numbers are formatted without printf.
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// A key with its quotes and colon, assembled by the compiler:
+// JSON_KEY("state") is {"\"state\":", 8}
+struct JsonKey {
+    const char* text;
+    uint8_t length;
+};
+#define JSON_KEY(name) (JsonKey{ "\"" name "\":", sizeof("\"" name "\":") - 1 })
+
+// Sink over caller-owned memory; always NUL-terminated, truncates on overflow
+class JsonBufferSink {
+public:
+    JsonBufferSink(char* buffer, size_t capacity) : buffer(buffer), capacity(capacity), len(0), overflow(false) {
+        buffer[0] = '\0';
+    }
+
+    size_t write(const uint8_t* data, size_t size) {
+        size_t room = capacity - 1 - len;
+        if (size > room) {
+            size = room;
+            overflow = true;
+        }
+        memcpy(buffer + len, data, size);
+        len += size;
+        buffer[len] = '\0';
+        return size;
+    }
+
+    const char* c_str() const { return buffer; }
+    size_t length() const { return len; }
+    bool overflowed() const { return overflow; }
+
+private:
+    char* buffer;
+    size_t capacity;
+    size_t len;
+    bool overflow;
+};
+
+// Sink is anything with size_t write(const uint8_t*, size_t) - Arduino's
+// Print (AsyncResponseStream) or JsonBufferSink. Closing the outermost
+// object flushes the chunk.
+template <typename Sink>
+class JsonWriter {
+public:
+    explicit JsonWriter(Sink& sink) : sink(sink), used(0), total(0), depth(0), fields(0), needComma(0) {}
+
+    void beginObject() {
+        separator();
+        put('{');
+        push();
+    }
+
+    void beginObject(JsonKey key) {
+        writeKey(key);
+        put('{');
+        push();
+    }
+
+    void endObject() {
+        put('}');
+        if (depth > 0) {
+            depth--;
+        }
+        if (depth == 0) {
+            flush();
+        }
+    }
+
+    // Elements are objects, opened with beginObject()
+    void beginArray(JsonKey key) {
+        writeKey(key);
+        put('[');
+        push();
+    }
+
+    void endArray() {
+        put(']');
+        if (depth > 0) {
+            depth--;
+        }
+    }
+
+    void field(JsonKey key, bool value) {
+        writeKey(key);
+        value ? raw("true", 4) : raw("false", 5);
+    }
+
+    void field(JsonKey key, int value) { writeKey(key); writeSigned(value); }
+    void field(JsonKey key, long value) { writeKey(key); writeSigned(value); }
+    void field(JsonKey key, unsigned int value) { writeKey(key); writeUnsigned(value); }
+    void field(JsonKey key, unsigned long value) { writeKey(key); writeUnsigned(value); }
+
+    // Fixed number of decimals; NaN/infinity become null
+    void field(JsonKey key, double value, uint8_t decimals = 2) {
+        writeKey(key);
+        writeFixed(value, decimals);
+    }
+
+    void field(JsonKey key, const char* value) {
+        writeKey(key);
+        if (value == nullptr) {
+            raw("null", 4);
+        } else {
+            writeString(value);
+        }
+    }
+
+    // printf-style string value, formatted into a bounded stack buffer
+    void fieldf(JsonKey key, const char* format, ...) __attribute__((format(printf, 3, 4))) {
+        char text[160];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(text, sizeof(text), format, args);
+        va_end(args);
+        field(key, (const char*)text);
+    }
+
+    void fieldNull(JsonKey key) {
+        writeKey(key);
+        raw("null", 4);
+    }
+
+    void flush() {
+        if (used > 0) {
+            sink.write((const uint8_t*)chunk, used);
+            used = 0;
+        }
+    }
+
+    size_t bytesWritten() const { return total; }
+    uint16_t fieldsWritten() const { return fields; }
+
+private:
+    static const uint8_t MAX_DEPTH = 8;
+
+    Sink& sink;
+    char chunk[128];
+    size_t used;
+    size_t total;
+    uint8_t depth;
+    uint16_t fields;
+    uint8_t needComma;   // Bit per nesting level: a value was written at that level
+
+    void put(char c) {
+        if (used == sizeof(chunk)) {
+            flush();
+        }
+        chunk[used++] = c;
+        total++;
+    }
+
+    void raw(const char* text, size_t length) {
+        while (length > 0) {
+            if (used == sizeof(chunk)) {
+                flush();
+            }
+            size_t n = sizeof(chunk) - used;
+            if (n > length) {
+                n = length;
+            }
+            memcpy(chunk + used, text, n);
+            used += n;
+            total += n;
+            text += n;
+            length -= n;
+        }
+    }
+
+    void push() {
+        if (depth < MAX_DEPTH) {
+            depth++;
+            needComma &= ~(1 << (depth - 1));
+        }
+    }
+
+    void separator() {
+        if (depth == 0) {
+            return;
+        }
+        uint8_t bit = 1 << (depth - 1);
+        if (needComma & bit) {
+            put(',');
+        }
+        needComma |= bit;
+    }
+
+    void writeKey(JsonKey key) {
+        separator();
+        raw(key.text, key.length);
+        fields++;
+    }
+
+    void writeUnsigned(unsigned long value) {
+        char digits[12];
+        int pos = sizeof(digits);
+        do {
+            digits[--pos] = '0' + value % 10;
+            value /= 10;
+        } while (value > 0);
+        raw(digits + pos, sizeof(digits) - pos);
+    }
+
+    void writeSigned(long value) {
+        if (value < 0) {
+            put('-');
+            writeUnsigned(0UL - (unsigned long)value);
+        } else {
+            writeUnsigned((unsigned long)value);
+        }
+    }
+
+    void writeFixed(double value, uint8_t decimals) {
+        static const uint32_t SCALE[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+        if (!isfinite(value)) {
+            raw("null", 4);
+            return;
+        }
+        if (decimals > 6) {
+            decimals = 6;
+        }
+        if (fabs(value) >= 4.0e9) {
+            char text[48];   // Beyond any reading we report; keep it correct anyway
+            raw(text, snprintf(text, sizeof(text), "%.*f", decimals, value));
+            return;
+        }
+
+        uint64_t scaled = (uint64_t)(fabs(value) * SCALE[decimals] + 0.5);
+        if (value < 0 && scaled > 0) {
+            put('-');   // No "-0.00"
+        }
+        writeUnsigned((unsigned long)(scaled / SCALE[decimals]));
+        if (decimals > 0) {
+            uint32_t fraction = (uint32_t)(scaled % SCALE[decimals]);
+            char digits[6];
+            for (int i = decimals - 1; i >= 0; i--) {
+                digits[i] = '0' + fraction % 10;
+                fraction /= 10;
+            }
+            put('.');
+            raw(digits, decimals);
+        }
+    }
+
+    void writeString(const char* value) {
+        static const char HEX_DIGITS[] = "0123456789abcdef";
+        put('"');
+        const char* run = value;
+        for (const char* p = value; *p; p++) {
+            unsigned char c = (unsigned char)*p;
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            raw(run, p - run);
+            run = p + 1;
+            put('\\');
+            switch (c) {
+                case '"': put('"'); break;
+                case '\\': put('\\'); break;
+                case '\n': put('n'); break;
+                case '\r': put('r'); break;
+                case '\t': put('t'); break;
+                default:
+                    raw("u00", 3);
+                    put(HEX_DIGITS[c >> 4]);
+                    put(HEX_DIGITS[c & 0xF]);
+            }
+        }
+        raw(run, strlen(run));
+        put('"');
+    }
+};
+
+#endif // JSON_WRITER_H
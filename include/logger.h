@@ -0,0 +1,112 @@
+/*
+ * Asynchronous Logger Header for Bobcat Ignition Controller
+ * Log calls copy a compact binary record (timestamp, level, format pointer,
+ * up to four typed arguments) into a lock-free queue and return; a
+ * low-priority task formats the records and writes them to Serial.
+ * Relay and control paths never wait on the UART.
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Levels (plain macros so they can be compared in #if)
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+// Compile-time filter: calls above this level compile to nothing.
+// Override with -DBOBCAT_LOG_LEVEL=<n> in platformio.ini build_flags.
+#ifndef BOBCAT_LOG_LEVEL
+#define BOBCAT_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+static const uint8_t LOG_MAX_ARGS = 4;
+
+enum LogArgType : uint8_t {
+  LOG_ARG_INT,
+  LOG_ARG_UINT,
+  LOG_ARG_FLOAT,
+  LOG_ARG_STRING   // Pointer is stored, not the text: static strings only
+};
+
+struct LogArg {
+  LogArgType type;
+  union {
+    int32_t i;
+    uint32_t u;
+    float f;
+    const char* s;
+  };
+};
+
+struct LogRecord {
+  uint32_t timestampMs;
+  const char* format;    // printf-style; must be a string literal
+  uint8_t level;
+  uint8_t argCount;
+  LogArg args[LOG_MAX_ARGS];
+};
+
+inline LogArg makeLogArg(int v)           { LogArg a; a.type = LOG_ARG_INT;    a.i = v; return a; }
+inline LogArg makeLogArg(long v)          { LogArg a; a.type = LOG_ARG_INT;    a.i = v; return a; }
+inline LogArg makeLogArg(unsigned int v)  { LogArg a; a.type = LOG_ARG_UINT;   a.u = v; return a; }
+inline LogArg makeLogArg(unsigned long v) { LogArg a; a.type = LOG_ARG_UINT;   a.u = v; return a; }
+inline LogArg makeLogArg(bool v)          { LogArg a; a.type = LOG_ARG_INT;    a.i = v; return a; }
+inline LogArg makeLogArg(float v)         { LogArg a; a.type = LOG_ARG_FLOAT;  a.f = v; return a; }
+inline LogArg makeLogArg(double v)        { LogArg a; a.type = LOG_ARG_FLOAT;  a.f = (float)v; return a; }
+inline LogArg makeLogArg(const char* v)   { LogArg a; a.type = LOG_ARG_STRING; a.s = v; return a; }
+
+// Stamp and enqueue a record (any task, never blocks)
+void submitLogRecord(LogRecord& record);
+
+template <typename... Args>
+inline void logRecord(uint8_t level, const char* format, Args... args) {
+  static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+  LogRecord record;
+  record.format = format;
+  record.level = level;
+  record.argCount = sizeof...(Args);
+  const LogArg packed[] = { makeLogArg(args)..., makeLogArg(0) };
+  memcpy(record.args, packed, sizeof(LogArg) * sizeof...(Args));
+  submitLogRecord(record);
+}
+
+#if BOBCAT_LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) logRecord(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if BOBCAT_LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) logRecord(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#if BOBCAT_LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) logRecord(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if BOBCAT_LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logRecord(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+// Start the drain task (records logged earlier are kept until it runs)
+void startLogger();
+
+// Wait up to timeoutMs for queued records to reach the UART (e.g. before sleep)
+void flushLog(uint32_t timeoutMs = 100);
+
+// Records lost because the queue was full
+uint32_t logRecordsDropped();
+
+#endif // LOGGER_H
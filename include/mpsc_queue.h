@@ -0,0 +1,97 @@
+/*
+ * Bounded Lock-Free Queue for Bobcat Ignition Controller
+ * Many producers (web handlers, other tasks), one consumer (the control loop)
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bounded ring with a per-slot sequence number (D. Vyukov's design).
+// Producers claim a slot with one CAS and publish it by bumping the slot
+// sequence; the single consumer never blocks producers. push() fails
+// instead of waiting when the ring is full.
+template <typename T, size_t N>
+class MpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "Queue size must be a power of two");
+
+public:
+    MpscQueue() : enqueuePos(0), dequeuePos(0) {
+        for (size_t i = 0; i < N; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Any task. Returns false if the queue is full. `position` receives the
+    // slot's place in the queue order (consecutive, wraps at 2^32).
+    bool push(const T& value, uint32_t* position = nullptr) {
+        uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & (N - 1)];
+            uint32_t seq = cell->sequence.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(seq - pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        if (position != nullptr) {
+            *position = pos;
+        }
+        return true;
+    }
+
+    // Consumer task only. Returns false if nothing is ready. `position` is
+    // the one push() reported for the item.
+    bool pop(T& out, uint32_t* position = nullptr) {
+        uint32_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell = &cells[pos & (N - 1)];
+        uint32_t seq = cell->sequence.load(std::memory_order_acquire);
+        if ((int32_t)(seq - (pos + 1)) < 0) {
+            return false;
+        }
+        out = cell->value;
+        cell->sequence.store(pos + N, std::memory_order_release);
+        dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        if (position != nullptr) {
+            *position = pos;
+        }
+        return true;
+    }
+
+    // Approximate number of queued items (exact when called by the consumer
+    // with no concurrent producers)
+    size_t size() const {
+        return enqueuePos.load(std::memory_order_relaxed) - dequeuePos.load(std::memory_order_relaxed);
+    }
+
+    // Positions handed out so far (the next push() gets this one)
+    uint32_t pushed() const {
+        return enqueuePos.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    struct Cell {
+        std::atomic<uint32_t> sequence;
+        T value;
+    };
+
+    Cell cells[N];
+    std::atomic<uint32_t> enqueuePos;
+    std::atomic<uint32_t> dequeuePos;
+};
+
+#endif // MPSC_QUEUE_H
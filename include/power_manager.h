@@ -0,0 +1,57 @@
+/*
+ * Power Manager Header for Bobcat Ignition Controller
+ * Power between deep sleeps. With the key OFF or ON and nobody connected
+ * the CPU clock scales down, the idle task may enter light sleep and the
+ * station radio uses modem sleep. Glow plugs, cranking, a running engine,
+ * a fault or a connected client hold PM locks for full clock and no light
+ * sleep. Time spent in each profile and the resulting average current
+ * estimate are served at /api/power. Builds without esp_pm get a fixed
+ * POWER_IDLE_CPU_MAX_MHZ idle clock, and light sleep needs tickless idle in
+ * the SDK configuration; PowerStats says which applies.
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+
+enum PowerProfile : uint8_t {
+  POWER_IDLE,      // OFF/ON, no client: frequency scaling, light sleep, modem sleep
+  POWER_CLIENT,    // OFF/ON with a client: full clock, radio always listening
+  POWER_ENGINE,    // GLOW_PLUG/START/RUNNING or a fault: full clock, no light sleep
+  POWER_PROFILE_COUNT
+};
+
+struct PowerStats {
+  uint32_t profileMs[POWER_PROFILE_COUNT];   // Time spent in each profile since boot
+  uint32_t transitions;                      // Profile changes since boot
+  PowerProfile profile;                      // Current profile
+  bool frequencyScaling;                     // esp_pm accepted the idle configuration
+  bool lightSleep;                           // ... with automatic light sleep (tickless idle)
+};
+
+// The profile for a SystemState value and whether a client is connected
+PowerProfile selectPowerProfile(int state, bool clientConnected);
+
+// setup(), after the WiFi is up: configures frequency scaling and light
+// sleep, and creates the locks (no effect on the host)
+void startPowerManagement();
+
+// Control task, after every tick: switches profile when the state or the
+// client changed and accounts the time spent in the previous one
+void updatePowerProfile(int state, bool clientConnected);
+
+// loop(), on NETWORK_CORE: turns modem sleep on or off to match the
+// current profile, so the control task never calls into the WiFi driver
+void updateModemSleep();
+
+PowerProfile currentPowerProfile();
+const char* powerProfileName(PowerProfile profile);
+
+// A copy, with the current profile's time counted up to now
+PowerStats getPowerStats();
+
+// Time-weighted average of the nominal per-profile currents (mA)
+float estimatedAverageCurrentMa(const PowerStats& stats);
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,42 @@
+/*
+ * Resume State Header for Bobcat Ignition Controller
+ * What the controller knew when it went to deep sleep - settings,
+ * calibration, the coolant filter, work lights, counters - kept in RTC
+ * memory, so a wake restores it without reading NVS. The pins are set up
+ * once with the work lights already on; the ignition always comes back
+ * OFF. A power cycle, a different firmware layout (RESUME_STATE_VERSION)
+ * or a bad CRC falls back to the normal boot.
+ */
+
+#ifndef RESUME_STATE_H
+#define RESUME_STATE_H
+
+#include <stdint.h>
+
+// Bump when the block layout changes (a wake into new firmware then does a
+// normal boot)
+constexpr uint16_t RESUME_STATE_VERSION = 2;
+
+enum ResumeResult : uint8_t {
+  RESUME_NONE,       // Cold boot, or the block was already used
+  RESUME_RESTORED,
+  RESUME_INVALID     // CRC, version or contents rejected
+};
+
+// prepareForSleep(): after the relays are off and the settings flushed
+void saveResumeState();
+
+// setup() on a deep sleep wake, before g_settingsManager.begin() and
+// initializePins(). The block is consumed: a later reset does a normal boot.
+ResumeResult restoreResumeState();
+
+// After initializePins(): outputs the restored state asks for (work lights).
+// The ignition always comes back OFF with the key OFF.
+void applyResumedOutputs();
+
+ResumeResult lastResumeResult();
+const char* resumeResultName(ResumeResult result);
+uint32_t deepSleepCycles();          // Wakes restored since the last power-on
+int lastSleepState();                // SystemState at the last sleep (-1 = none)
+
+#endif // RESUME_STATE_H
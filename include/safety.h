@@ -8,11 +8,12 @@
 
 #include <Arduino.h>
 #include "system_state.h"  // For g_systemState access
+#include "sensors.h"
 
-// Safety monitoring functions
-void checkSafetyInputs();
+// Safety monitoring functions (the control tick passes the snapshot it read)
+void checkSafetyInputs(const SensorSnapshot& sensors);
 void handleError(const char* errorMessage);
-void checkEngineVitals();
+void checkEngineVitals(const SensorSnapshot& sensors);
 
 // Override function
 void overrideStart();
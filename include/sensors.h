@@ -0,0 +1,55 @@
+/*
+ * Sensor Sampling Header for Bobcat Ignition Controller
+ * A background task samples every input at a fixed rate and publishes
+ * an immutable, timestamped snapshot for the control loop and web handlers
+ */
+
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include <Arduino.h>
+
+// One consistent set of sensor readings taken by the sampling task
+struct SensorSnapshot {
+    uint32_t sequence;           // Increments with every published sample (0 = none yet)
+    uint32_t timestampMs;        // millis() when the sample was taken
+
+    // Raw ADC counts (0-4095)
+    uint16_t batteryRaw;
+    uint16_t temperatureRaw;
+    uint16_t pressureRaw;
+    uint16_t fuelRaw;
+    uint16_t hydraulicRaw;
+
+    // Converted values (runtime calibration applied)
+    float batteryVoltage;        // V
+    float engineTemp;            // °C, moving-average filtered
+    float fuelLevel;             // %
+
+    // Digital inputs
+    bool oilPressureOk;          // Oil pressure switch closed
+    bool hydPressureOk;          // Hydraulic pressure switch closed
+    bool alternatorCharging;
+    bool engineRunning;
+    bool seatBarEngaged;
+    bool inNeutral;
+};
+
+// Take the first sample synchronously and start the background sampling task
+void startSensorSampling();
+
+// Before deep sleep: stop the sampling task and the continuous ADC once the
+// current sample is published, so nothing touches ADC1 after the ULP takes it
+void stopSensorSampling();
+
+// Take and publish one sample on the calling task (the sampling task itself,
+// or a host runner stepping a virtual clock)
+void sampleSensors();
+
+// Latest published snapshot (O(1), never touches the ADC)
+SensorSnapshot getSensorSnapshot();
+
+// Publish a snapshot taken elsewhere (trace replay feeds recorded samples)
+void publishSensorSnapshot(const SensorSnapshot& snapshot);
+
+#endif // SENSORS_H
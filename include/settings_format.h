@@ -0,0 +1,78 @@
+/*
+ * Settings Storage Format for Bobcat Ignition Controller
+ * On-flash encoding of BobcatSettings: a header with the format version and
+ * a CRC32, then one tagged record per field. A field added later gets a new
+ * tag and needs no migration (older blobs keep its default, older firmware
+ * skips it). Layouts written before the tagged format are migrated on load.
+ */
+
+#ifndef SETTINGS_FORMAT_H
+#define SETTINGS_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct BobcatSettings;
+
+// Bump only when an existing tag changes meaning, and add the upgrade step
+// to decodeSettings(); new fields just take the next free tag
+constexpr uint16_t SETTINGS_FORMAT_VERSION = 2;
+constexpr uint32_t SETTINGS_FORMAT_MAGIC = 0x53434231;   // "1BCS" in flash order
+constexpr size_t SETTINGS_BLOB_MAX = 384;   // Every text field at full length fits (checked in settings_format.cpp)
+
+struct SettingsBlobHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;     // Bytes of records after the header
+    uint32_t crc;        // CRC32 of those records
+};
+
+// Record: tag (1 byte), value length (1 byte), value (little-endian; text
+// without its NUL). Tags come from BOBCAT_SETTINGS (include/settings_schema.h).
+
+enum SettingsDecodeResult : uint8_t {
+    SETTINGS_DECODED,    // Current format
+    SETTINGS_MIGRATED,   // Older layout, converted - write it back in the current format
+    SETTINGS_CORRUPT,    // CRC or checksum mismatch, truncated record
+    SETTINGS_UNKNOWN     // No layout this firmware knows (e.g. from a newer firmware)
+};
+
+// Returns the blob size, 0 if `capacity` is too small
+size_t encodeSettings(const BobcatSettings& settings, uint8_t* blob, size_t capacity);
+
+// `settings` must hold the defaults: fields absent from the blob keep them.
+// `fromVersion` receives the version of the stored layout.
+SettingsDecodeResult decodeSettings(const uint8_t* blob, size_t length, BobcatSettings& settings,
+                                    uint16_t* fromVersion = nullptr);
+
+const char* settingsDecodeResultName(SettingsDecodeResult result);
+
+// ============================================================================
+// HISTORICAL LAYOUTS - frozen, for migration and the host runner
+// ============================================================================
+
+// v1: BobcatSettings stored as a raw struct with a rotate-XOR checksum
+struct BobcatSettingsV1 {
+    uint32_t glowPlugDuration;
+    uint32_t crankingTimeout;
+    uint32_t cooldownDuration;
+    int16_t maxCoolantTemp;
+    int16_t minOilPressure;
+    int16_t minHydPressure;
+    float minBatteryVoltage;
+    float maxBatteryVoltage;
+    char wifiSSID[33];
+    char wifiPassword[65];
+    float tempSensorOffset;
+    float pressureScale;
+    float hydPressureScale;
+    uint16_t fuelLevelEmpty;
+    uint16_t fuelLevelFull;
+    uint8_t fuelLevelLowThreshold;
+    uint32_t settingsVersion;   // 1
+    uint32_t checksum;
+};
+
+uint32_t settingsChecksumV1(const BobcatSettingsV1& settings);
+
+#endif // SETTINGS_FORMAT_H
@@ -0,0 +1,230 @@
+/*
+ * Settings Schema for Bobcat Ignition Controller
+ * Every user setting is declared once, in BOBCAT_SETTINGS below. The
+ * struct, defaults, range checks, /api/settings names and JSON, the serial
+ * printout and the flash record tags are all generated from that table -
+ * adding a setting is one line here.
+ */
+
+#ifndef SETTINGS_SCHEMA_H
+#define SETTINGS_SCHEMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "json_writer.h"
+
+// Flags
+constexpr uint8_t SETTING_READ = 1 << 0;       // Returned by GET /api/settings
+constexpr uint8_t SETTING_WRITE = 1 << 1;      // Accepted by POST /api/settings
+constexpr uint8_t SETTING_SECRET = 1 << 2;     // Never returned or logged; empty input keeps the stored value
+constexpr uint8_t SETTING_OPTIONAL = 1 << 3;   // Text may be empty
+constexpr uint8_t SETTING_IPV4 = 1 << 4;       // Text is a dotted-quad address
+constexpr uint8_t SETTING_UI = SETTING_READ | SETTING_WRITE;
+
+// Numbers: X(member, type, key, tag, scale, decimals, unit, default, min, max, flags)
+//   Stored value = UI value * scale (durations are seconds in the UI, ms
+//   inside). Default and limits are in UI units.
+// Text:    T(member, size, key, tag, default, minLength, flags)
+//   size includes the NUL.
+// Tags identify the flash record (include/settings_format.h): never reuse
+// or renumber one. Checks between fields are in validateSettings().
+#define BOBCAT_SETTINGS(X, T) \
+    /* Engine Parameters */ \
+    X(glowPlugDuration,      uint32_t, "glowDuration",           1, 1000, 0, "s",         20,     5,     60,   SETTING_UI) \
+    X(crankingTimeout,       uint32_t, "crankingTimeout",        2, 1000, 0, "s",         10,     5,     30,   SETTING_UI) \
+    X(cooldownDuration,      uint32_t, "cooldownDuration",       3, 1000, 0, "s",         120,    60,    300,  SETTING_UI) \
+    /* Alarm Thresholds */ \
+    X(maxCoolantTemp,        int16_t,  "maxTemp",                4, 1,    0, "C",         104,    80,    120,  SETTING_UI) \
+    X(minOilPressure,        int16_t,  "minOilPressure",         5, 1,    0, "kPa",       69,     30,    150,  SETTING_UI) \
+    X(minHydPressure,        int16_t,  "minHydPressure",         6, 1,    0, "kPa",       0,      0,     3000, SETTING_UI) \
+    X(minBatteryVoltage,     float,    "minVoltage",             7, 1,    2, "V",         11.0f,  10.0f, 16.0f, SETTING_UI) \
+    X(maxBatteryVoltage,     float,    "maxVoltage",             8, 1,    2, "V",         15.0f,  10.0f, 16.0f, SETTING_UI) \
+    /* Deep sleep: the ULP wakes the controller when the battery falls below this (0 = off) */ \
+    X(sleepWakeVoltage,      float,    "sleepWakeVoltage",      22, 1,    2, "V",         11.8f,  0.0f,  14.0f, SETTING_UI) \
+    /* WiFi Configuration */ \
+    T(wifiSSID,              33,       "wifiSSID",               9, "Bobcat-743", 1, SETTING_UI) \
+    T(wifiPassword,          65,       "wifiPassword",          10, "bobcat123",  8, SETTING_WRITE | SETTING_SECRET | SETTING_OPTIONAL) \
+    T(homeSSID,              33,       "homeSSID",              17, "fabfarm",    0, SETTING_UI | SETTING_OPTIONAL) \
+    T(homePassword,          65,       "homePassword",          18, "imakestuff", 8, SETTING_WRITE | SETTING_SECRET | SETTING_OPTIONAL) \
+    /* Static address on the home network (empty = DHCP; DNS is the gateway) */ \
+    T(homeStaticIP,          16,       "homeStaticIP",          19, "",           0, SETTING_UI | SETTING_OPTIONAL | SETTING_IPV4) \
+    T(homeGateway,           16,       "homeGateway",           20, "",           0, SETTING_UI | SETTING_OPTIONAL | SETTING_IPV4) \
+    T(homeSubnet,            16,       "homeSubnet",            21, "255.255.255.0", 0, SETTING_UI | SETTING_IPV4) \
+    /* Sensor Calibration (temperature offset is unused: the NTC formula has none) */ \
+    X(tempSensorOffset,      float,    "tempSensorOffset",      11, 1,    1, "C",         0.0f,   -50.0f, 50.0f, 0) \
+    X(pressureScale,         float,    "pressureScale",         12, 1,    4, "kPa/count", 0.1682f, 0.01f, 1.0f, SETTING_READ) \
+    X(hydPressureScale,      float,    "hydPressureScale",      13, 1,    4, "kPa/count", 0.1682f, 0.01f, 5.0f, SETTING_READ) \
+    X(fuelLevelEmpty,        uint16_t, "fuelLevelEmpty",        14, 1,    0, "count",     200,    0,     4095, 0) \
+    X(fuelLevelFull,         uint16_t, "fuelLevelFull",         15, 1,    0, "count",     3800,   0,     4095, 0) \
+    X(fuelLevelLowThreshold, uint8_t,  "fuelLevelLowThreshold", 16, 1,    0, "%",         15,     0,     100,  SETTING_UI)
+
+// Settings structure to hold all configurable parameters
+#define SETTING_MEMBER(member, type, ...) type member;
+#define SETTING_TEXT_MEMBER(member, size, ...) char member[size];
+struct BobcatSettings {
+    BOBCAT_SETTINGS(SETTING_MEMBER, SETTING_TEXT_MEMBER)
+};
+#undef SETTING_MEMBER
+#undef SETTING_TEXT_MEMBER
+
+// ============================================================================
+// DESCRIPTORS
+// ============================================================================
+enum SettingType : uint8_t {
+    SETTING_U8,
+    SETTING_U16,
+    SETTING_U32,
+    SETTING_I16,
+    SETTING_FLOAT,
+    SETTING_TEXT
+};
+
+template <typename T> constexpr SettingType settingTypeOf();
+template <> constexpr SettingType settingTypeOf<uint8_t>() { return SETTING_U8; }
+template <> constexpr SettingType settingTypeOf<uint16_t>() { return SETTING_U16; }
+template <> constexpr SettingType settingTypeOf<uint32_t>() { return SETTING_U32; }
+template <> constexpr SettingType settingTypeOf<int16_t>() { return SETTING_I16; }
+template <> constexpr SettingType settingTypeOf<float>() { return SETTING_FLOAT; }
+
+struct SettingDescriptor {
+    const char* name;
+    uint8_t nameLength;
+    JsonKey key;             // Name quoted for JsonWriter
+    uint8_t tag;
+    SettingType type;
+    uint16_t offset;
+    uint8_t size;
+    uint16_t scale;
+    uint8_t decimals;
+    const char* unit;
+    float defaultValue;      // UI units
+    float minimum;
+    float maximum;
+    const char* defaultText;
+    uint8_t minLength;
+    uint8_t flags;
+};
+
+#define SETTING_DESCRIPTOR(member, type, name, tag, scale, decimals, unit, def, min, max, flags) \
+    { name, sizeof(name) - 1, JSON_KEY(name), tag, settingTypeOf<type>(), offsetof(BobcatSettings, member), \
+      sizeof(type), scale, decimals, unit, def, min, max, nullptr, 0, flags },
+#define SETTING_TEXT_DESCRIPTOR(member, size, name, tag, def, minLength, flags) \
+    { name, sizeof(name) - 1, JSON_KEY(name), tag, SETTING_TEXT, offsetof(BobcatSettings, member), \
+      size, 1, 0, "", 0, 0, 0, def, minLength, flags },
+
+constexpr SettingDescriptor SETTINGS[] = {
+    BOBCAT_SETTINGS(SETTING_DESCRIPTOR, SETTING_TEXT_DESCRIPTOR)
+};
+#undef SETTING_DESCRIPTOR
+#undef SETTING_TEXT_DESCRIPTOR
+
+constexpr uint8_t SETTING_COUNT = sizeof(SETTINGS) / sizeof(SETTINGS[0]);
+
+// ============================================================================
+// NAME AND TAG LOOKUP - one hash and one compare
+// ============================================================================
+constexpr uint8_t SETTING_SLOT_BITS = 5;
+constexpr uint8_t SETTING_SLOT_COUNT = 1 << SETTING_SLOT_BITS;
+constexpr uint32_t SETTING_HASH_SEED = 15244;   // Any value the static_assert below accepts
+constexpr uint8_t SETTING_MAX_TAG = 63;
+constexpr int8_t NO_SETTING = -1;
+
+// FNV-1a, top bits
+constexpr uint8_t settingHash(const char* name, size_t len) {
+    uint32_t h = 2166136261u ^ SETTING_HASH_SEED;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (uint8_t)name[i]) * 16777619u;
+    }
+    return (uint8_t)(h >> (32 - SETTING_SLOT_BITS));
+}
+
+struct SettingSlots {
+    int8_t byName[SETTING_SLOT_COUNT];
+    int8_t byTag[SETTING_MAX_TAG + 1];
+};
+
+constexpr SettingSlots buildSettingSlots() {
+    SettingSlots slots = {};
+    for (uint8_t s = 0; s < SETTING_SLOT_COUNT; s++) {
+        slots.byName[s] = NO_SETTING;
+    }
+    for (uint8_t t = 0; t <= SETTING_MAX_TAG; t++) {
+        slots.byTag[t] = NO_SETTING;
+    }
+    for (uint8_t i = 0; i < SETTING_COUNT; i++) {
+        slots.byName[settingHash(SETTINGS[i].name, SETTINGS[i].nameLength)] = i;
+        if (SETTINGS[i].tag <= SETTING_MAX_TAG) {
+            slots.byTag[SETTINGS[i].tag] = i;
+        }
+    }
+    return slots;
+}
+
+constexpr SettingSlots SETTING_SLOTS = buildSettingSlots();
+
+constexpr bool settingSlotsUnique() {
+    for (uint8_t i = 0; i < SETTING_COUNT; i++) {
+        if (SETTING_SLOTS.byName[settingHash(SETTINGS[i].name, SETTINGS[i].nameLength)] != i ||
+            SETTINGS[i].tag == 0 || SETTINGS[i].tag > SETTING_MAX_TAG || SETTING_SLOTS.byTag[SETTINGS[i].tag] != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(SETTING_COUNT <= SETTING_SLOT_COUNT, "More settings than hash slots");
+static_assert(settingSlotsUnique(), "Two settings share a name slot or a tag - change SETTING_HASH_SEED or the tag");
+
+inline const SettingDescriptor* findSetting(const char* name, size_t len) {
+    if (len == 0 || len > 255) {
+        return nullptr;
+    }
+    int8_t i = SETTING_SLOTS.byName[settingHash(name, len)];
+    if (i == NO_SETTING || SETTINGS[i].nameLength != len || memcmp(SETTINGS[i].name, name, len) != 0) {
+        return nullptr;
+    }
+    return &SETTINGS[i];
+}
+
+inline const SettingDescriptor* findSettingByTag(uint8_t tag) {
+    int8_t i = tag <= SETTING_MAX_TAG ? SETTING_SLOTS.byTag[tag] : NO_SETTING;
+    return i == NO_SETTING ? nullptr : &SETTINGS[i];
+}
+
+// ============================================================================
+// VALUES (src/settings_schema.cpp)
+// ============================================================================
+void settingsDefaults(BobcatSettings& settings);
+
+// Numbers in UI units
+float settingValue(const BobcatSettings& settings, const SettingDescriptor& setting);
+const char* settingText(const BobcatSettings& settings, const SettingDescriptor& setting);
+
+// False (and nothing written) when the value is outside the setting's limits
+bool setSettingValue(BobcatSettings& settings, const SettingDescriptor& setting, float value);
+bool setSettingText(BobcatSettings& settings, const SettingDescriptor& setting, const char* text);
+
+bool settingInRange(const BobcatSettings& settings, const SettingDescriptor& setting);
+
+// Strict "a.b.c.d"
+bool parseIPv4(const char* text, uint8_t octets[4]);
+bool settingChanged(const BobcatSettings& a, const BobcatSettings& b, const SettingDescriptor& setting);
+
+// "20 s", "Bobcat-743", "****" for secrets
+void formatSetting(char* buffer, size_t size, const BobcatSettings& settings, const SettingDescriptor& setting);
+
+// One field in UI units; secrets are skipped
+template <typename Sink>
+void writeSettingJson(JsonWriter<Sink>& json, const SettingDescriptor& setting, const BobcatSettings& settings) {
+    if (setting.flags & SETTING_SECRET) {
+        return;
+    }
+    if (setting.type == SETTING_TEXT) {
+        json.field(setting.key, settingText(settings, setting));
+    } else {
+        json.field(setting.key, (double)settingValue(settings, setting), setting.decimals);
+    }
+}
+
+#endif // SETTINGS_SCHEMA_H
@@ -0,0 +1,81 @@
+/*
+ * Snapshot Publisher for Bobcat Ignition Controller
+ * Single-writer / many-reader publication of small value types (double
+ * buffer with a sequence lock per slot)
+ */
+
+#ifndef SNAPSHOT_PUBLISHER_H
+#define SNAPSHOT_PUBLISHER_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// Publishes a copy of T that any number of readers can take without locks.
+// The writer fills the slot readers are not pointed at, then flips the
+// published generation to it; readers copy the published slot and retry
+// only if the writer lapped them (two publications during one copy). A
+// writer preempted in the middle of a publication - e.g. by a higher
+// priority reader on the same core - never holds a reader up: the slot it
+// was writing is not published yet. Only one task may publish.
+template <typename T>
+class SnapshotPublisher {
+    static_assert(std::is_trivially_copyable<T>::value, "Snapshot type must be trivially copyable");
+
+public:
+    SnapshotPublisher() : published(0) {
+        memset(slots, 0, sizeof(slots));
+        slotSequence[0].store(0, std::memory_order_relaxed);
+        slotSequence[1].store(0, std::memory_order_relaxed);
+    }
+
+    void publish(const T& value) {
+        memcpy(&beginPublish(), &value, sizeof(T));
+        endPublish();
+    }
+
+    // publish() in two halves, for values built in place: fill the
+    // returned slot, then endPublish(). Readers see the previous value
+    // until then.
+    T& beginPublish() {
+        uint8_t slot = (published.load(std::memory_order_relaxed) + 1) & 1u;
+        uint32_t seq = slotSequence[slot].load(std::memory_order_relaxed);
+        slotSequence[slot].store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return slots[slot];
+    }
+
+    void endPublish() {
+        uint32_t generation = published.load(std::memory_order_relaxed) + 1;
+        uint8_t slot = generation & 1u;
+        slotSequence[slot].store(slotSequence[slot].load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        published.store(generation, std::memory_order_release);
+    }
+
+    T read() const {
+        T copy;
+        for (;;) {
+            uint8_t slot = published.load(std::memory_order_acquire) & 1u;
+            uint32_t before = slotSequence[slot].load(std::memory_order_acquire);
+            memcpy(&copy, &slots[slot], sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint32_t after = slotSequence[slot].load(std::memory_order_relaxed);
+            if (!(before & 1u) && before == after) {
+                return copy;
+            }
+        }
+    }
+
+    // Number of completed publications (0 = nothing published yet)
+    uint32_t generation() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<uint32_t> published;        // Completed publications; the low bit is the readable slot
+    std::atomic<uint32_t> slotSequence[2];  // Odd while the writer fills that slot
+    T slots[2];
+};
+
+#endif // SNAPSHOT_PUBLISHER_H
@@ -0,0 +1,115 @@
+/*
+ * Binary Status Format for Bobcat Ignition Controller
+ * Encoder and decoder for /status.bin - a fixed 44-byte little-endian
+ * record carrying the same data as /status. Header-only and free of
+ * Arduino dependencies so telemetry tools can include it directly.
+ * Schema: docs/status-bin.md
+ */
+
+#ifndef STATUS_BIN_H
+#define STATUS_BIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+static const uint8_t STATUS_BIN_VERSION = 1;
+static const size_t STATUS_BIN_SIZE = 44;
+
+// Bits of StatusBin::flags
+enum StatusBinFlag : uint16_t {
+    STATUS_BIN_LIGHTS          = 1 << 0,
+    STATUS_BIN_MAIN_POWER      = 1 << 1,
+    STATUS_BIN_GLOW_PLUGS      = 1 << 2,
+    STATUS_BIN_STARTER         = 1 << 3,
+    STATUS_BIN_OIL_PRESSURE_OK = 1 << 4,
+    STATUS_BIN_HYD_PRESSURE_OK = 1 << 5,
+    STATUS_BIN_START_KEY_HELD  = 1 << 6,
+    STATUS_BIN_SLEEP_ENABLED   = 1 << 7,
+    STATUS_BIN_SLEEP_ELIGIBLE  = 1 << 8,
+    STATUS_BIN_WIFI_CONNECTED  = 1 << 9,
+    STATUS_BIN_LOW_BATTERY     = 1 << 10
+};
+
+// Decoded record; analog values are fixed point (no float formatting on the ESP32)
+struct StatusBin {
+    uint16_t flags;               // StatusBinFlag bits
+    uint32_t generation;          // Same counter as the /status "generation" field
+    uint8_t state;                // SystemState enum value (0 = OFF ... 7 = ERROR)
+    uint8_t keyPosition;          // 0=OFF, 1=ON, 2=GLOW_PLUG, 3=START
+    uint8_t apClients;
+    uint16_t glowCountdown;       // s
+    int16_t engineTempDeci;       // 0.1 °C
+    uint16_t batteryMillivolts;   // mV
+    uint16_t fuelCentiPercent;    // 0.01 % (0-10000)
+    uint32_t lastCommandSeq;
+    uint32_t timeSinceActivity;   // s
+    uint32_t timeUntilSleep;      // s
+    uint8_t wifiIp[4];            // Dotted order; 0.0.0.0 when not connected
+    uint8_t apIp[4];
+    uint32_t uptimeMs;            // millis() when the record was built
+
+    float engineTemp() const { return engineTempDeci / 10.0f; }
+    float batteryVoltage() const { return batteryMillivolts / 1000.0f; }
+    float fuelLevel() const { return fuelCentiPercent / 100.0f; }
+};
+
+namespace StatusBinCodec {
+    inline void put16(uint8_t* p, uint16_t v) { p[0] = v & 0xFF; p[1] = v >> 8; }
+    inline void put32(uint8_t* p, uint32_t v) { put16(p, v & 0xFFFF); put16(p + 2, v >> 16); }
+    inline uint16_t get16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+    inline uint32_t get32(const uint8_t* p) { return get16(p) | ((uint32_t)get16(p + 2) << 16); }
+}
+
+// Writes exactly STATUS_BIN_SIZE bytes
+inline void encodeStatusBin(const StatusBin& s, uint8_t* out) {
+    using namespace StatusBinCodec;
+    out[0] = STATUS_BIN_VERSION;
+    out[1] = (uint8_t)STATUS_BIN_SIZE;
+    put16(out + 2, s.flags);
+    put32(out + 4, s.generation);
+    out[8] = s.state;
+    out[9] = s.keyPosition;
+    out[10] = s.apClients;
+    out[11] = 0;
+    put16(out + 12, s.glowCountdown);
+    put16(out + 14, (uint16_t)s.engineTempDeci);
+    put16(out + 16, s.batteryMillivolts);
+    put16(out + 18, s.fuelCentiPercent);
+    put32(out + 20, s.lastCommandSeq);
+    put32(out + 24, s.timeSinceActivity);
+    put32(out + 28, s.timeUntilSleep);
+    for (int i = 0; i < 4; i++) {
+        out[32 + i] = s.wifiIp[i];
+        out[36 + i] = s.apIp[i];
+    }
+    put32(out + 40, s.uptimeMs);
+}
+
+// New fields are only ever appended (the length byte grows); the version
+// changes only for an incompatible layout. False on a short or foreign record.
+inline bool decodeStatusBin(const uint8_t* data, size_t len, StatusBin& s) {
+    using namespace StatusBinCodec;
+    if (len < STATUS_BIN_SIZE || data[0] != STATUS_BIN_VERSION || data[1] < STATUS_BIN_SIZE || data[1] > len) {
+        return false;
+    }
+    s.flags = get16(data + 2);
+    s.generation = get32(data + 4);
+    s.state = data[8];
+    s.keyPosition = data[9];
+    s.apClients = data[10];
+    s.glowCountdown = get16(data + 12);
+    s.engineTempDeci = (int16_t)get16(data + 14);
+    s.batteryMillivolts = get16(data + 16);
+    s.fuelCentiPercent = get16(data + 18);
+    s.lastCommandSeq = get32(data + 20);
+    s.timeSinceActivity = get32(data + 24);
+    s.timeUntilSleep = get32(data + 28);
+    for (int i = 0; i < 4; i++) {
+        s.wifiIp[i] = data[32 + i];
+        s.apIp[i] = data[36 + i];
+    }
+    s.uptimeMs = get32(data + 40);
+    return true;
+}
+
+#endif // STATUS_BIN_H
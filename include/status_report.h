@@ -0,0 +1,67 @@
+/*
+ * Status Report Header for Bobcat Ignition Controller
+ * The dashboard status, captured as plain values so /status and the
+ * /events stream share one definition and the stream can send only the
+ * fields that changed. Each change is serialized once into a shared,
+ * immutable body tagged with a generation number; /status serves that
+ * body to every client (ETag, If-None-Match and ?since= long-poll).
+ */
+
+#ifndef STATUS_REPORT_H
+#define STATUS_REPORT_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "json_writer.h"
+
+// Follows the state machine and relays - pushed as soon as it changes
+struct StatusState {
+    uint8_t state;               // SystemState enum value
+    uint8_t relays;              // RELAY_* bits (getRelayStates())
+    uint8_t keyPosition;
+    bool startKeyHeld;
+    bool sleepModeEnabled;
+    bool oilPressureOk;
+    bool hydPressureOk;
+    uint32_t glowCountdown;      // Seconds left while the glow plugs are on
+    uint32_t lastCommandSeq;
+};
+
+// Analog readings, timers and WiFi - pushed at STATUS_SENSOR_PUSH_INTERVAL
+struct StatusSensors {
+    float engineTemp;
+    float batteryVoltage;
+    float fuelLevel;
+    uint32_t timeSinceActivity;  // Seconds
+    uint32_t timeUntilSleep;     // Seconds
+    bool sleepEligible;
+    bool wifiConnected;
+    uint32_t wifiIp;
+    char wifiSsid[33];
+    uint32_t apIp;
+    uint8_t apClients;
+};
+
+struct StatusReport {
+    StatusState state;
+    StatusSensors sensors;
+};
+
+void captureStatusState(StatusState& state);
+void captureStatusSensors(StatusSensors& sensors);
+
+// Write every /status field, or with `previous` only the ones that differ,
+// into an open object; returns the number of fields written
+uint16_t writeStatusJson(JsonWriter<JsonBufferSink>& json, const StatusReport& report, const StatusReport* previous = nullptr);
+
+// Register /status and /events (Server-Sent Events) and start the task
+// that detects changes
+void setupStatusEndpoints(AsyncWebServer& server);
+
+// Generation of the current /status body (increments on every change)
+uint32_t statusGeneration();
+
+// Browsers connected to /events
+size_t statusStreamClients();
+
+#endif // STATUS_REPORT_H
@@ -21,6 +21,7 @@ typedef struct {
     unsigned long ignitionStartTime;
     unsigned long shutdownStartTime;
     bool shutdownInProgress;
+    unsigned long lastCountdownLog;  // Last glow plug countdown message
 
     // Button and relay states
     bool emergencyStopPressed;
@@ -0,0 +1,65 @@
+/*
+ * Task Monitor Header for Bobcat Ignition Controller
+ * The control task, sensor sampling and ADC DMA run on CONTROL_CORE; the
+ * WiFi stack, web server, OTA, logging, status push, settings and station
+ * tasks on NETWORK_CORE. This module measures how well the control side
+ * is shielded: wake-up lateness and pass time of the control task, busy
+ * time of the tasks that report it, and (ESP32) the core, priority and
+ * stack high-water mark of every task we create or depend on.
+ */
+
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include <stdint.h>
+
+// X(id, FreeRTOS task name, reports its busy time)
+#define MONITORED_TASKS(X) \
+  X(TASK_CONTROL,        "control",        true)  \
+  X(TASK_SENSORS,        "sensors",        true)  \
+  X(TASK_ADC_DMA,        "adc_dma",        false) \
+  X(TASK_LOG,            "log",            true)  \
+  X(TASK_STATUS,         "status",         true)  \
+  X(TASK_SETTINGS,       "settings",       false) \
+  X(TASK_STATION,        "station",        false) \
+  X(TASK_LOOP,           "loopTask",       false) \
+  X(TASK_ASYNC_TCP,      "async_tcp",      false) \
+  X(TASK_ARDUINO_EVENTS, "arduino_events", false) \
+  X(TASK_TCPIP,          "tiT",            false) \
+  X(TASK_WIFI,           "wifi",           false)
+
+enum MonitoredTask : uint8_t {
+#define MONITORED_TASK_ENUM(id, name, timed) id,
+  MONITORED_TASKS(MONITORED_TASK_ENUM)
+#undef MONITORED_TASK_ENUM
+  MONITORED_TASK_COUNT
+};
+
+struct ControlTimingStats {
+  uint32_t passes;        // Control loop passes (tick, power profile, rescheduling)
+  uint32_t passMaxUs;
+  uint64_t passTotalUs;
+  uint32_t deadlineWakes; // Wake-ups on a deadline rather than wakeControlLoop()
+  uint32_t lateMaxUs;     // Worst wake-up past the deadline (1 ms tick resolution)
+  uint64_t lateTotalUs;
+};
+
+// The control task, from waitForNextControlEvent()
+void noteControlPass(uint32_t busyUs);
+void noteControlWake(uint32_t lateUs);
+
+// Tasks marked in MONITORED_TASKS: time spent working in one pass
+void noteTaskBusy(MonitoredTask task, uint32_t busyUs);
+
+// Start a new measurement window (/api/tasks?reset=1)
+void resetTaskMonitor();
+
+ControlTimingStats getControlTimingStats();
+uint32_t taskMonitorWindowMs();
+uint64_t taskBusyUs(MonitoredTask task);
+// Busy share of the window in percent; negative for tasks that don't report
+float taskCpuPercent(MonitoredTask task);
+
+const char* monitoredTaskName(MonitoredTask task);
+
+#endif // TASK_MONITOR_H
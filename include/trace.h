@@ -0,0 +1,94 @@
+/*
+ * Control Input Trace Header for Bobcat Ignition Controller
+ * Records everything a control tick consumes - tick time, the sensor
+ * snapshot it read, the commands it applied - plus the relay/state outputs
+ * it produced, as a compact byte stream in RAM. A host replay feeds the
+ * same inputs through the same code and diffs the outputs.
+ *
+ * Layout: the buffer is two segments; each starts with a keyframe (full
+ * controller state) so the older one can always be replayed from its
+ * start. When the active segment fills, the other one is cleared and
+ * recording continues there.
+ *
+ * Record: kind (1 byte), then its payload:
+ *   TRACE_KEYFRAME  time (u32), SystemState_t fields, relays, full snapshot
+ *   TRACE_TICK      varint ms since the previous tick/keyframe
+ *   TRACE_SNAPSHOT  varint field mask + changed fields (delta vs previous)
+ *   TRACE_COMMAND   type (u8), zigzag varint arg
+ *   TRACE_OUTPUT    relays (u8), state (u8)     (after a tick, on change)
+ * A tick's records only become visible to traceExport() once the tick has
+ * finished, so an export never ends half way through one.
+ * Export: "BTRC", version (u8), segment count (u8), then per segment
+ * a u32 length and its bytes (oldest first). Multi-byte values are LE.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sensors.h"
+#include "system_state.h"
+
+static const uint8_t TRACE_VERSION = 1;
+
+enum TraceKind : uint8_t {
+  TRACE_KEYFRAME = 1,
+  TRACE_TICK,
+  TRACE_SNAPSHOT,
+  TRACE_COMMAND,
+  TRACE_OUTPUT
+};
+
+// ============================================================================
+// Recording - control task only (called from runControlTick)
+// ============================================================================
+void traceTick(uint32_t now);                    // May start a new segment
+void traceSnapshot(const SensorSnapshot& sensors);
+void traceCommand(uint8_t type, int32_t arg);
+void traceOutputs(uint8_t relays, uint8_t state); // Ends the tick (recorded on change)
+
+// ============================================================================
+// Export - any task
+// ============================================================================
+size_t traceExportSize();
+size_t traceExport(uint8_t* out, size_t maxLen); // Returns bytes written
+void traceReset();                               // Next tick starts a fresh keyframe
+uint32_t traceRecordsDropped();                  // Records too large for a segment
+
+// ============================================================================
+// Decoding (host replay and tools)
+// ============================================================================
+struct TraceEvent {
+  TraceKind kind;
+  uint32_t timeMs;
+  SystemState_t state;       // TRACE_KEYFRAME
+  SensorSnapshot snapshot;   // TRACE_KEYFRAME, TRACE_SNAPSHOT (full, delta applied)
+  uint8_t relays;            // TRACE_KEYFRAME, TRACE_OUTPUT
+  uint8_t currentState;      // TRACE_OUTPUT
+  uint8_t commandType;       // TRACE_COMMAND
+  int32_t commandArg;        // TRACE_COMMAND
+};
+
+class TraceReader {
+public:
+  // `data` is a full export; returns false on a bad header
+  bool open(const uint8_t* data, size_t len);
+
+  // Next event in time order across segments; false at the end or on a
+  // malformed record (see error())
+  bool next(TraceEvent& event);
+  const char* error() const { return errorMessage; }
+
+private:
+  const uint8_t* data;
+  size_t len;
+  size_t pos;
+  size_t segmentEnd;
+  uint8_t segmentsLeft;
+  uint32_t timeMs;
+  SensorSnapshot baseline;
+  const char* errorMessage;
+};
+
+#endif // TRACE_H
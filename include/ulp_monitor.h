@@ -0,0 +1,59 @@
+/*
+ * Deep Sleep Monitor Header for Bobcat Ignition Controller
+ * While the main cores are in deep sleep, the ULP coprocessor samples the
+ * battery and polls the seat bar every ULP_SAMPLE_INTERVAL. It wakes the
+ * controller when the seat bar becomes engaged or the battery falls below
+ * the sleepWakeVoltage setting, and keeps the battery minimum and maximum
+ * of each ULP_HISTORY_WINDOW in RTC memory. ESP32 only.
+ * A wake needs an edge: the seat bar free when the controller slept (or
+ * released since), the battery above the threshold when it slept. The
+ * BOOT button still wakes it. The program (~440 bytes with its variables)
+ * must fit the ULP reserve of the SDK configuration (512 bytes in the
+ * Arduino core); if it does not load, BOOT is the only wake source. The
+ * sampling task and ADC DMA are stopped first so the ULP owns ADC1.
+ */
+
+#ifndef ULP_MONITOR_H
+#define ULP_MONITOR_H
+
+#include <stdint.h>
+
+// Battery windows kept by the ULP (a ring: the newest overwrite the oldest)
+constexpr uint8_t ULP_HISTORY_SLOTS = 8;
+
+enum UlpWakeReason : uint8_t {
+  ULP_WAKE_NONE,          // The ULP did not wake the controller
+  ULP_WAKE_SEAT_BAR,      // Seat bar engaged (it was free when the controller slept)
+  ULP_WAKE_LOW_BATTERY    // Battery fell below sleepWakeVoltage
+};
+
+// Raw ADC counts, as the ULP read them; convertBatteryVoltage() gives volts
+struct SleepBatteryWindow {
+  uint16_t minRaw;
+  uint16_t maxRaw;
+};
+
+struct SleepMonitorReport {
+  bool valid;                                    // The ULP ran during the last deep sleep
+  UlpWakeReason wakeReason;
+  uint16_t samples;                              // Saturates at 65535 (~91 h at 5 s)
+  uint16_t lastRaw;
+  uint16_t minRaw;
+  uint16_t maxRaw;
+  uint8_t windows;                               // Entries in history, oldest first
+  SleepBatteryWindow history[ULP_HISTORY_SLOTS]; // The newest may still be partial
+};
+
+// enterDeepSleep(), after the sensors are stopped: load and start the ULP
+// and enable it as a wake source. False if it could not be started; the
+// controller then sleeps with the BOOT button as the only wake source.
+bool startSleepMonitor();
+
+// handleWakeUp(), first thing: stop the ULP, give the seat bar pin back to
+// the GPIO matrix and collect what the ULP recorded
+void stopSleepMonitor();
+
+const SleepMonitorReport& sleepMonitorReport();
+const char* ulpWakeReasonName(UlpWakeReason reason);
+
+#endif // ULP_MONITOR_H
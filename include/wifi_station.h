@@ -0,0 +1,41 @@
+/*
+ * WiFi Station Header for Bobcat Ignition Controller
+ * Joins the home network in the background. The access point, web server
+ * and control loop never wait for it: association, DHCP and reconnects
+ * (with exponential backoff) run on their own task, driven by WiFi events.
+ * The last good channel and BSSID are kept in RTC memory, so the first
+ * attempt after a deep sleep wake skips the scan; the address always comes
+ * from DHCP (or homeStaticIP). An attempt that neither connects nor fails
+ * within WIFI_ATTEMPT_TIMEOUT counts as a drop.
+ */
+
+#ifndef WIFI_STATION_H
+#define WIFI_STATION_H
+
+#include <stdint.h>
+
+struct WifiStationStats {
+    uint32_t attempts;          // WiFi.begin() calls
+    uint32_t connects;          // Got an IP
+    uint32_t disconnects;       // Drops and failed attempts
+    uint32_t timeouts;          // Attempts given up after WIFI_ATTEMPT_TIMEOUT (also in disconnects)
+    uint8_t lastReason;         // wifi_err_reason_t of the last drop (0 = none yet, or a timeout)
+    uint32_t retryDelayMs;      // Wait before the next retry, doubles up to WIFI_RECONNECT_MAX_DELAY
+    uint32_t lastConnectMs;     // WiFi.begin() to IP, last successful attempt
+    uint32_t firstConnectAtMs;  // Uptime at the first IP since boot (0 = not yet)
+    bool fastConnect;           // Last connect used the cached channel and BSSID
+    bool staticAddress;         // Last attempt used homeStaticIP from the settings
+};
+
+// Call after WiFi.mode(WIFI_AP_STA); returns immediately. Credentials are
+// homeSSID / homePassword from the settings (empty SSID = access point
+// only); homeStaticIP / homeGateway / homeSubnet replace DHCP when set.
+void startWifiStation();
+
+// Reconnect if the home network settings changed
+void wifiSettingsChanged();
+
+// Diagnostics (a copy; fields are updated by the station task)
+WifiStationStats getWifiStationStats();
+
+#endif // WIFI_STATION_H
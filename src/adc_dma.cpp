@@ -0,0 +1,139 @@
+/*
+ * Continuous ADC Engine Implementation for Bobcat Ignition Controller
+ * ADC1 digital controller + DMA (I2S0 on the ESP32) sampling every analog
+ * input back-to-back; the reader task hands each frame to adc_ingest.cpp
+ */
+
+#include "adc_dma.h"
+#include "config.h"
+#include <driver/adc.h>
+
+// Analog inputs in AdcChannelId order
+static const int* const ADC_DMA_PINS[ADC_CHANNEL_COUNT] = {
+  &BATTERY_VOLTAGE_PIN,
+  &ENGINE_TEMP_PIN,
+  &OIL_PRESSURE_PIN,
+  &FUEL_LEVEL_PIN,
+  &HYD_PRESSURE_PIN
+};
+
+// Conversions handed over per DMA interrupt / read
+static const uint32_t ADC_DMA_FRAME_BYTES = 256;
+
+static TaskHandle_t adcTaskHandle = nullptr;
+static volatile bool adcDmaRunning = false;
+static volatile uint32_t framesRead = 0;
+
+static_assert(SOC_ADC_DIGI_RESULT_BYTES == ADC_DMA_RESULT_BYTES, "adcDmaIngestFrame() decodes 2-byte type 1 results");
+
+// Build the ADC1 channel -> ring lookup and the conversion pattern
+static bool mapChannels(adc_digi_pattern_config_t* pattern, uint32_t* adc1Mask) {
+  int8_t channels[ADC_CHANNEL_COUNT];
+  *adc1Mask = 0;
+
+  for (int i = 0; i < ADC_CHANNEL_COUNT; i++) {
+    int8_t channel = digitalPinToAnalogChannel(*ADC_DMA_PINS[i]);
+    if (channel < 0 || channel >= ADC1_CHANNEL_COUNT) {
+      Serial.print("ADC DMA: GPIO");
+      Serial.print(*ADC_DMA_PINS[i]);
+      Serial.println(" is not an ADC1 pin");
+      return false;
+    }
+    channels[i] = channel;
+    *adc1Mask |= 1u << channel;
+
+    pattern[i].atten = ADC_ATTEN_DB_11;        // Same 0-3.3V range analogRead() used
+    pattern[i].channel = channel;
+    pattern[i].unit = 0;                       // ADC1
+    pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+  }
+  adcSetChannelMap(channels);
+  return true;
+}
+
+static void adcDmaTask(void* parameter) {
+  static uint8_t frame[ADC_DMA_FRAME_BYTES];
+
+  for (;;) {
+    uint32_t length = 0;
+    esp_err_t result = adc_digi_read_bytes(frame, sizeof(frame), &length, portMAX_DELAY);
+    // ESP_ERR_INVALID_STATE means the driver's buffer overflowed; the data is still valid
+    if (result != ESP_OK && result != ESP_ERR_INVALID_STATE) {
+      continue;
+    }
+
+    adcDmaIngestFrame(frame, length);
+    framesRead++;
+  }
+}
+
+bool startAdcDma() {
+  if (adcDmaRunning) {
+    return true;
+  }
+
+  adc_digi_pattern_config_t pattern[ADC_CHANNEL_COUNT] = {};
+  uint32_t adc1Mask = 0;
+  if (!mapChannels(pattern, &adc1Mask)) {
+    return false;
+  }
+
+  adc_digi_init_config_t initConfig = {};
+  initConfig.max_store_buf_size = ADC_DMA_FRAME_BYTES * 4;
+  initConfig.conv_num_each_intr = ADC_DMA_FRAME_BYTES;
+  initConfig.adc1_chan_mask = adc1Mask;
+  initConfig.adc2_chan_mask = 0;               // ADC2 is unusable while WiFi is on
+
+  adc_digi_configuration_t digiConfig = {};
+  digiConfig.conv_limit_en = true;             // Required on the ESP32
+  digiConfig.conv_limit_num = 250;
+  digiConfig.pattern_num = ADC_CHANNEL_COUNT;
+  digiConfig.adc_pattern = pattern;
+  digiConfig.sample_freq_hz = ADC_DMA_SAMPLE_RATE;
+  digiConfig.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  digiConfig.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+
+  esp_err_t result = adc_digi_initialize(&initConfig);
+  if (result == ESP_OK) {
+    result = adc_digi_controller_configure(&digiConfig);
+  }
+  if (result == ESP_OK) {
+    result = adc_digi_start();
+  }
+  if (result != ESP_OK) {
+    Serial.print("ADC DMA: failed to start (");
+    Serial.print(esp_err_to_name(result));
+    Serial.println(") - using single-shot analogRead()");
+    adc_digi_deinitialize();
+    return false;
+  }
+
+  xTaskCreatePinnedToCore(adcDmaTask, "adc_dma", 2048, nullptr,
+                          SENSOR_TASK_PRIORITY + 1, &adcTaskHandle, CONTROL_CORE);
+  adcDmaRunning = true;
+
+  Serial.print("ADC DMA: continuous mode at ");
+  Serial.print(ADC_DMA_SAMPLE_RATE / ADC_CHANNEL_COUNT);
+  Serial.println(" Hz per channel");
+  return true;
+}
+
+void stopAdcDma() {
+  if (!adcDmaRunning) {
+    return;
+  }
+  adcDmaRunning = false;
+  // The reader only ever blocks in adc_digi_read_bytes(), holding nothing
+  vTaskDelete(adcTaskHandle);
+  adcTaskHandle = nullptr;
+  adc_digi_stop();
+  adc_digi_deinitialize();
+}
+
+bool isAdcDmaRunning() {
+  return adcDmaRunning;
+}
+
+uint32_t adcDmaFramesRead() {
+  return framesRead;
+}
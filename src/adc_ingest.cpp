@@ -0,0 +1,54 @@
+/*
+ * ADC Sample Ingest Implementation for Bobcat Ignition Controller
+ * Channel routing and frame decoding shared by the DMA reader task and
+ * the host runner
+ */
+
+#include "adc_ingest.h"
+#include <atomic>
+
+static AdcChannelRing adcRings[ADC_CHANNEL_COUNT];
+static int8_t channelToRing[ADC1_CHANNEL_COUNT] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+static std::atomic<uint32_t> samplesDropped(0);
+
+void adcSetChannelMap(const int8_t adc1Channels[ADC_CHANNEL_COUNT]) {
+  for (uint8_t i = 0; i < ADC1_CHANNEL_COUNT; i++) {
+    channelToRing[i] = -1;
+  }
+  for (uint8_t i = 0; i < ADC_CHANNEL_COUNT; i++) {
+    int8_t channel = adc1Channels[i];
+    if (channel >= 0 && channel < ADC1_CHANNEL_COUNT) {
+      channelToRing[channel] = i;
+    }
+  }
+}
+
+void adcDmaIngestSample(uint8_t adc1Channel, uint16_t value) {
+  int8_t ring = adc1Channel < ADC1_CHANNEL_COUNT ? channelToRing[adc1Channel] : -1;
+  if (ring < 0) {
+    samplesDropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  adcRings[ring].push(value);
+}
+
+size_t adcDmaIngestFrame(const uint8_t* frame, size_t length) {
+  size_t conversions = length / ADC_DMA_RESULT_BYTES;
+  for (size_t i = 0; i < conversions; i++) {
+    uint16_t word = frame[i * 2] | (uint16_t)(frame[i * 2 + 1] << 8);
+    adcDmaIngestSample(word >> 12, word & 0x0FFF);
+  }
+  return conversions;
+}
+
+const AdcChannelRing& adcRing(AdcChannelId channel) {
+  return adcRings[channel];
+}
+
+uint16_t adcAverage(AdcChannelId channel, size_t samples) {
+  return adcRings[channel].average(samples);
+}
+
+uint32_t adcDmaSamplesDropped() {
+  return samplesDropped.load(std::memory_order_relaxed);
+}
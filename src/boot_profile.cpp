@@ -0,0 +1,126 @@
+/*
+ * Boot Profile Implementation for Bobcat Ignition Controller
+ * The profile is kept in RTC memory with a CRC, refreshed on every mark,
+ * so whatever was recorded before a reset survives it
+ */
+
+#include "boot_profile.h"
+#include "hal.h"
+#include <stddef.h>
+#include <string.h>
+
+static const uint32_t BOOT_PROFILE_MAGIC = 0x50544F42;   // "BOTP" in memory order
+
+struct BootProfileRecord {
+  uint32_t magic;
+  BootProfile profile;
+  uint32_t crc;   // Of everything above
+};
+
+#ifdef ARDUINO
+// Not reloaded by the bootloader, so kept through software, watchdog, OTA
+// and brownout resets as well as deep sleep; random after a power-on (the
+// magic and CRC reject it). RTC_DATA_ATTR would be reset on every reboot.
+RTC_NOINIT_ATTR static BootProfileRecord record;
+// Milestones are marked from the station and control tasks too
+static portMUX_TYPE profileMux = portMUX_INITIALIZER_UNLOCKED;
+#define PROFILE_LOCK() portENTER_CRITICAL(&profileMux)
+#define PROFILE_UNLOCK() portEXIT_CRITICAL(&profileMux)
+#else
+static BootProfileRecord record;
+#define PROFILE_LOCK()
+#define PROFILE_UNLOCK()
+#endif
+
+static BootProfile previous;
+static bool hasPrevious = false;
+static uint32_t phaseStartUs[BOOT_PHASE_COUNT];
+
+static uint32_t recordCrc() {
+  return halCrc32(0, &record, offsetof(BootProfileRecord, crc));
+}
+
+static bool recordValid() {
+  return record.magic == BOOT_PROFILE_MAGIC && record.crc == recordCrc();
+}
+
+void startBootProfile(bool wake) {
+  uint32_t now = halMicros();
+  uint32_t bootCount = 1;
+  PROFILE_LOCK();
+  if (recordValid()) {
+    previous = record.profile;
+    hasPrevious = true;
+    bootCount = previous.bootCount + 1;
+  }
+  memset(&record, 0, sizeof(record));
+  record.magic = BOOT_PROFILE_MAGIC;
+  record.profile.phaseUs[BOOT_PHASE_CORE] = now;
+  record.profile.bootCount = bootCount;
+  record.profile.wake = wake;
+  record.crc = recordCrc();
+  PROFILE_UNLOCK();
+}
+
+void startBootPhase(BootPhase phase) {
+  if (phase < BOOT_PHASE_COUNT) {
+    phaseStartUs[phase] = halMicros();
+  }
+}
+
+void endBootPhase(BootPhase phase) {
+  if (phase >= BOOT_PHASE_COUNT) {
+    return;
+  }
+  uint32_t elapsed = halMicros() - phaseStartUs[phase];
+  PROFILE_LOCK();
+  record.profile.phaseUs[phase] = elapsed;
+  record.crc = recordCrc();
+  PROFILE_UNLOCK();
+}
+
+void markBootMilestone(BootMilestone milestone) {
+  if (milestone >= BOOT_MILESTONE_COUNT) {
+    return;
+  }
+  uint32_t now = halMicros();
+  PROFILE_LOCK();
+  if (record.profile.milestoneUs[milestone] == 0) {
+    record.profile.milestoneUs[milestone] = now != 0 ? now : 1;   // 0 means "not reached"
+    record.crc = recordCrc();
+  }
+  PROFILE_UNLOCK();
+}
+
+uint32_t bootMilestoneUs(BootMilestone milestone) {
+  return milestone < BOOT_MILESTONE_COUNT ? record.profile.milestoneUs[milestone] : 0;
+}
+
+bool bootFromDeepSleep() {
+  return record.profile.wake;
+}
+
+BootProfile currentBootProfile() {
+  PROFILE_LOCK();
+  BootProfile profile = record.profile;
+  PROFILE_UNLOCK();
+  return profile;
+}
+
+bool previousBootProfile(BootProfile& profile) {
+  if (hasPrevious) {
+    profile = previous;
+  }
+  return hasPrevious;
+}
+
+void printBootProfile() {
+  BootProfile profile = currentBootProfile();
+  Serial.printf("Boot profile (%s %lu):\n", profile.wake ? "wake" : "boot", (unsigned long)profile.bootCount);
+  for (uint8_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+    // Key text is "\"name\":"
+    const JsonKey& key = BOOT_PHASE_KEYS[i];
+    Serial.printf("  %-15.*s %8lu us\n", key.length - 3, key.text + 1, (unsigned long)profile.phaseUs[i]);
+  }
+  Serial.printf("  setup done at   %8lu us\n", (unsigned long)profile.milestoneUs[BOOT_SETUP_DONE]);
+}
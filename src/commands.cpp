@@ -0,0 +1,166 @@
+/*
+ * Control Command Queue Implementation for Bobcat Ignition Controller
+ * Only the control loop touches key/start/light state; web handlers
+ * go through this queue instead of writing g_systemState directly
+ */
+
+#include "commands.h"
+#include "config.h"
+#include "hardware.h"
+#include "safety.h"
+#include "system_state.h"
+#include "mpsc_queue.h"
+#include "control_scheduler.h"
+#include "logger.h"
+#include "hal.h"
+#include "trace.h"
+
+// Outstanding commands (bursty clicks from several clients fit easily)
+static MpscQueue<Command, 32> commandQueue;
+
+// Outcome of the last RESULT_SLOTS commands, packed as (sequence << 2) | result
+static const uint32_t RESULT_SLOTS = 32;
+static std::atomic<uint32_t> commandResults[RESULT_SLOTS];
+
+static std::atomic<uint32_t> lastApplied(0);
+static std::atomic<uint32_t> dropped(0);
+
+// Queue position -> sequence number (30 bits, so it packs with a result)
+static uint32_t sequenceAt(uint32_t position) {
+  return (position + 1) & 0x3FFFFFFF;
+}
+
+uint32_t submitCommand(CommandType type, int32_t arg) {
+  Command command;
+  command.type = type;
+  command.arg = arg;
+
+  // Numbered by the slot the push claimed rather than before it: two
+  // tasks submitting at once can't end up queued against their numbers
+  uint32_t position;
+  if (!commandQueue.push(command, &position)) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+  }
+  wakeControlLoop();
+  return sequenceAt(position);
+}
+
+static void recordResult(uint32_t sequence, CommandResult result) {
+  commandResults[sequence % RESULT_SLOTS].store((sequence << 2) | result, std::memory_order_release);
+  lastApplied.store(sequence, std::memory_order_release);
+}
+
+static CommandResult applyCommand(const Command& command) {
+  switch (command.type) {
+    case CMD_KEY_POSITION:
+      if (command.arg < 0 || command.arg > 3) {
+        return CMD_RESULT_REJECTED;
+      }
+      LOG_INFO("Key position command: %d -> %d", g_systemState.keyPosition, command.arg);
+      g_systemState.keyPosition = command.arg;
+      return CMD_RESULT_APPLIED;
+
+    case CMD_KEY_START_HOLD:
+      g_systemState.keyStartHeld = command.arg != 0;
+      if (g_systemState.keyStartHeld) {
+        g_systemState.startHoldTime = halMillis();
+        g_systemState.keyPosition = 3; // Move to START position
+      } else {
+        g_systemState.keyPosition = 2; // Return to GLOW position when released
+      }
+      LOG_INFO("Start key %s", g_systemState.keyStartHeld ? "held" : "released");
+      return CMD_RESULT_APPLIED;
+
+    case CMD_EMERGENCY_STOP:
+      g_systemState.emergencyStopPressed = true;
+      LOG_WARN("EMERGENCY STOP activated via web interface");
+      return CMD_RESULT_APPLIED;
+
+    case CMD_TOGGLE_LIGHTS:
+      virtualLightsButton();
+      return CMD_RESULT_APPLIED;
+
+    case CMD_LEGACY_START:
+      virtualStartButton();
+      return CMD_RESULT_APPLIED;
+
+    case CMD_POWER_ON:
+      virtualPowerOnButton();
+      return CMD_RESULT_APPLIED;
+
+    case CMD_POWER_OFF:
+      virtualPowerOffButton();
+      return CMD_RESULT_APPLIED;
+
+    case CMD_OVERRIDE_START:
+      overrideStart();
+      return CMD_RESULT_APPLIED;
+
+    case CMD_TOGGLE_SLEEP_MODE:
+      g_systemState.sleepModeEnabled = !g_systemState.sleepModeEnabled;
+      LOG_INFO(g_systemState.sleepModeEnabled ? "Sleep mode enabled" : "Sleep mode disabled");
+      return CMD_RESULT_APPLIED;
+
+    case CMD_SLEEP_NOW:
+      // Conditions are re-checked here; the web handler only pre-checked them
+      if (!checkSleepConditions(true)) {
+        return CMD_RESULT_REJECTED;
+      }
+      LOG_INFO("Manual sleep command received");
+      halDelay(100); // Give the HTTP response time to leave
+      enterDeepSleep();
+      return CMD_RESULT_APPLIED; // Not reached
+  }
+  return CMD_RESULT_REJECTED;
+}
+
+uint32_t processPendingCommands(void (*step)()) {
+  Command command;
+  uint32_t position;
+  uint32_t applied = 0;
+  while (commandQueue.pop(command, &position)) {
+    traceCommand(command.type, command.arg);
+    updateActivityTimer();
+    CommandResult result = applyCommand(command);
+    if (command.type == CMD_SLEEP_NOW && result == CMD_RESULT_REJECTED) {
+      LOG_WARN("Sleep command rejected - unsafe conditions");
+    }
+    // Executed before the next command can overwrite the same input, and
+    // before the result says so
+    step();
+    recordResult(sequenceAt(position), result);
+    applied++;
+  }
+  return applied;
+}
+
+CommandResult getCommandResult(uint32_t sequence) {
+  if (sequence == 0 || sequence > sequenceAt(commandQueue.pushed() - 1)) {
+    return CMD_RESULT_UNKNOWN;
+  }
+  uint32_t packed = commandResults[sequence % RESULT_SLOTS].load(std::memory_order_acquire);
+  uint32_t slotSequence = packed >> 2;
+  if (slotSequence == sequence) {
+    return (CommandResult)(packed & 0x3);
+  }
+  // Slot still holds an older command: ours hasn't been applied yet
+  return slotSequence < sequence ? CMD_RESULT_PENDING : CMD_RESULT_UNKNOWN;
+}
+
+const char* commandResultToString(CommandResult result) {
+  switch (result) {
+    case CMD_RESULT_PENDING: return "pending";
+    case CMD_RESULT_APPLIED: return "applied";
+    case CMD_RESULT_REJECTED: return "rejected";
+    default: return "unknown";
+  }
+}
+
+uint32_t lastAppliedCommandSequence() {
+  return lastApplied.load(std::memory_order_acquire);
+}
+
+uint32_t commandsDropped() {
+  return dropped.load(std::memory_order_relaxed);
+}
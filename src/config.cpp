@@ -39,12 +39,87 @@ const int SLEEP_ENABLE_PIN = 12;          // GPIO12 - Enable deep sleep mode (op
 const unsigned long GLOW_PLUG_DURATION = 20000;   // 20 seconds glow plug preheat
 const unsigned long IGNITION_TIMEOUT = 10000;     // 10 seconds max cranking
 const unsigned long COOLDOWN_DURATION = 120000;   // 2 minutes post-shutdown cooldown
+const unsigned long GLOW_COUNTDOWN_INTERVAL = 2000; // Glow plug countdown message period
+
+// ============================================================================
+// CONTROL LOOP SCHEDULING
+// ============================================================================
+const unsigned long CONTROL_HOUSEKEEPING_INTERVAL = 100; // Longest control loop sleep (safety checks)
+
+// ============================================================================
+// CONTROL TASK AND CORE PLACEMENT
+// ============================================================================
+const int CONTROL_CORE = 1;                       // APP_CPU: nothing of the WiFi stack is pinned here
+const int NETWORK_CORE = 0;                       // PRO_CPU, where the WiFi driver task already runs
+const int CONTROL_TASK_PRIORITY = 19;             // Above lwIP (18, either core) and AsyncTCP (10), below the WiFi driver (23)
+const uint32_t CONTROL_TASK_STACK_SIZE = 8192;    // Same as the Arduino loop task it replaces
+const unsigned long OTA_POLL_INTERVAL = 100;      // The cadence loop() had when it also ran the control loop
+
+// ============================================================================
+// SENSOR SAMPLING TASK
+// ============================================================================
+const unsigned long SENSOR_SAMPLE_INTERVAL = 50;  // 20 Hz - fixed rate for the temperature filter
+const int SENSOR_TASK_PRIORITY = 2;               // Below the control task on the same core (snapshot_publisher.h)
+const uint32_t SENSOR_TASK_STACK_SIZE = 3072;
+const uint32_t ADC_DMA_SAMPLE_RATE = 20000;       // 20 kHz (ESP32 minimum) = 4 kHz per channel
+const size_t ADC_DMA_AVERAGE_SAMPLES = 64;        // 16 ms of conversions per channel
+
+// ============================================================================
+// LOGGING
+// ============================================================================
+const int LOG_TASK_PRIORITY = 1;                  // Same as loop(), which now spends most of its time blocked
+const uint32_t LOG_TASK_STACK_SIZE = 3072;
+const size_t TRACE_BUFFER_SIZE = 32768;           // ~2 minutes of ticks at 20 Hz sampling
+
+// ============================================================================
+// WEB STATUS PUSH (/events)
+// ============================================================================
+const unsigned long STATUS_STATE_POLL_INTERVAL = 50;     // Key/relay changes reach the browser within ~50 ms
+const unsigned long STATUS_SENSOR_PUSH_INTERVAL = 1000;  // Same cadence the dashboard used to poll at
+const unsigned long STATUS_LONG_POLL_TIMEOUT = 25000;    // Under typical 30 s proxy/browser idle timeouts
+const int STATUS_PUSH_TASK_PRIORITY = 1;                 // Below the sensor task, same as loop()
+const uint32_t STATUS_PUSH_TASK_STACK_SIZE = 6144;       // Three 1 KB JSON documents/buffers on a change
+
+// ============================================================================
+// SETTINGS STORAGE
+// ============================================================================
+const unsigned long SETTINGS_COMMIT_DELAY = 2000;  // One flash write for a burst of edits
+const int SETTINGS_TASK_PRIORITY = 1;              // Same as loop(); the write blocks only this task
+const uint32_t SETTINGS_TASK_STACK_SIZE = 3072;
+
+// ============================================================================
+// WIFI STATION (home network)
+// ============================================================================
+const unsigned long WIFI_RECONNECT_MIN_DELAY = 2000;  // Longer than a typical association + DHCP
+const unsigned long WIFI_RECONNECT_MAX_DELAY = 60000; // Away from the yard: retry once a minute
+const unsigned long WIFI_ATTEMPT_TIMEOUT = 20000;     // Scan, association, 4-way handshake and DHCP retries
+const int WIFI_TASK_PRIORITY = 1;                     // Only calls into the WiFi driver, never waits on it
+const uint32_t WIFI_TASK_STACK_SIZE = 3072;
 
 // ============================================================================
 // POWER MANAGEMENT CONSTANTS (in milliseconds)
 // ============================================================================
 const unsigned long SLEEP_TIMEOUT = 1800000;      // 30 minutes before auto-sleep
 const unsigned long ACTIVITY_TIMEOUT = 300000;    // 5 minutes of inactivity before sleep eligibility
+const unsigned long SLEEP_BOOT_GRACE_PERIOD = 120000; // 2 minutes after boot with no auto-sleep
+
+// ============================================================================
+// POWER PROFILES
+// ============================================================================
+const int POWER_FULL_CPU_MHZ = 240;
+const int POWER_IDLE_CPU_MAX_MHZ = 80;        // Lowest clock the WiFi driver runs at
+const int POWER_IDLE_CPU_MIN_MHZ = 40;        // XTAL
+// ESP32 module figures (datasheet, not measured on this board). The access
+// point keeps the radio listening in every profile, which dominates.
+const float POWER_IDLE_CURRENT_MA = 95.0f;    // 80 MHz, radio listening
+const float POWER_CLIENT_CURRENT_MA = 130.0f; // 240 MHz, radio receiving and transmitting
+const float POWER_ENGINE_CURRENT_MA = 115.0f; // 240 MHz, radio listening
+
+// ============================================================================
+// DEEP SLEEP MONITOR (ULP coprocessor)
+// ============================================================================
+const unsigned long ULP_SAMPLE_INTERVAL = 5000;   // Seat bar noticed within 5 s; the ULP runs ~100 µs of it
+const unsigned long ULP_HISTORY_WINDOW = 3600000; // One entry per hour: 8 hours of history
 
 
 // SENSOR CALIBRATION CONSTANTS - Only for sensors we're using
@@ -0,0 +1,165 @@
+/*
+ * Control Loop Scheduler Implementation for Bobcat Ignition Controller
+ * Deadlines are derived from g_systemState after every tick, so the
+ * state machine stays the single source of truth for timing
+ */
+
+#include "control_scheduler.h"
+#include "config.h"
+#include "hal.h"
+#include "commands.h"
+#include "boot_profile.h"
+#include "hardware.h"
+#include "logger.h"
+#include "safety.h"
+#include "system_state.h"
+#include "sensors.h"
+#include "task_monitor.h"
+#include "trace.h"
+
+static DeadlineScheduler scheduler;
+static uint32_t passStartUs = 0;   // When the control task last woke
+static bool passStarted = false;
+
+#ifdef ARDUINO
+static TaskHandle_t controlTask = nullptr;
+
+void registerControlTask() {
+  controlTask = xTaskGetCurrentTaskHandle();
+}
+
+void wakeControlLoop() {
+  if (controlTask != nullptr) {
+    xTaskNotifyGive(controlTask);
+  }
+}
+#else
+// Host builds are single-threaded: a wake-up is remembered like a pending
+// task notification and makes the next wait return without sleeping
+static bool wakePending = false;
+
+void registerControlTask() {}
+void wakeControlLoop() {
+  wakePending = true;
+}
+#endif
+
+void runControlTick() {
+  // Don't allow automatic sleep for the first 2 minutes after boot
+  // This gives time to connect and configure the system
+  unsigned long currentTime = halMillis();
+
+  // Everything this tick decides on is read once here and traced, so a
+  // recorded session replays on the host with the same outputs
+  SensorSnapshot sensors = getSensorSnapshot();
+  traceTick(currentTime);
+  traceSnapshot(sensors);
+
+  if (currentTime < SLEEP_BOOT_GRACE_PERIOD) {
+    // During grace period, just update activity timer to keep system awake
+    g_systemState.lastActivityTime = currentTime;
+  } else {
+    // After grace period, check for sleep conditions and enter sleep if appropriate
+    if (checkSleepConditions()) {
+      unsigned long timeSinceActivity = currentTime - g_systemState.lastActivityTime;
+      
+      if (timeSinceActivity >= SLEEP_TIMEOUT) {
+        Serial.println("Sleep timeout reached - entering deep sleep mode");
+        enterDeepSleep();
+        // Code will not reach here as ESP32 will sleep
+      }
+    }
+  }
+  
+  // Queued web commands in order, each followed by an ignition state
+  // machine step; with none queued the machine still steps for its timers
+  if (processPendingCommands(runIgnitionSequence) == 0) {
+    runIgnitionSequence();
+  }
+  
+  // Only check engine vitals when running
+  if (g_systemState.currentState == RUNNING) { 
+    checkEngineVitals(sensors);
+  } 
+  
+  // Always run safety checks except during start cranking
+  if (g_systemState.currentState != START) {
+    checkSafetyInputs(sensors);
+  }
+
+  traceOutputs(getRelayStates(), (uint8_t)g_systemState.currentState);
+
+  if (bootMilestoneUs(BOOT_FIRST_TICK) == 0) {
+    markBootMilestone(BOOT_FIRST_TICK);
+    LOG_INFO("First control tick %lu ms after boot", (unsigned long)(bootMilestoneUs(BOOT_FIRST_TICK) / 1000));
+  }
+}
+
+void scheduleControlDeadlines() {
+  uint32_t now = halMillis();
+  uint8_t relays = getRelayStates();
+
+  if (relays & RELAY_GLOW_PLUGS) {
+    scheduler.arm(TIMER_GLOW_EXPIRY, g_systemState.glowPlugStartTime + GLOW_PLUG_DURATION);
+  } else {
+    scheduler.cancel(TIMER_GLOW_EXPIRY);
+  }
+
+  if (relays & RELAY_STARTER) {
+    scheduler.arm(TIMER_CRANK_TIMEOUT, g_systemState.ignitionStartTime + IGNITION_TIMEOUT);
+  } else {
+    scheduler.cancel(TIMER_CRANK_TIMEOUT);
+  }
+
+  if (g_systemState.currentState == GLOW_PLUG) {
+    scheduler.arm(TIMER_GLOW_COUNTDOWN, g_systemState.lastCountdownLog + GLOW_COUNTDOWN_INTERVAL);
+  } else {
+    scheduler.cancel(TIMER_GLOW_COUNTDOWN);
+  }
+
+  // Only worth waking for if nothing but the clock stands in the way of sleep
+  if (g_systemState.sleepModeEnabled && g_systemState.keyPosition == 0) {
+    uint32_t due = g_systemState.lastActivityTime + SLEEP_TIMEOUT;
+    if ((int32_t)(due - SLEEP_BOOT_GRACE_PERIOD) < 0) {
+      due = SLEEP_BOOT_GRACE_PERIOD;
+    }
+    scheduler.arm(TIMER_SLEEP, due);
+  } else {
+    scheduler.cancel(TIMER_SLEEP);
+  }
+
+  if (!scheduler.isArmed(TIMER_HOUSEKEEPING)) {
+    scheduler.arm(TIMER_HOUSEKEEPING, now + CONTROL_HOUSEKEEPING_INTERVAL);
+  }
+}
+
+uint32_t waitForNextControlEvent() {
+  uint32_t waitStartUs = halMicros();
+  if (passStarted) {
+    noteControlPass(waitStartUs - passStartUs);
+  }
+
+  uint32_t wait = scheduler.timeUntilNext(halMillis(), CONTROL_HOUSEKEEPING_INTERVAL);
+  bool onDeadline = false;
+  if (wait > 0) {
+#ifdef ARDUINO
+    // Returns early when wakeControlLoop() is called
+    onDeadline = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait)) == 0;
+#else
+    if (!wakePending) {
+      halDelay(wait); // Jumps the virtual clock straight to the deadline
+      onDeadline = true;
+    }
+    wakePending = false;
+#endif
+  }
+
+  passStartUs = halMicros();
+  passStarted = true;
+  if (onDeadline) {
+    // A timeout can also end up to a tick early; only lateness counts
+    int32_t late = (int32_t)(passStartUs - waitStartUs - wait * 1000);
+    noteControlWake(late > 0 ? (uint32_t)late : 0);
+  }
+  return scheduler.takeExpired(halMillis());
+}
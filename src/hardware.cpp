@@ -6,33 +6,83 @@
 #include "hardware.h"
 #include "config.h"
 #include "system_state.h"
-#include <Preferences.h>
+#include "logger.h"
+#include "settings.h"
+#include "hal.h"
+#include "snapshot_publisher.h"
+#include "resume_state.h"
+#include <string.h>
+
+// Runtime calibration constants (loaded from preferences). Written by
+// setup() and the web server task, read by the sampling task and handlers.
+static SnapshotPublisher<CalibrationConstants> calibrationPublisher;
+
+static CalibrationConstants defaultCalibration() {
+  return CalibrationConstants{
+    BATTERY_VOLTAGE_DIVIDER,
+    TEMP_SENSOR_SCALE,
+    OIL_PRESSURE_SCALE,
+    HYD_PRESSURE_SCALE,
+    (int)FUEL_LEVEL_EMPTY,
+    (int)FUEL_LEVEL_FULL
+  };
+}
+
+CalibrationConstants getCalibration() {
+  if (calibrationPublisher.generation() == 0) {
+    return defaultCalibration();   // Before initializePins()
+  }
+  return calibrationPublisher.read();
+}
+
+uint32_t calibrationGeneration() {
+  return calibrationPublisher.generation();
+}
+
+void publishCalibration(const CalibrationConstants& calibration) {
+  calibrationPublisher.publish(calibration);
+}
 
-// Runtime calibration constants (loaded from preferences)
-float runtime_battery_divider = BATTERY_VOLTAGE_DIVIDER;
-float runtime_temp_scale = TEMP_SENSOR_SCALE;
-float runtime_pressure_scale = OIL_PRESSURE_SCALE;
-float runtime_hyd_pressure_scale = HYD_PRESSURE_SCALE;
-int runtime_fuel_empty = FUEL_LEVEL_EMPTY;
-int runtime_fuel_full = FUEL_LEVEL_FULL;
+// Last commanded relay outputs (RelayBit mask)
+static uint8_t relayStates = 0;
+
+static void setRelayBit(uint8_t bit, bool enable) {
+  relayStates = enable ? (relayStates | bit) : (relayStates & ~bit);
+}
 
 // Temperature sensor moving average filter
-#define TEMP_FILTER_SIZE 10
 float tempReadings[TEMP_FILTER_SIZE];
 int tempIndex = 0;
 bool tempFilterInitialized = false;
 
+TempFilterState getTempFilter() {
+  TempFilterState filter;
+  memcpy(filter.readings, tempReadings, sizeof(filter.readings));
+  filter.index = (uint8_t)tempIndex;
+  filter.initialized = tempFilterInitialized;
+  return filter;
+}
+
+void restoreTempFilter(const TempFilterState& filter) {
+  memcpy(tempReadings, filter.readings, sizeof(tempReadings));
+  tempIndex = filter.index % TEMP_FILTER_SIZE;
+  tempFilterInitialized = filter.initialized;
+}
+
 void initializePins() {
   Serial.println("Initializing GPIO pins...");
   
-  // Load calibration constants from preferences
-  loadCalibrationConstants();
+  // Load calibration constants from preferences (a deep sleep wake may
+  // already have restored them from RTC memory)
+  if (calibrationGeneration() == 0) {
+    loadCalibrationConstants();
+  }
   
   // Initialize output pins for relays
-  pinMode(MAIN_POWER_PIN, OUTPUT);
-  pinMode(GLOW_PLUGS_PIN, OUTPUT);
-  pinMode(STARTER_PIN, OUTPUT);
-  pinMode(LIGHTS_PIN, OUTPUT);
+  halPinMode(MAIN_POWER_PIN, OUTPUT);
+  halPinMode(GLOW_PLUGS_PIN, OUTPUT);
+  halPinMode(STARTER_PIN, OUTPUT);
+  halPinMode(LIGHTS_PIN, OUTPUT);
 
   Serial.print("Relay pins configured: ");
   Serial.print("Main Power (GPIO"); Serial.print(MAIN_POWER_PIN); Serial.print("), ");
@@ -41,16 +91,16 @@ void initializePins() {
   Serial.print("Lights (GPIO"); Serial.print(LIGHTS_PIN); Serial.println(")");
 
   // Initialize digital input pins
-  pinMode(ENGINE_RUN_FEEDBACK_PIN, INPUT_PULLUP);
-  pinMode(ALTERNATOR_CHARGE_PIN, INPUT_PULLUP);
+  halPinMode(ENGINE_RUN_FEEDBACK_PIN, INPUT_PULLUP);
+  halPinMode(ALTERNATOR_CHARGE_PIN, INPUT_PULLUP);
   
   // Initialize safety interlock pins (MANDATORY for safe operation)
-  pinMode(SEAT_BAR_PIN, INPUT_PULLUP);
-  pinMode(NEUTRAL_SAFETY_PIN, INPUT_PULLUP);
+  halPinMode(SEAT_BAR_PIN, INPUT_PULLUP);
+  halPinMode(NEUTRAL_SAFETY_PIN, INPUT_PULLUP);
   
   // Initialize pressure switch pins as digital inputs (not analog)
-  pinMode(OIL_PRESSURE_PIN, INPUT_PULLUP);
-  pinMode(HYD_PRESSURE_PIN, INPUT_PULLUP);
+  halPinMode(OIL_PRESSURE_PIN, INPUT_PULLUP);
+  halPinMode(HYD_PRESSURE_PIN, INPUT_PULLUP);
   
   Serial.print("Safety interlocks configured: ");
   Serial.print("Seat Bar (GPIO"); Serial.print(SEAT_BAR_PIN); Serial.print("), ");
@@ -63,62 +113,70 @@ void initializePins() {
   // ADC pins for sensors (no pinMode needed for ADC)
 
   // Initialize all outputs to safe state
-  digitalWrite(MAIN_POWER_PIN, LOW);
-  digitalWrite(GLOW_PLUGS_PIN, LOW);
-  digitalWrite(STARTER_PIN, LOW);
-  digitalWrite(LIGHTS_PIN, LOW);
+  halDigitalWrite(MAIN_POWER_PIN, LOW);
+  halDigitalWrite(GLOW_PLUGS_PIN, LOW);
+  halDigitalWrite(STARTER_PIN, LOW);
+  halDigitalWrite(LIGHTS_PIN, LOW);
+  relayStates = 0;
   
   Serial.println("All relays initialized to OFF state");
   Serial.println("GPIO initialization complete");
 }
 
 void loadCalibrationConstants() {
-  Preferences prefs;
+  HalNvs prefs;
   prefs.begin("calibration", true); // Open in read-only mode
   
-  // Load constants with defaults from config
-  runtime_battery_divider = prefs.getFloat("battery_div", BATTERY_VOLTAGE_DIVIDER);
-  runtime_temp_scale = prefs.getFloat("temp_scale", TEMP_SENSOR_SCALE);
-  runtime_pressure_scale = prefs.getFloat("pressure_scale", OIL_PRESSURE_SCALE);
-  runtime_hyd_pressure_scale = prefs.getFloat("hyd_pressure_scale", HYD_PRESSURE_SCALE);
-  runtime_fuel_empty = prefs.getInt("fuel_empty", (int)FUEL_LEVEL_EMPTY);
-  runtime_fuel_full = prefs.getInt("fuel_full", (int)FUEL_LEVEL_FULL);
+  // Load constants with defaults from config into a private copy, then
+  // publish them together
+  CalibrationConstants calibration;
+  calibration.batteryDivider = prefs.getFloat("battery_div", BATTERY_VOLTAGE_DIVIDER);
+  calibration.tempScale = prefs.getFloat("temp_scale", TEMP_SENSOR_SCALE);
+  calibration.pressureScale = prefs.getFloat("pressure_scale", OIL_PRESSURE_SCALE);
+  calibration.hydPressureScale = prefs.getFloat("hyd_pressure_scale", HYD_PRESSURE_SCALE);
+  calibration.fuelEmpty = prefs.getInt("fuel_empty", (int)FUEL_LEVEL_EMPTY);
+  calibration.fuelFull = prefs.getInt("fuel_full", (int)FUEL_LEVEL_FULL);
   
   prefs.end();
+  publishCalibration(calibration);
   
   Serial.println("Calibration constants loaded:");
-  Serial.print("  Battery divider: "); Serial.println(runtime_battery_divider, 6);
-  Serial.print("  Temperature scale: "); Serial.println(runtime_temp_scale, 6);
-  Serial.print("  Pressure scale: "); Serial.println(runtime_pressure_scale, 6);
-  Serial.print("  Hyd pressure scale: "); Serial.println(runtime_hyd_pressure_scale, 6);
-  Serial.print("  Fuel empty ADC: "); Serial.println(runtime_fuel_empty);
-  Serial.print("  Fuel full ADC: "); Serial.println(runtime_fuel_full);
+  Serial.print("  Battery divider: "); Serial.println(calibration.batteryDivider, 6);
+  Serial.print("  Temperature scale: "); Serial.println(calibration.tempScale, 6);
+  Serial.print("  Pressure scale: "); Serial.println(calibration.pressureScale, 6);
+  Serial.print("  Hyd pressure scale: "); Serial.println(calibration.hydPressureScale, 6);
+  Serial.print("  Fuel empty ADC: "); Serial.println(calibration.fuelEmpty);
+  Serial.print("  Fuel full ADC: "); Serial.println(calibration.fuelFull);
 }
 
 void controlMainPower(bool enable) {
-    digitalWrite(MAIN_POWER_PIN, enable ? HIGH : LOW);
-    Serial.print("Main Power: ");
-    Serial.println(enable ? "ON" : "OFF");
+    halDigitalWrite(MAIN_POWER_PIN, enable ? HIGH : LOW);
+    setRelayBit(RELAY_MAIN_POWER, enable);
+    LOG_INFO("Main Power: %s", enable ? "ON" : "OFF");
 }
 
 void controlGlowPlugs(bool enable) {
-  digitalWrite(GLOW_PLUGS_PIN, enable ? HIGH : LOW);
-  Serial.print("Glow Plugs: ");
-  Serial.println(enable ? "ON" : "OFF");
+  halDigitalWrite(GLOW_PLUGS_PIN, enable ? HIGH : LOW);
+  setRelayBit(RELAY_GLOW_PLUGS, enable);
+  LOG_INFO("Glow Plugs: %s", enable ? "ON" : "OFF");
 }
 
 // controlIgnition function removed - not used in this Bobcat model
 
 void controlStarter(bool enable) {
-  digitalWrite(STARTER_PIN, enable ? HIGH : LOW);
-  Serial.print("Starter: ");
-  Serial.println(enable ? "ON" : "OFF");
+  halDigitalWrite(STARTER_PIN, enable ? HIGH : LOW);
+  setRelayBit(RELAY_STARTER, enable);
+  LOG_INFO("Starter: %s", enable ? "ON" : "OFF");
 }
 
 void controlLights(bool enable) {
-    digitalWrite(LIGHTS_PIN, enable ? HIGH : LOW);
-    Serial.print("Lights: ");
-    Serial.println(enable ? "ON" : "OFF");
+    halDigitalWrite(LIGHTS_PIN, enable ? HIGH : LOW);
+    setRelayBit(RELAY_LIGHTS, enable);
+    LOG_INFO("Lights: %s", enable ? "ON" : "OFF");
+}
+
+uint8_t getRelayStates() {
+  return relayStates;
 }
 
 // Virtual button functions for web interface - Tesla-style fly-by-wire control
@@ -126,44 +184,47 @@ void virtualPowerOnButton() {
     // Set key position to ON
     if (g_systemState.keyPosition == 0) {
         g_systemState.keyPosition = 1;
-        Serial.println("Web Interface: POWER ON button pressed");
+        LOG_INFO("Web Interface: POWER ON button pressed");
     }
 }
 
 void virtualPowerOffButton() {
     // Set key position to OFF
     g_systemState.keyPosition = 0;
-    Serial.println("Web Interface: POWER OFF button pressed");
+    LOG_INFO("Web Interface: POWER OFF button pressed");
 }
 
 void virtualStartButton() {
     // Legacy start button - simulate turning key to GLOW position then START
     if (g_systemState.keyPosition < 2) {
         g_systemState.keyPosition = 2; // Move to GLOW position first
-        Serial.println("Web Interface: START button pressed - moving to GLOW position");
+        LOG_INFO("Web Interface: START button pressed - moving to GLOW position");
     } else {
         g_systemState.keyStartHeld = true;
         g_systemState.keyPosition = 3;
-        g_systemState.startHoldTime = millis();
-        Serial.println("Web Interface: START button pressed - cranking");
+        g_systemState.startHoldTime = halMillis();
+        LOG_INFO("Web Interface: START button pressed - cranking");
     }
 }
 
 void virtualLightsButton() {
     g_systemState.lightsTogglePressed = true;
-    Serial.println("Web Interface: Lights toggle pressed");
+    LOG_INFO("Web Interface: Lights toggle pressed");
 }
 
 // Note: No virtualStopButton - engine must be stopped manually with lever
 
 // Sensor reading functions with proper calibration
 float readEngineTemp() {
-  int rawValue = analogRead(ENGINE_TEMP_PIN);
+  return convertEngineTemp(halAnalogRead(ENGINE_TEMP_PIN), getCalibration());
+}
+
+float convertEngineTemp(int rawValue, const CalibrationConstants& calibration) {
   // For pull-up configuration with NTC thermistor:
   // Lower ADC = Higher Temperature (sensor gets lower resistance when hot)
   // Formula: Temp = Base_temp - (ADC * scale_factor)
   // This makes lower ADC values produce higher temperatures
-  float instantTemp = 150.0 - (rawValue * runtime_temp_scale);
+  float instantTemp = 150.0 - (rawValue * calibration.tempScale);
   
   // Initialize the filter array if not already done
   if (!tempFilterInitialized) {
@@ -193,21 +254,27 @@ float readOilPressure() {
   // Oil pressure sender P/N 6969775 is a SWITCH, not an analog sender
   // Use readOilPressureSwitch() instead for proper digital switch reading
   
-  Serial.println("WARNING: readOilPressure() is deprecated - use readOilPressureSwitch()");
+  LOG_DEBUG("readOilPressure() is deprecated - use readOilPressureSwitch()");
   
   // Return a safe pressure value based on switch state
   return readOilPressureSwitch() ? 100.0 : 0.0; // 100 kPa if switch indicates OK pressure
 }
 
 float readBatteryVoltage() {
-  int rawValue = analogRead(BATTERY_VOLTAGE_PIN);
-  return rawValue * runtime_battery_divider;
+  return convertBatteryVoltage(halAnalogRead(BATTERY_VOLTAGE_PIN), getCalibration());
+}
+
+float convertBatteryVoltage(int rawValue, const CalibrationConstants& calibration) {
+  return rawValue * calibration.batteryDivider;
 }
 
 float readFuelLevel() {
-  int rawValue = analogRead(FUEL_LEVEL_PIN);
+  return convertFuelLevel(halAnalogRead(FUEL_LEVEL_PIN), getCalibration());
+}
+
+float convertFuelLevel(int rawValue, const CalibrationConstants& calibration) {
   // Convert to percentage (0-100%) using runtime calibration values
-  return map(rawValue, runtime_fuel_empty, runtime_fuel_full, 0, 100);
+  return map(rawValue, calibration.fuelEmpty, calibration.fuelFull, 0, 100);
 }
 
 float readHydraulicPressure() {
@@ -215,7 +282,7 @@ float readHydraulicPressure() {
   // Hydraulic pressure sender P/N 6671062 is a SWITCH, not an analog sender
   // Use readHydraulicPressureSwitch() instead for proper digital switch reading
   
-  Serial.println("WARNING: readHydraulicPressure() is deprecated - use readHydraulicPressureSwitch()");
+  LOG_DEBUG("readHydraulicPressure() is deprecated - use readHydraulicPressureSwitch()");
   
   // Return a safe pressure value based on switch state
   return readHydraulicPressureSwitch() ? 100.0 : 0.0; // 100 kPa if switch indicates OK pressure
@@ -224,7 +291,7 @@ float readHydraulicPressure() {
 // Digital input reading functions
 bool readAlternatorCharge() {
   // Active LOW: 0 = charging, 1 = not charging
-  return digitalRead(ALTERNATOR_CHARGE_PIN) == LOW;
+  return halDigitalRead(ALTERNATOR_CHARGE_PIN) == LOW;
 }
 
 bool readEngineRunFeedback() {
@@ -234,18 +301,18 @@ bool readEngineRunFeedback() {
   return false; // Override: assume engine OFF when no sensors connected
   
   // Original logic (uncomment when sensors are connected):
-  // return digitalRead(ENGINE_RUN_FEEDBACK_PIN) == HIGH;
+  // return halDigitalRead(ENGINE_RUN_FEEDBACK_PIN) == HIGH;
 }
 
 // SAFETY INTERLOCK FUNCTIONS - MANDATORY FOR SAFE OPERATION
 bool readSeatBarSafety() {
   // INPUT_PULLUP: LOW when switch closed (operator seated), HIGH when open (no operator)
-  return digitalRead(SEAT_BAR_PIN) == LOW;
+  return halDigitalRead(SEAT_BAR_PIN) == LOW;
 }
 
 bool readNeutralSafety() {
   // INPUT_PULLUP: LOW when switch closed (transmission in neutral), HIGH when open (in gear)
-  return digitalRead(NEUTRAL_SAFETY_PIN) == LOW;
+  return halDigitalRead(NEUTRAL_SAFETY_PIN) == LOW;
 }
 
 bool safetyInterlocksPassed() {
@@ -254,10 +321,10 @@ bool safetyInterlocksPassed() {
   bool transmissionInNeutral = readNeutralSafety();
   
   if (!seatBarEngaged) {
-    Serial.println("SAFETY VIOLATION: Operator not seated (seat bar not engaged)");
+    LOG_WARN("SAFETY VIOLATION: Operator not seated (seat bar not engaged)");
   }
   if (!transmissionInNeutral) {
-    Serial.println("SAFETY VIOLATION: Transmission not in neutral");
+    LOG_WARN("SAFETY VIOLATION: Transmission not in neutral");
   }
   
   return seatBarEngaged && transmissionInNeutral;
@@ -266,12 +333,12 @@ bool safetyInterlocksPassed() {
 // PRESSURE SWITCH FUNCTIONS (Digital, not analog)
 bool readOilPressureSwitch() {
   // Oil pressure switch: INPUT_PULLUP, LOW when pressure OK, HIGH when low pressure
-  return digitalRead(OIL_PRESSURE_PIN) == LOW; // LOW = OK pressure, HIGH = low pressure
+  return halDigitalRead(OIL_PRESSURE_PIN) == LOW; // LOW = OK pressure, HIGH = low pressure
 }
 
 bool readHydraulicPressureSwitch() {
   // Hydraulic pressure switch: INPUT_PULLUP, LOW when pressure OK, HIGH when low pressure  
-  return digitalRead(HYD_PRESSURE_PIN) == LOW; // LOW = OK pressure, HIGH = low pressure
+  return halDigitalRead(HYD_PRESSURE_PIN) == LOW; // LOW = OK pressure, HIGH = low pressure
 }
 
 // Safety check functions (basic stubs, expand as needed)
@@ -294,42 +361,9 @@ void performSafetyShutdown() {
 
 // ============================================================================
 // POWER MANAGEMENT FUNCTIONS
+// Deep sleep entry/wake-up lives in sleep.cpp (ESP32 only)
 // ============================================================================
 
-void initializeSleepMode() {
-  Serial.println("Initializing deep sleep mode...");
-  
-  // Configure wake-up button
-  pinMode(WAKE_UP_BUTTON_PIN, INPUT_PULLUP);
-  pinMode(SLEEP_ENABLE_PIN, INPUT_PULLUP);
-  
-  // Configure wake-up sources
-  esp_sleep_enable_ext0_wakeup(GPIO_NUM_0, 0); // Wake on button press (LOW)
-  
-  // Initialize sleep-related state
-  g_systemState.lastActivityTime = millis();
-  g_systemState.sleepModeEnabled = true;
-  g_systemState.wakeUpPending = false;
-  g_systemState.sleepTimer = millis();
-  
-  Serial.println("Deep sleep mode initialized - Wake up button: GPIO0");
-}
-
-void enterDeepSleep() {
-  Serial.println("Preparing for deep sleep...");
-  
-  // Prepare system for sleep
-  prepareForSleep();
-  
-  // Print wake-up information
-  Serial.println("Entering deep sleep mode...");
-  Serial.println("Wake up by pressing the BOOT button (GPIO0)");
-  Serial.flush(); // Ensure all serial output is sent
-  
-  // Enter deep sleep
-  esp_deep_sleep_start();
-}
-
 void prepareForSleep() {
   Serial.println("Preparing system for sleep...");
   
@@ -338,9 +372,13 @@ void prepareForSleep() {
   controlGlowPlugs(false);
   controlStarter(false);
   controlLights(false);
+
+  // Edits still waiting for the quiet period would be lost in deep sleep
+  g_settingsManager.flush();
   
-  // Save current state (could save to RTC memory if needed)
-  // For now, we'll just reset to OFF state on wake-up
+  // Snapshot for the next wake (RTC memory), taken before the state is
+  // reset so it records what the controller was doing
+  saveResumeState();
   g_systemState.keyPosition = 0; // OFF
   g_systemState.currentState = OFF;
   
@@ -380,42 +418,12 @@ bool checkSleepConditions(bool manualSleep) {
   }
   
   // For automatic sleep, check if enough time has passed since last activity
-  unsigned long currentTime = millis();
+  unsigned long currentTime = halMillis();
   unsigned long timeSinceActivity = currentTime - g_systemState.lastActivityTime;
   
   return (timeSinceActivity >= ACTIVITY_TIMEOUT);
 }
 
-void handleWakeUp() {
-  Serial.println("=== WAKE UP FROM DEEP SLEEP ===");
-  
-  // Check wake-up reason
-  esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
-  
-  switch(wakeup_reason) {
-    case ESP_SLEEP_WAKEUP_EXT0:
-      Serial.println("Woke up by external signal (button press)");
-      break;
-    case ESP_SLEEP_WAKEUP_TIMER:
-      Serial.println("Woke up by timer");
-      break;
-    default:
-      Serial.println("Woke up for unknown reason");
-      break;
-  }
-  
-  // Reset system state after wake-up
-  g_systemState.keyPosition = 0; // OFF
-  g_systemState.currentState = OFF;
-  g_systemState.wakeUpPending = false;
-  g_systemState.lastActivityTime = millis();
-  
-  // Reinitialize hardware
-  initializePins();
-  
-  Serial.println("System ready after wake-up");
-}
-
 void updateActivityTimer() {
-  g_systemState.lastActivityTime = millis();
+  g_systemState.lastActivityTime = halMillis();
 }
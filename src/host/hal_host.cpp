@@ -0,0 +1,245 @@
+/*
+ * Host HAL Implementation for Bobcat Ignition Controller (env:native only)
+ * Virtual millisecond clock, simulated GPIO/ADC pins and an in-memory NVS
+ */
+
+#include "hal.h"
+#include <map>
+#include <string>
+#include <vector>
+
+HostSerial Serial;
+
+static const uint8_t PIN_COUNT = 64;
+
+static uint32_t virtualMillis = 0;
+static uint8_t pinModes[PIN_COUNT];
+static uint8_t digitalInputs[PIN_COUNT];
+static bool digitalInputSet[PIN_COUNT];
+static uint8_t digitalOutputs[PIN_COUNT];
+static uint16_t analogInputs[PIN_COUNT];
+static uint32_t digitalWrites = 0;
+
+// "namespace/key" -> value bytes
+static std::map<std::string, std::vector<uint8_t> > nvsStore;
+static uint32_t nvsWrites = 0;
+static uint32_t nvsReads = 0;
+
+// ============================================================================
+// CLOCK
+// ============================================================================
+uint32_t halMillis() {
+  return virtualMillis;
+}
+
+uint32_t halMicros() {
+  return virtualMillis * 1000;
+}
+
+void halDelay(uint32_t ms) {
+  virtualMillis += ms;
+}
+
+void halHostSetTime(uint32_t ms) {
+  virtualMillis = ms;
+}
+
+// ============================================================================
+// GPIO / ADC
+// ============================================================================
+void halPinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= PIN_COUNT) {
+    return;
+  }
+  pinModes[pin] = mode;
+  // An unconnected pull-up input reads HIGH until the host drives it
+  if (mode == INPUT_PULLUP && !digitalInputSet[pin]) {
+    digitalInputs[pin] = HAL_HIGH;
+  }
+}
+
+void halDigitalWrite(uint8_t pin, uint8_t level) {
+  if (pin >= PIN_COUNT) {
+    return;
+  }
+  digitalOutputs[pin] = level ? HAL_HIGH : HAL_LOW;
+  digitalWrites++;
+}
+
+int halDigitalRead(uint8_t pin) {
+  if (pin >= PIN_COUNT) {
+    return HAL_LOW;
+  }
+  return pinModes[pin] == OUTPUT ? digitalOutputs[pin] : digitalInputs[pin];
+}
+
+uint16_t halAnalogRead(uint8_t pin) {
+  return pin < PIN_COUNT ? analogInputs[pin] : 0;
+}
+
+void halHostSetDigitalInput(uint8_t pin, uint8_t level) {
+  if (pin < PIN_COUNT) {
+    digitalInputs[pin] = level ? HAL_HIGH : HAL_LOW;
+    digitalInputSet[pin] = true;
+  }
+}
+
+void halHostSetAnalogInput(uint8_t pin, uint16_t value) {
+  if (pin < PIN_COUNT) {
+    analogInputs[pin] = value > 4095 ? 4095 : value;
+  }
+}
+
+uint8_t halHostDigitalOutput(uint8_t pin) {
+  return pin < PIN_COUNT ? digitalOutputs[pin] : HAL_LOW;
+}
+
+uint32_t halHostDigitalWrites() {
+  return digitalWrites;
+}
+
+// ============================================================================
+// CRC32 - reflected 0xEDB88320, one table lookup per byte
+// ============================================================================
+struct Crc32Table {
+  uint32_t entry[256];
+
+  Crc32Table() {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+      }
+      entry[i] = crc;
+    }
+  }
+};
+
+uint32_t halCrc32(uint32_t crc, const void* data, size_t len) {
+  static const Crc32Table table;
+  const uint8_t* bytes = (const uint8_t*)data;
+  crc = ~crc;
+  while (len--) {
+    crc = table.entry[(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+// ============================================================================
+// NVS
+// ============================================================================
+HalNvs::HalNvs() : opened(false), readOnly(true) {
+  ns[0] = '\0';
+}
+
+bool HalNvs::begin(const char* name, bool ro) {
+  strncpy(ns, name, sizeof(ns) - 1);
+  ns[sizeof(ns) - 1] = '\0';
+  opened = true;
+  readOnly = ro;
+  return true;
+}
+
+void HalNvs::end() {
+  opened = false;
+}
+
+static std::string nvsKey(const char* ns, const char* key) {
+  return std::string(ns) + "/" + key;
+}
+
+bool HalNvs::clear() {
+  if (!opened || readOnly) {
+    return false;
+  }
+  std::string prefix = std::string(ns) + "/";
+  for (auto it = nvsStore.begin(); it != nvsStore.end();) {
+    it = it->first.compare(0, prefix.size(), prefix) == 0 ? nvsStore.erase(it) : std::next(it);
+  }
+  nvsWrites++;
+  return true;
+}
+
+bool HalNvs::remove(const char* key) {
+  if (!opened || readOnly) {
+    return false;
+  }
+  nvsWrites++;
+  return nvsStore.erase(nvsKey(ns, key)) > 0;
+}
+
+bool HalNvs::isKey(const char* key) {
+  return opened && nvsStore.count(nvsKey(ns, key)) > 0;
+}
+
+size_t HalNvs::putBytes(const char* key, const void* value, size_t len) {
+  if (!opened || readOnly) {
+    return 0;
+  }
+  const uint8_t* bytes = static_cast<const uint8_t*>(value);
+  nvsStore[nvsKey(ns, key)] = std::vector<uint8_t>(bytes, bytes + len);
+  nvsWrites++;
+  return len;
+}
+
+size_t HalNvs::getBytes(const char* key, void* buf, size_t maxLen) {
+  if (!opened) {
+    return 0;
+  }
+  nvsReads++;
+  auto it = nvsStore.find(nvsKey(ns, key));
+  if (it == nvsStore.end() || it->second.size() > maxLen) {
+    return 0;
+  }
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+size_t HalNvs::getBytesLength(const char* key) {
+  if (!opened) {
+    return 0;
+  }
+  nvsReads++;
+  auto it = nvsStore.find(nvsKey(ns, key));
+  return it == nvsStore.end() ? 0 : it->second.size();
+}
+
+size_t HalNvs::putFloat(const char* key, float value) {
+  return putBytes(key, &value, sizeof(value));
+}
+
+float HalNvs::getFloat(const char* key, float defaultValue) {
+  float value;
+  return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+size_t HalNvs::putInt(const char* key, int32_t value) {
+  return putBytes(key, &value, sizeof(value));
+}
+
+int32_t HalNvs::getInt(const char* key, int32_t defaultValue) {
+  int32_t value;
+  return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+size_t HalNvs::putBool(const char* key, bool value) {
+  uint8_t byte = value ? 1 : 0;
+  return putBytes(key, &byte, 1);
+}
+
+bool HalNvs::getBool(const char* key, bool defaultValue) {
+  uint8_t byte;
+  return getBytes(key, &byte, 1) == 1 ? byte != 0 : defaultValue;
+}
+
+void halHostResetNvs() {
+  nvsStore.clear();
+}
+
+uint32_t halHostNvsWrites() {
+  return nvsWrites;
+}
+
+uint32_t halHostNvsReads() {
+  return nvsReads;
+}
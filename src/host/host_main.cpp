@@ -0,0 +1,1322 @@
+/*
+ * Host Runner for Bobcat Ignition Controller (env:native only)
+ * Runs the unmodified control core against the host HAL: a scripted key
+ * sequence with relay checks, settings round trip and schema, migration from every
+ * stored layout and write coalescing,
+ * a writer/readers stress of the settings and calibration snapshots,
+ * deep sleep resume from the RTC block (and the boot profile kept beside it),
+ * power profile selection and time accounting,
+ * and timings for the control tick, sensor conversion, settings save/load
+ * and JSON responses (JsonWriter against ArduinoJson + string, when
+ * ArduinoJson is present).
+ *
+ * pio run -e native && .pio/build/native/program
+ * .pio/build/native/program sim [cycles] [ambient °C]   plant soak test
+ * .pio/build/native/program record <file>                save a trace of the key sequence
+ * .pio/build/native/program replay <file>                replay a trace (e.g. /api/trace)
+ */
+
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+#include "host_support.h"
+#include "plant_model.h"
+#include "hal.h"
+#include "config.h"
+#include "commands.h"
+#include "control_scheduler.h"
+#include "adc_ingest.h"
+#include "hardware.h"
+#include "ignition_fsm.h"
+#include "sensors.h"
+#include "snapshot_publisher.h"
+#include "settings.h"
+#include "settings_format.h"
+#include "system_state.h"
+#include "trace.h"
+#include "status_bin.h"
+#include "json_writer.h"
+#include "control_actions.h"
+#include "resume_state.h"
+#include "boot_profile.h"
+#include "power_manager.h"
+#include "task_monitor.h"
+#if __has_include(<ArduinoJson.h>)
+#include <ArduinoJson.h>
+#define HOST_HAS_ARDUINOJSON 1
+#endif
+
+// Every heap allocation in the runner goes through here (benchmarks count them)
+static size_t heapAllocations = 0;
+
+void* operator new(size_t size) {
+  heapAllocations++;
+  void* p = malloc(size ? size : 1);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+  if (!condition) {
+    printf("FAIL: %s (state %s, t=%u ms)\n", what,
+           systemStateToString(g_systemState.currentState), (unsigned)halMillis());
+    failures++;
+  }
+}
+
+void hostBoot() {
+  halHostSetTime(0);
+  g_systemState = SystemState_t();
+  g_settingsManager.begin();
+  initializePins();
+
+  // Operator seated, in neutral, engine stopped, 12.6 V battery
+  halHostSetDigitalInput(SEAT_BAR_PIN, HAL_LOW);
+  halHostSetDigitalInput(NEUTRAL_SAFETY_PIN, HAL_LOW);
+  halHostSetDigitalInput(OIL_PRESSURE_PIN, HAL_HIGH);
+  halHostSetDigitalInput(HYD_PRESSURE_PIN, HAL_HIGH);
+  halHostSetAnalogInput(BATTERY_VOLTAGE_PIN, (uint16_t)(12.6f / BATTERY_VOLTAGE_DIVIDER));
+  halHostSetAnalogInput(ENGINE_TEMP_PIN, 2500);
+  halHostSetAnalogInput(FUEL_LEVEL_PIN, 2000);
+
+  startSensorSampling();
+  initializeSleepMode();
+  g_systemState.currentState = OFF;
+  g_systemState.keyPosition = 0;
+}
+
+void hostRun(uint32_t ms, PlantModel* plant) {
+  uint32_t end = halMillis() + ms;
+  while ((int32_t)(end - halMillis()) > 0) {
+    halDelay(SENSOR_SAMPLE_INTERVAL);
+    if (plant) {
+      plant->step(SENSOR_SAMPLE_INTERVAL);
+    }
+    sampleSensors();
+    runControlTick();
+  }
+}
+
+static bool relay(int pin) {
+  return halHostDigitalOutput(pin) == HAL_HIGH;
+}
+
+static void runKeySequence() {
+  hostBoot();
+  expect(g_systemState.currentState == OFF && !relay(MAIN_POWER_PIN), "boots OFF");
+
+  submitCommand(CMD_KEY_POSITION, 1);
+  hostRun(SENSOR_SAMPLE_INTERVAL);
+  expect(g_systemState.currentState == ON && relay(MAIN_POWER_PIN), "key ON energizes main power");
+
+  submitCommand(CMD_KEY_POSITION, 2);
+  hostRun(SENSOR_SAMPLE_INTERVAL);
+  expect(g_systemState.currentState == GLOW_PLUG && relay(GLOW_PLUGS_PIN), "GLOW starts glow plugs");
+
+  hostRun(GLOW_PLUG_DURATION);
+  expect(g_systemState.currentState == ON && !relay(GLOW_PLUGS_PIN), "glow plugs stop after GLOW_PLUG_DURATION");
+
+  submitCommand(CMD_KEY_START_HOLD, 1);
+  hostRun(SENSOR_SAMPLE_INTERVAL);
+  expect(g_systemState.currentState == START && relay(STARTER_PIN), "START hold cranks");
+
+  hostRun(IGNITION_TIMEOUT);
+  expect(!relay(STARTER_PIN), "starter stops after IGNITION_TIMEOUT");
+
+  submitCommand(CMD_KEY_START_HOLD, 0);
+  hostRun(SENSOR_SAMPLE_INTERVAL);
+  expect(g_systemState.currentState == ON && !relay(STARTER_PIN), "START release returns to ON");
+
+  submitCommand(CMD_EMERGENCY_STOP);
+  hostRun(SENSOR_SAMPLE_INTERVAL);
+  expect(g_systemState.currentState == ON && !relay(GLOW_PLUGS_PIN) && !relay(STARTER_PIN), "emergency stop");
+
+  submitCommand(CMD_KEY_POSITION, 0);
+  hostRun(SENSOR_SAMPLE_INTERVAL);
+  expect(g_systemState.currentState == OFF && !relay(MAIN_POWER_PIN) && !relay(LIGHTS_PIN), "key OFF de-energizes");
+}
+
+// Deadlines on the virtual clock, across its wrap, then the control loop's
+// wait: it sleeps to the next deadline unless an input change woke it
+static void runDeadlineScheduler() {
+  DeadlineScheduler timers;
+  halHostSetTime(0xFFFFFF00u);
+  uint32_t start = halMillis();
+  timers.arm(TIMER_GLOW_EXPIRY, start + 500);
+  timers.arm(TIMER_CRANK_TIMEOUT, start + 200);
+  timers.arm(TIMER_SLEEP, start + 300);
+  timers.cancel(TIMER_SLEEP);
+  expect(timers.timeUntilNext(start, 1000) == 200 && timers.timeUntilNext(start, 100) == 100 &&
+         !timers.isArmed(TIMER_SLEEP), "earliest armed deadline, capped at the longest wait");
+
+  halDelay(timers.timeUntilNext(halMillis(), 1000));
+  expect(timers.takeExpired(halMillis()) == 1u << TIMER_CRANK_TIMEOUT && halMillis() == start + 200,
+         "first deadline fires on time");
+  halDelay(timers.timeUntilNext(halMillis(), 1000));
+  expect(timers.takeExpired(halMillis()) == 1u << TIMER_GLOW_EXPIRY && halMillis() == start + 500 && halMillis() < start,
+         "second deadline fires on time across the clock wrap");
+  expect(timers.timeUntilNext(halMillis(), 1000) == 1000 && timers.takeExpired(halMillis()) == 0,
+         "nothing armed: longest wait, nothing expires");
+  timers.arm(TIMER_HOUSEKEEPING, halMillis() - 1);
+  expect(timers.timeUntilNext(halMillis(), 1000) == 0, "overdue deadline is due now");
+
+  hostBoot();
+  scheduleControlDeadlines();
+  waitForNextControlEvent();   // Takes the wake-up of the first sample
+  uint32_t before = halMillis();
+  sampleSensors();
+  scheduleControlDeadlines();
+  waitForNextControlEvent();
+  expect(halMillis() == before + CONTROL_HOUSEKEEPING_INTERVAL, "unchanged inputs: sleeps to housekeeping");
+  before = halMillis();
+  halHostSetDigitalInput(SEAT_BAR_PIN, HAL_HIGH);   // Operator leaves the seat
+  sampleSensors();
+  scheduleControlDeadlines();
+  waitForNextControlEvent();
+  expect(halMillis() == before, "seat bar change wakes the control loop at once");
+}
+
+struct SwitchStep {
+  uint8_t next;
+  uint16_t actions;
+};
+
+// The transition table re-typed as branches and a switch (not the old
+// runIgnitionSequence() switch, which mixed relay I/O and prints into each
+// case): checked against the table entry by entry, then benchmarked
+// against it
+static SwitchStep switchStep(uint8_t state, IgnitionFsm::Event event) {
+  using namespace IgnitionFsm;
+  if (event == EV_KEY_OFF) {
+    return state == OFF ? SwitchStep{OFF, ACT_NONE} : SwitchStep{OFF, ALL_OFF};
+  }
+  if (event == EV_EMERGENCY_STOP) {
+    return state == OFF ? SwitchStep{OFF, ACT_GLOW_OFF | ACT_STARTER_OFF} : SwitchStep{ON, ESTOP};
+  }
+  if (event == EV_GLOW_EXPIRED) {
+    return state == GLOW_PLUG ? SwitchStep{ON, ACT_GLOW_OFF | ACT_KEY_TO_ON} : SwitchStep{state, ACT_GLOW_OFF};
+  }
+  if (event == EV_CRANK_TIMEOUT) {
+    return SwitchStep{state, ACT_STARTER_OFF};
+  }
+
+  bool start = event == EV_KEY_START_TAP || event == EV_KEY_CRANK;
+  switch (state) {
+    case OFF:
+      return SwitchStep{ON, ACT_MAIN_ON};
+    case ON:
+      if (start) {
+        return SwitchStep{START, DIRECT_START};
+      }
+      return event == EV_KEY_GLOW ? SwitchStep{GLOW_PLUG, ACT_GLOW_TIMER_RESUME | ACT_GLOW_ON} : SwitchStep{ON, ACT_NONE};
+    case GLOW_PLUG:
+      if (start) {
+        return SwitchStep{START, CRANK};
+      }
+      return event == EV_KEY_GLOW ? SwitchStep{GLOW_PLUG, ACT_NONE} : SwitchStep{ON, ACT_NONE};
+    case START:
+      return event == EV_KEY_CRANK ? SwitchStep{START, ACT_NONE} : SwitchStep{ON, RELEASE};
+    default:
+      // RUNNING, the alerts and ERROR: only START leaves them
+      return start ? SwitchStep{START, CRANK} : SwitchStep{state, ACT_NONE};
+  }
+}
+
+static void runFsmChecks() {
+  using namespace IgnitionFsm;
+  bool same = true;
+  for (uint8_t state = 0; state < STATE_COUNT; state++) {
+    for (uint8_t event = 0; event < EVENT_COUNT; event++) {
+      SwitchStep expected = switchStep(state, (Event)event);
+      const Transition& transition = step(state, (Event)event);
+      same = same && transition.next == expected.next && transition.actions == expected.actions;
+    }
+  }
+  expect(same, "transition table matches the switch form");
+
+  hostBoot();
+  submitCommand(CMD_EMERGENCY_STOP);
+  hostRun(2 * SENSOR_SAMPLE_INTERVAL);
+  expect(g_systemState.currentState == OFF && !relay(MAIN_POWER_PIN) && !relay(GLOW_PLUGS_PIN) &&
+         !relay(STARTER_PIN), "emergency stop from OFF energizes nothing");
+}
+
+// Commands queued between two ticks are each executed, not merged into
+// the last input they wrote
+static void runCommandEdges() {
+  hostBoot();
+  submitCommand(CMD_KEY_POSITION, 1);
+  hostRun(SENSOR_SAMPLE_INTERVAL);
+
+  uint32_t first = submitCommand(CMD_TOGGLE_LIGHTS);
+  uint32_t second = submitCommand(CMD_TOGGLE_LIGHTS);
+  hostRun(SENSOR_SAMPLE_INTERVAL);
+  expect(!g_systemState.workLightsOn && !relay(LIGHTS_PIN) && getCommandResult(first) == CMD_RESULT_APPLIED &&
+         getCommandResult(second) == CMD_RESULT_APPLIED, "two light toggles in one tick end where they started");
+
+  submitCommand(CMD_KEY_START_HOLD, 1);
+  submitCommand(CMD_KEY_START_HOLD, 0);
+  hostRun(SENSOR_SAMPLE_INTERVAL);
+  expect(g_systemState.ignitionStartTime == halMillis() && !relay(STARTER_PIN) && g_systemState.currentState != START,
+         "start press and release in one tick crank once");
+
+  submitCommand(CMD_KEY_POSITION, 1);
+  hostRun(SENSOR_SAMPLE_INTERVAL);
+  // The direct start above ran a glow cycle that GLOW would only resume
+  g_systemState.glowPlugStartTime = 0;
+  submitCommand(CMD_KEY_POSITION, 2);
+  submitCommand(CMD_KEY_POSITION, 0);
+  hostRun(SENSOR_SAMPLE_INTERVAL);
+  expect(g_systemState.glowPlugStartTime == halMillis() && g_systemState.currentState == OFF && !relay(GLOW_PLUGS_PIN),
+         "key GLOW then OFF in one tick passes through GLOW");
+}
+
+static void noStep() {}
+
+// Sequence numbers follow queue order: a full queue hands out no number,
+// and with two tasks submitting at once the last applied sequence never
+// moves backwards
+static void runCommandSequencing() {
+  hostBoot();
+  uint32_t last = 0;
+  uint32_t sequence;
+  while ((sequence = submitCommand(CMD_TOGGLE_SLEEP_MODE)) != 0) {
+    last = sequence;
+  }
+  processPendingCommands(noStep);
+  expect(submitCommand(CMD_TOGGLE_SLEEP_MODE) == last + 1 && processPendingCommands(noStep) == 1,
+         "a full queue uses up no sequence number");
+
+  const uint32_t PER_PRODUCER = 20000;
+  std::atomic<int> running(2);
+  std::atomic<bool> ordered(true);
+  auto producer = [&]() {
+    uint32_t previous = 0;
+    for (uint32_t i = 0; i < PER_PRODUCER; i++) {
+      uint32_t own;
+      while ((own = submitCommand(CMD_TOGGLE_SLEEP_MODE)) == 0) {
+        std::this_thread::yield();
+      }
+      if (own <= previous) {
+        ordered = false;
+      }
+      previous = own;
+    }
+    running--;
+  };
+  uint32_t start = lastAppliedCommandSequence();
+  bool forward = true;
+  std::thread producerA(producer);
+  std::thread producerB(producer);
+  uint32_t seen = start;
+  uint32_t applied = 0;
+  while (running > 0 || applied < 2 * PER_PRODUCER) {
+    applied += processPendingCommands(noStep);
+    uint32_t now = lastAppliedCommandSequence();
+    forward = forward && now >= seen;
+    seen = now;
+  }
+  producerA.join();
+  producerB.join();
+  expect(ordered && forward && seen == start + 2 * PER_PRODUCER &&
+         getCommandResult(seen) == CMD_RESULT_APPLIED && getCommandResult(seen + 1) == CMD_RESULT_UNKNOWN,
+         "concurrent submissions are applied in sequence order");
+}
+
+static void runSettingsRoundTrip() {
+  halHostResetNvs();
+  SettingsManager writer;
+  writer.begin();
+  BobcatSettings edit = writer.getSettings();
+  expect(setSettingValue(edit, *findSetting("glowDuration", 12), 25) &&
+         setSettingValue(edit, *findSetting("crankingTimeout", 15), 15) && writer.applySettings(edit),
+         "engine settings accepted");
+  expect(writer.saveSettings(), "settings saved");
+
+  SettingsManager reader;
+  reader.begin();
+  expect(reader.getSettings().glowPlugDuration == 25000 && reader.getSettings().crankingTimeout == 15000,
+         "settings reload");
+}
+
+// Names, limits, defaults and JSON all come from BOBCAT_SETTINGS
+static void runSettingsSchema() {
+  bool allFound = true;
+  for (const SettingDescriptor& setting : SETTINGS) {
+    allFound = allFound && findSetting(setting.name, setting.nameLength) == &setting &&
+               findSettingByTag(setting.tag) == &setting;
+  }
+  expect(allFound && findSetting("maxTem", 6) == nullptr && findSetting("bogus", 5) == nullptr,
+         "every setting found by name and tag, nothing else");
+
+  BobcatSettings settings;
+  settingsDefaults(settings);
+  SettingsManager manager;
+  expect(manager.validateSettings(settings) && settings.glowPlugDuration == 20000 && settings.minBatteryVoltage == 11.0f &&
+         strcmp(settings.wifiSSID, "Bobcat-743") == 0, "schema defaults are valid");
+
+  const SettingDescriptor& glow = *findSetting("glowDuration", 12);
+  const SettingDescriptor& password = *findSetting("wifiPassword", 12);
+  expect(!setSettingValue(settings, glow, 61) && !setSettingValue(settings, glow, NAN) && settings.glowPlugDuration == 20000,
+         "out-of-range value rejected");
+  expect(!setSettingText(settings, password, "short") && setSettingText(settings, password, "") &&
+         strcmp(settings.wifiPassword, "bobcat123") == 0, "password length checked, empty keeps it");
+
+  // Home network: empty SSID (access point only) is allowed; full-length
+  // credentials still fit one flash blob
+  BobcatSettings full = settings;
+  const SettingDescriptor& homeSSID = *findSetting("homeSSID", 8);
+  expect(setSettingText(full, homeSSID, "") && full.homeSSID[0] == '\0' && manager.validateSettings(full),
+         "empty home SSID accepted");
+  memset(full.homeSSID, 'S', sizeof(full.homeSSID) - 1);
+  memset(full.homePassword, 'P', sizeof(full.homePassword) - 1);
+  memset(full.wifiSSID, 'A', sizeof(full.wifiSSID) - 1);
+  memset(full.wifiPassword, 'W', sizeof(full.wifiPassword) - 1);
+  uint8_t blob[SETTINGS_BLOB_MAX];
+  BobcatSettings decoded;
+  settingsDefaults(decoded);
+  size_t blobLength = encodeSettings(full, blob, sizeof(blob));
+  expect(blobLength > 0 && decodeSettings(blob, blobLength, decoded) == SETTINGS_DECODED &&
+         memcmp(decoded.homePassword, full.homePassword, sizeof(full.homePassword)) == 0,
+         "full-length WiFi credentials round-trip through flash");
+
+  uint8_t octets[4];
+  const SettingDescriptor& staticIP = *findSetting("homeStaticIP", 12);
+  BobcatSettings network = settings;
+  expect(parseIPv4("192.168.1.50", octets) && octets[0] == 192 && octets[3] == 50 && !parseIPv4("192.168.1", octets) &&
+         !parseIPv4("192.168.1.256", octets) && !parseIPv4("1.2.3.4 ", octets) && !parseIPv4("1..2.3", octets),
+         "IPv4 settings parsed strictly");
+  expect(!setSettingText(network, staticIP, "192.168.1") && setSettingText(network, staticIP, "192.168.1.50") &&
+         !manager.validateSettings(network) && setSettingText(network, *findSetting("homeGateway", 11), "192.168.1.1") &&
+         manager.validateSettings(network), "static IP needs a gateway");
+
+  char body[512];
+  JsonBufferSink sink(body, sizeof(body));
+  JsonWriter<JsonBufferSink> json(sink);
+  json.beginObject();
+  for (const SettingDescriptor& setting : SETTINGS) {
+    if (setting.flags & SETTING_READ) {
+      writeSettingJson(json, setting, settings);
+    }
+  }
+  json.endObject();
+  expect(strstr(body, "\"glowDuration\":20,") != nullptr && strstr(body, "\"minVoltage\":11.00,") != nullptr &&
+         strstr(body, "\"pressureScale\":0.1682,") != nullptr && strstr(body, "bobcat123") == nullptr &&
+         strstr(body, "fuelLevelEmpty") == nullptr, "GET /api/settings body from the schema");
+}
+
+// A v1 blob as the firmware before the tagged format wrote it
+static BobcatSettingsV1 settingsV1() {
+  BobcatSettingsV1 v1;
+  memset(&v1, 0, sizeof(v1));
+  v1.glowPlugDuration = 25000;
+  v1.crankingTimeout = 12000;
+  v1.cooldownDuration = 90000;
+  v1.maxCoolantTemp = 98;
+  v1.minOilPressure = 75;
+  v1.minHydPressure = 400;
+  v1.minBatteryVoltage = 11.5f;
+  v1.maxBatteryVoltage = 14.8f;
+  strcpy(v1.wifiSSID, "Shop-AP");
+  strcpy(v1.wifiPassword, "tractor-pass");
+  v1.pressureScale = 0.2f;
+  v1.hydPressureScale = 0.5f;
+  v1.fuelLevelEmpty = 310;
+  v1.fuelLevelFull = 3650;
+  v1.fuelLevelLowThreshold = 20;
+  v1.settingsVersion = 1;
+  v1.checksum = settingsChecksumV1(v1);
+  return v1;
+}
+
+static void storeSettingsBlob(const void* blob, size_t length) {
+  HalNvs nvs;
+  nvs.begin("bobcat", false);
+  nvs.putBytes("settings", blob, length);
+  nvs.end();
+}
+
+// Every layout ever stored loads with its values; damaged blobs fall back
+// to the defaults instead of loading garbage
+static void runSettingsMigration() {
+  expect(halCrc32(0, "123456789", 9) == 0xCBF43926, "CRC32 check value");
+
+  halHostResetNvs();
+  BobcatSettingsV1 v1 = settingsV1();
+  storeSettingsBlob(&v1, sizeof(v1));
+  SettingsManager migrated;
+  migrated.begin();
+  BobcatSettings settings = migrated.getSettings();
+  expect(settings.glowPlugDuration == 25000 && settings.minHydPressure == 400 && settings.fuelLevelFull == 3650 &&
+         settings.hydPressureScale == 0.5f && strcmp(settings.wifiSSID, "Shop-AP") == 0 &&
+         strcmp(settings.wifiPassword, "tractor-pass") == 0, "v1 settings migrated");
+
+  HalNvs nvs;
+  nvs.begin("bobcat", true);
+  uint8_t blob[SETTINGS_BLOB_MAX];
+  size_t length = nvs.getBytes("settings", blob, sizeof(blob));
+  nvs.end();
+  BobcatSettings reloaded = settings;
+  expect(decodeSettings(blob, length, reloaded) == SETTINGS_DECODED && memcmp(&reloaded, &settings, sizeof(settings)) == 0,
+         "migrated settings written back in the tagged format");
+
+  // Records this firmware does not know are skipped; missing ones keep the default
+  uint8_t sparse[SETTINGS_BLOB_MAX];
+  size_t used = sizeof(SettingsBlobHeader);
+  const uint8_t records[] = { 62, 3, 1, 2, 3, findSetting("maxTemp", 7)->tag, 2, 110, 0 };
+  memcpy(sparse + used, records, sizeof(records));
+  used += sizeof(records);
+  SettingsBlobHeader header = { SETTINGS_FORMAT_MAGIC, SETTINGS_FORMAT_VERSION, (uint16_t)sizeof(records),
+                                halCrc32(0, records, sizeof(records)) };
+  memcpy(sparse, &header, sizeof(header));
+  BobcatSettings partial = settings;
+  partial.maxCoolantTemp = 104;
+  expect(decodeSettings(sparse, used, partial) == SETTINGS_DECODED && partial.maxCoolantTemp == 110 &&
+         partial.glowPlugDuration == 25000, "unknown tags skipped, missing tags keep their value");
+
+  blob[length - 1] ^= 0x01;
+  expect(decodeSettings(blob, length, reloaded) == SETTINGS_CORRUPT, "CRC32 catches a flipped bit");
+  v1.checksum ^= 1;
+  BobcatSettings damaged = settings;
+  expect(decodeSettings((const uint8_t*)&v1, sizeof(v1), damaged) == SETTINGS_CORRUPT, "v1 checksum still checked");
+  header.version = SETTINGS_FORMAT_VERSION + 1;
+  memcpy(sparse, &header, sizeof(header));
+  expect(decodeSettings(sparse, used, damaged) == SETTINGS_UNKNOWN, "newer format not misread");
+
+  halHostResetNvs();
+  storeSettingsBlob(blob, length);
+  SettingsManager fallback;
+  fallback.begin();
+  expect(fallback.getSettings().glowPlugDuration == 20000, "corrupt blob falls back to defaults");
+}
+
+// Eleven edits in a burst reach flash as one write, and a batch with one
+// bad value changes nothing
+static void runSettingsCoalescing() {
+  halHostResetNvs();
+  SettingsManager manager;
+  manager.begin();
+  uint32_t writesBefore = halHostNvsWrites();
+  uint32_t commitsBefore = manager.getFlashStats().settingsCommits;
+
+  BobcatSettings edit = manager.getSettings();
+  for (int i = 0; i < 11; i++) {
+    edit.maxCoolantTemp = 90 + i;
+    expect(manager.applySettings(edit), "settings batch accepted");
+    halDelay(100);
+  }
+  expect(!manager.commitIfQuiet(halMillis()) && halHostNvsWrites() == writesBefore,
+         "no flash write during a burst of edits");
+  halDelay(SETTINGS_COMMIT_DELAY);
+  expect(manager.commitIfQuiet(halMillis()) && halHostNvsWrites() == writesBefore + 1 && !manager.isDirty(),
+         "one flash write after the quiet period");
+  expect(manager.getFlashStats().coalescedChanges == 10, "coalesced edits counted");
+  manager.recordCalibrationWrites(3);
+  const FlashWriteStats stats = manager.getFlashStats();
+  expect(stats.calibrationWrites == 3 && stats.settingsCommits == commitsBefore + 1 && stats.maxCommitUs >= stats.lastCommitUs,
+         "flash counters read as one copy");
+
+  BobcatSettings bad = manager.getSettings();
+  bad.glowPlugDuration = 30000;
+  bad.maxBatteryVoltage = 5.0f;
+  expect(!manager.applySettings(bad) && manager.getSettings().glowPlugDuration != 30000 && !manager.isDirty(),
+         "invalid batch leaves settings untouched");
+
+  SettingsManager reader;
+  reader.begin();
+  expect(reader.getSettings().maxCoolantTemp == 100, "coalesced settings reload");
+}
+
+// Settings and calibration sets whose fields are derived from one number,
+// so a reader can tell a torn copy from a whole one
+static void stressSettings(BobcatSettings& settings, uint32_t k) {
+  uint32_t g = 5 + k % 50;
+  settings.glowPlugDuration = g * 1000;
+  settings.crankingTimeout = (5 + g % 26) * 1000;
+  settings.maxCoolantTemp = 80 + g % 40;
+  settings.fuelLevelLowThreshold = g;
+}
+
+static bool settingsWhole(const BobcatSettings& settings) {
+  uint32_t g = settings.glowPlugDuration / 1000;
+  return settings.crankingTimeout == (5 + g % 26) * 1000 && settings.maxCoolantTemp == (int16_t)(80 + g % 40) &&
+         settings.fuelLevelLowThreshold == g;
+}
+
+static CalibrationConstants stressCalibration(uint32_t k) {
+  return CalibrationConstants{ k * 0.5f, (float)(k + 1), 0.1682f, 0.1682f, (int)k, (int)k + 1000 };
+}
+
+static bool calibrationWhole(const CalibrationConstants& c) {
+  return c.fuelFull - c.fuelEmpty == 1000 && c.batteryDivider == c.fuelEmpty * 0.5f &&
+         c.tempScale == (float)(c.fuelEmpty + 1);
+}
+
+// Deep sleep and wake: settings, calibration, the coolant filter, work
+// lights and counters come back from the resume block without NVS reads
+static void runResumeState() {
+  hostBoot();
+  startBootProfile(false);
+  BobcatSettings edit = g_settingsManager.getSettings();
+  edit.maxCoolantTemp = 99;
+  expect(g_settingsManager.applySettings(edit), "settings edit before sleep");
+  CalibrationConstants calibration = getCalibration();
+  calibration.fuelFull = 3700;
+  publishCalibration(calibration);
+  submitCommand(CMD_TOGGLE_LIGHTS, 0);
+  hostRun(20 * SENSOR_SAMPLE_INTERVAL);
+  expect(g_systemState.workLightsOn, "work lights on before sleep");
+  const TempFilterState filter = getTempFilter();
+  const FlashWriteStats flash = g_settingsManager.getFlashStats();
+
+  enterDeepSleep();   // Flushes the edit, saves the block
+  uint32_t nvsReads = halHostNvsReads();
+
+  // What a wake starts from: nothing in RAM
+  g_systemState = SystemState_t();
+  g_settingsManager.restore(BobcatSettings(), FlashWriteStats());
+  publishCalibration(CalibrationConstants());
+  restoreTempFilter(TempFilterState());
+
+  startBootProfile(true);
+  handleWakeUp();
+  BootProfile before;
+  expect(previousBootProfile(before) && !before.wake && currentBootProfile().wake &&
+         currentBootProfile().bootCount == before.bootCount + 1,
+         "boot profile of the boot before the wake kept");
+  TempFilterState restored = getTempFilter();
+  expect(lastResumeResult() == RESUME_RESTORED && deepSleepCycles() == 1 && lastSleepState() == OFF,
+         "resume block restored on wake");
+  expect(g_settingsManager.getSettings().maxCoolantTemp == 99 && getCalibration().fuelFull == 3700 &&
+         memcmp(restored.readings, filter.readings, sizeof(filter.readings)) == 0 && restored.index == filter.index &&
+         restored.initialized && g_systemState.workLightsOn &&
+         g_settingsManager.getFlashStats().settingsCommits == flash.settingsCommits + 1,
+         "settings, calibration, filter, lights and counters survive deep sleep");
+  expect(halHostNvsReads() == nvsReads, "wake reads nothing from NVS");
+  expect(restoreResumeState() == RESUME_NONE, "resume block used once");
+}
+
+// One writer (the web server task's role) republishes while two readers
+// (the control and sampling tasks' role) copy; no copy may be torn and
+// generations never go backwards
+static void runSnapshotStress() {
+  const uint32_t WRITES = 100000;
+  halHostResetNvs();
+  SettingsManager manager;
+  manager.begin();
+  uint32_t settingsStart = manager.generation();
+  uint32_t calibrationStart = calibrationGeneration();
+
+  std::atomic<bool> done(false);
+  std::atomic<uint32_t> torn(0);
+  std::atomic<uint32_t> reads(0);
+  std::atomic<uint32_t> backwards(0);
+
+  auto reader = [&]() {
+    uint32_t lastSettings = 0;
+    uint32_t lastCalibration = 0;
+    while (!done.load(std::memory_order_acquire)) {
+      uint32_t settingsGeneration = manager.generation();
+      uint32_t generation = calibrationGeneration();
+      if (!settingsWhole(manager.getSettings()) || !calibrationWhole(getCalibration())) {
+        torn++;
+      }
+      if (settingsGeneration < lastSettings || generation < lastCalibration) {
+        backwards++;
+      }
+      lastSettings = settingsGeneration;
+      lastCalibration = generation;
+      reads++;
+    }
+  };
+
+  BobcatSettings first = manager.getSettings();
+  stressSettings(first, 0);
+  manager.applySettings(first);
+  publishCalibration(stressCalibration(0));
+
+  std::thread readerA(reader);
+  std::thread readerB(reader);
+  std::thread writer([&]() {
+    BobcatSettings settings = manager.getSettings();
+    for (uint32_t k = 1; k <= WRITES; k++) {
+      stressSettings(settings, k);
+      manager.applySettings(settings);
+      publishCalibration(stressCalibration(k));
+    }
+    done.store(true, std::memory_order_release);
+  });
+  writer.join();
+  readerA.join();
+  readerB.join();
+
+  expect(torn == 0 && backwards == 0 && reads > 0, "no torn or stale snapshot under a concurrent writer");
+  expect(manager.generation() == settingsStart + WRITES + 1 && calibrationGeneration() == calibrationStart + WRITES + 1,
+         "every settings and calibration change published");
+  loadCalibrationConstants();
+}
+
+// Every field derives from k, so a reader can tell a torn copy
+static SensorSnapshot stressSnapshot(uint32_t k) {
+  SensorSnapshot snapshot = {};
+  snapshot.sequence = k;
+  snapshot.timestampMs = k * 50;
+  snapshot.batteryRaw = k & 0x0FFF;
+  snapshot.temperatureRaw = (k >> 1) & 0x0FFF;
+  snapshot.pressureRaw = (k >> 2) & 0x0FFF;
+  snapshot.fuelRaw = (k >> 3) & 0x0FFF;
+  snapshot.hydraulicRaw = (k >> 4) & 0x0FFF;
+  snapshot.batteryVoltage = (float)(k % 1000);
+  snapshot.engineTemp = (float)(k % 997);
+  snapshot.fuelLevel = (float)(k % 991);
+  snapshot.oilPressureOk = k & 1;
+  snapshot.hydPressureOk = k & 2;
+  snapshot.alternatorCharging = k & 4;
+  snapshot.engineRunning = k & 8;
+  snapshot.seatBarEngaged = k & 16;
+  snapshot.inNeutral = k & 32;
+  return snapshot;
+}
+
+static bool snapshotWhole(const SensorSnapshot& snapshot) {
+  SensorSnapshot expected = stressSnapshot(snapshot.sequence);
+  return memcmp(&snapshot, &expected, sizeof(expected)) == 0;
+}
+
+// The sampling task (writer) against the control task and a web handler
+// (readers), then a writer stopped in the middle of a publication - on the
+// ESP32 the control task preempts the sampler on the same core - which
+// must not hold the readers up
+static void runSensorSnapshotStress() {
+  const uint32_t WRITES = 100000;
+  publishSensorSnapshot(stressSnapshot(1));
+
+  std::atomic<bool> done(false);
+  std::atomic<uint32_t> torn(0);
+  std::atomic<uint32_t> reads(0);
+  std::atomic<uint32_t> backwards(0);
+
+  auto reader = [&]() {
+    uint32_t last = 0;
+    while (!done.load(std::memory_order_acquire)) {
+      SensorSnapshot snapshot = getSensorSnapshot();
+      if (!snapshotWhole(snapshot)) {
+        torn++;
+      }
+      if (snapshot.sequence < last) {
+        backwards++;
+      }
+      last = snapshot.sequence;
+      reads++;
+    }
+  };
+
+  std::thread readerA(reader);
+  std::thread readerB(reader);
+  std::thread writer([&]() {
+    for (uint32_t k = 2; k <= WRITES; k++) {
+      publishSensorSnapshot(stressSnapshot(k));
+    }
+    done.store(true, std::memory_order_release);
+  });
+  writer.join();
+  readerA.join();
+  readerB.join();
+  expect(torn == 0 && backwards == 0 && reads > 0, "no torn or stale sensor snapshot under a concurrent writer");
+  expect(getSensorSnapshot().sequence == WRITES, "last sensor sample published");
+
+  SnapshotPublisher<SensorSnapshot> publisher;
+  publisher.publish(stressSnapshot(7));
+  std::atomic<int> phase(0);   // 1 = writer stopped mid-copy, 2 = let it finish
+  std::atomic<uint32_t> stalledReads(0);
+  std::atomic<bool> stalledTorn(false);
+  std::thread stoppedWriter([&]() {
+    SensorSnapshot next = stressSnapshot(8);
+    SensorSnapshot& slot = publisher.beginPublish();
+    memcpy(&slot, &next, sizeof(next) / 2);
+    phase.store(1, std::memory_order_release);
+    while (phase.load(std::memory_order_acquire) != 2) {
+      std::this_thread::yield();
+    }
+    memcpy((uint8_t*)&slot + sizeof(next) / 2, (const uint8_t*)&next + sizeof(next) / 2,
+           sizeof(next) - sizeof(next) / 2);
+    publisher.endPublish();
+  });
+  auto stalledReader = [&]() {
+    for (int i = 0; i < 10000; i++) {
+      SensorSnapshot snapshot = publisher.read();   // Would spin forever on a plain sequence lock
+      if (snapshot.sequence != 7 || !snapshotWhole(snapshot)) {
+        stalledTorn = true;
+      }
+      stalledReads++;
+    }
+  };
+  while (phase.load(std::memory_order_acquire) != 1) {
+    std::this_thread::yield();
+  }
+  std::thread stalledA(stalledReader);
+  std::thread stalledB(stalledReader);
+  stalledA.join();
+  stalledB.join();
+  phase.store(2, std::memory_order_release);
+  stoppedWriter.join();
+  expect(stalledReads == 20000 && !stalledTorn, "readers get the last whole sample while the writer is stopped");
+  expect(publisher.read().sequence == 8 && snapshotWhole(publisher.read()) && publisher.generation() == 2,
+         "stopped writer's sample published once it finishes");
+
+  sampleSensors();   // Back to the simulated inputs for the runners after this one
+}
+
+// ADC1 channels of the inputs on the board (GPIO36, 39, 34, 35, 33)
+static const int8_t ADC_TEST_CHANNELS[ADC_CHANNEL_COUNT] = { 0, 3, 6, 7, 5 };
+
+static size_t appendConversion(uint8_t* frame, size_t length, uint8_t channel, uint16_t value) {
+  uint16_t word = (uint16_t)(channel << 12) | (value & 0x0FFF);
+  frame[length] = word & 0xFF;
+  frame[length + 1] = word >> 8;
+  return length + 2;
+}
+
+// A fake ADC1 source: DMA frames interleaving every input plus an unused
+// channel, as the driver delivers them; then one ring's overrun and
+// decimation, and readers racing a producer that laps them
+static void runAdcIngest() {
+  const uint32_t ROUNDS = 100;
+  adcSetChannelMap(ADC_TEST_CHANNELS);
+  uint32_t dropped = adcDmaSamplesDropped();
+  uint32_t counts[ADC_CHANNEL_COUNT];
+  for (uint8_t i = 0; i < ADC_CHANNEL_COUNT; i++) {
+    counts[i] = adcRing((AdcChannelId)i).count();
+  }
+
+  static uint8_t frame[ADC_DMA_RESULT_BYTES * (ADC_CHANNEL_COUNT + 1) * ROUNDS];
+  size_t length = 0;
+  for (uint32_t r = 0; r < ROUNDS; r++) {
+    for (uint8_t i = 0; i < ADC_CHANNEL_COUNT; i++) {
+      length = appendConversion(frame, length, ADC_TEST_CHANNELS[i], i * 800 + r);
+    }
+    length = appendConversion(frame, length, 1, 4095);   // Not one of ours
+  }
+  expect(adcDmaIngestFrame(frame, length) == (ADC_CHANNEL_COUNT + 1) * ROUNDS &&
+         adcDmaSamplesDropped() == dropped + ROUNDS, "frame decoded, unused channel dropped");
+
+  bool routed = true;
+  for (uint8_t i = 0; i < ADC_CHANNEL_COUNT; i++) {
+    uint16_t latest[4];
+    const AdcChannelRing& ring = adcRing((AdcChannelId)i);
+    routed = routed && ring.count() == counts[i] + ROUNDS && ring.window(latest, 4) == 4 &&
+             latest[0] == i * 800 + ROUNDS - 4 && latest[3] == i * 800 + ROUNDS - 1;
+  }
+  expect(routed, "conversions routed to their channel's ring in order");
+  expect(adcAverage(ADC_CH_FUEL_LEVEL, ROUNDS) == 2450, "channel mean of the last conversions");
+
+  AdcRing<16> ring;
+  for (uint16_t v = 0; v < 40; v++) {
+    ring.push(v);
+  }
+  uint16_t out[32];
+  size_t n = ring.window(out, 32);
+  expect(ring.count() == 40 && n == 15 && out[0] == 25 && out[14] == 39, "overrun keeps the newest N - 1 samples");
+  expect(ring.average(4) == 38 && ring.average(100) == 32, "mean over the newest samples");
+  n = ring.decimate(out, 10, 4);
+  expect(n == 3 && out[0] == 30 && out[1] == 34 && out[2] == 38, "boxcar decimation of the newest samples");
+
+  const uint32_t PUSHES = 2000000;
+  AdcRing<256> shared;
+  std::atomic<bool> done(false);
+  std::atomic<uint32_t> torn(0);
+  std::atomic<uint32_t> reads(0);
+  auto reader = [&]() {
+    uint16_t window[64];
+    while (!done.load(std::memory_order_acquire)) {
+      size_t count = shared.window(window, 64);
+      for (size_t i = 1; i < count; i++) {
+        if (window[i] != ((window[i - 1] + 1) & 0x0FFF)) {
+          torn++;
+          break;
+        }
+      }
+      reads++;
+    }
+  };
+  std::thread readerA(reader);
+  std::thread readerB(reader);
+  for (uint32_t i = 0; i < PUSHES; i++) {
+    shared.push(i & 0x0FFF);
+  }
+  done.store(true, std::memory_order_release);
+  readerA.join();
+  readerB.join();
+  expect(torn == 0 && reads > 0 && shared.count() == PUSHES, "no torn window while the producer laps the ring");
+}
+
+static void runStatusBinRoundTrip() {
+  StatusBin in = {};
+  in.flags = STATUS_BIN_MAIN_POWER | STATUS_BIN_OIL_PRESSURE_OK;
+  in.generation = 0x01020304;
+  in.state = RUNNING;
+  in.engineTempDeci = -123;
+  in.batteryMillivolts = 13850;
+  in.fuelCentiPercent = 7450;
+  in.apIp[0] = 192; in.apIp[1] = 168; in.apIp[2] = 4; in.apIp[3] = 1;
+  in.uptimeMs = 0xDEADBEEF;
+
+  uint8_t record[STATUS_BIN_SIZE];
+  encodeStatusBin(in, record);
+  StatusBin out;
+  expect(decodeStatusBin(record, sizeof(record), out), "status.bin decodes");
+  expect(out.flags == in.flags && out.generation == in.generation && out.state == in.state &&
+         out.engineTempDeci == in.engineTempDeci && out.batteryMillivolts == in.batteryMillivolts &&
+         out.fuelCentiPercent == in.fuelCentiPercent && out.apIp[3] == 1 && out.uptimeMs == in.uptimeMs,
+         "status.bin round trip");
+  expect(!decodeStatusBin(record, sizeof(record) - 1, out), "status.bin rejects a short record");
+}
+
+// Idle while parked, full clock for the engine states and for a client;
+// the estimate is weighted by the time spent in each
+static void runPowerProfiles() {
+  expect(selectPowerProfile(OFF, false) == POWER_IDLE && selectPowerProfile(ON, false) == POWER_IDLE &&
+         selectPowerProfile(ON, true) == POWER_CLIENT && selectPowerProfile(START, true) == POWER_ENGINE &&
+         selectPowerProfile(GLOW_PLUG, false) == POWER_ENGINE && selectPowerProfile(ERROR, false) == POWER_ENGINE,
+         "power profile per state");
+
+  halHostSetTime(1000);
+  updatePowerProfile(OFF, false);
+  halHostSetTime(4000);
+  updatePowerProfile(GLOW_PLUG, false);
+  halHostSetTime(5000);
+  updatePowerProfile(RUNNING, false);   // Same profile: no transition
+  halHostSetTime(6000);
+  updatePowerProfile(OFF, false);
+  halHostSetTime(10000);
+  PowerStats power = getPowerStats();
+  expect(power.profile == POWER_IDLE && power.transitions == 2 && power.profileMs[POWER_IDLE] == 7000 &&
+         power.profileMs[POWER_ENGINE] == 2000 && power.profileMs[POWER_CLIENT] == 0,
+         "time accounted per power profile");
+  float expected = (7000 * POWER_IDLE_CURRENT_MA + 2000 * POWER_ENGINE_CURRENT_MA) / 9000;
+  float estimate = estimatedAverageCurrentMa(power);
+  expect(estimate > expected - 0.01f && estimate < expected + 0.01f, "average current weighted by profile time");
+}
+
+static void runTaskMonitor() {
+  waitForNextControlEvent();   // Whatever the earlier runners left due
+  resetTaskMonitor();
+  uint32_t start = halMillis();
+  for (int i = 0; i < 3; i++) {
+    halHostSetTime(halMillis() + 5);   // A 5 ms pass before each wait
+    waitForNextControlEvent();
+  }
+  ControlTimingStats control = getControlTimingStats();
+  expect(control.passes == 3 && control.passMaxUs == 5000 && control.passTotalUs == 15000,
+         "control passes timed from wake-up to the next wait");
+  expect(control.deadlineWakes >= 2 && control.lateMaxUs == 0, "deadline wake-ups on time");
+  expect(taskMonitorWindowMs() == halMillis() - start, "measurement window starts at the reset");
+
+  noteTaskBusy(TASK_SENSORS, taskMonitorWindowMs() * 100);   // 10% of the window
+  float sensors = taskCpuPercent(TASK_SENSORS);
+  float controlCpu = taskCpuPercent(TASK_CONTROL);
+  float expectedControl = 15000.0f / (taskMonitorWindowMs() * 10.0f);
+  expect(sensors > 9.99f && sensors < 10.01f && controlCpu > expectedControl - 0.01f &&
+         controlCpu < expectedControl + 0.01f && taskCpuPercent(TASK_SETTINGS) < 0.0f,
+         "task CPU share of the window");
+  resetTaskMonitor();
+  expect(getControlTimingStats().passes == 0 && taskBusyUs(TASK_SENSORS) == 0, "task monitor reset");
+}
+
+static bool parseControl(const char* body, ControlActions::Request& request) {
+  return ControlActions::parse(body, strlen(body), request);
+}
+
+static void runControlActionChecks() {
+  using namespace ControlActions;
+  for (uint8_t i = 0; i < ACTION_COUNT; i++) {
+    expect(find(ACTIONS[i].name, ACTIONS[i].length) == &ACTIONS[i], "control action found by name");
+  }
+  expect(find("light", 5) == nullptr && find("lightz", 6) == nullptr && find("", 0) == nullptr,
+         "unknown control actions rejected");
+
+  Request request;
+  expect(parseControl("{\"action\":\"key_position\",\"position\":2}", request) &&
+         find(request.action, request.actionLength)->command == CMD_KEY_POSITION && request.position == 2,
+         "control body with position");
+  expect(parseControl(" { \"held\" : true , \"action\" : \"key_start_hold\", \"ts\": 17 }\r\n", request) &&
+         find(request.action, request.actionLength)->command == CMD_KEY_START_HOLD && request.held,
+         "control body with spacing and unknown keys");
+  expect(parseControl("{\"action\":\"key_position\",\"position\":\"2\"}", request) && request.position == -1,
+         "quoted position is invalid");
+  expect(!parseControl("{\"action\":\"lights\"", request) && !parseControl("[\"lights\"]", request) &&
+         !parseControl("{\"action\":lights}", request) && !parseControl("{\"action\":\"x\",\"o\":{}}", request),
+         "malformed control bodies rejected");
+}
+
+template <typename F>
+static double nsPerCall(uint32_t iterations, F body) {
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < iterations; i++) {
+    body(i);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+// The /api/raw-sensors document: 33 fields of ints, fixed-point floats and strings
+struct RawSensorSample {
+  int raw[5];
+  float divider, scale, pressureScale, calculated[5];
+  unsigned long ageMs;
+};
+
+static void writeRawSensors(JsonWriter<JsonBufferSink>& json, const RawSensorSample& s) {
+  json.beginObject();
+  json.field(JSON_KEY("battery_raw"), s.raw[0]);
+  json.field(JSON_KEY("temperature_raw"), s.raw[1]);
+  json.field(JSON_KEY("pressure_raw"), s.raw[2]);
+  json.field(JSON_KEY("fuel_raw"), s.raw[3]);
+  json.field(JSON_KEY("hydraulic_raw"), s.raw[4]);
+  json.field(JSON_KEY("battery_status"), s.raw[0] > 100 ? "OK" : "CHECK");
+  json.field(JSON_KEY("temperature_status"), s.raw[1] > 10 ? "OK" : "CHECK");
+  json.field(JSON_KEY("pressure_status"), s.raw[2] < 4000 ? "OK" : "BROKEN");
+  json.field(JSON_KEY("hydraulic_status"), s.raw[4] < 4000 ? "OK" : "BROKEN");
+  json.field(JSON_KEY("fuel_status"), s.raw[3] > 10 ? "OK" : "CHECK");
+  json.field(JSON_KEY("pressure_diagnostic"), "Normal operation");
+  json.field(JSON_KEY("battery_divider"), s.divider, 6);
+  json.field(JSON_KEY("temp_offset"), -40.0);
+  json.field(JSON_KEY("temp_scale"), s.scale, 6);
+  json.field(JSON_KEY("pressure_offset"), 0.0);
+  json.field(JSON_KEY("pressure_scale"), s.pressureScale, 6);
+  json.field(JSON_KEY("hyd_pressure_scale"), s.pressureScale, 6);
+  json.field(JSON_KEY("fuel_empty"), 200);
+  json.field(JSON_KEY("fuel_full"), 3800);
+  json.field(JSON_KEY("battery_calculated"), s.calculated[0]);
+  json.field(JSON_KEY("temperature_calculated"), s.calculated[1]);
+  json.field(JSON_KEY("pressure_calculated"), s.calculated[2]);
+  json.field(JSON_KEY("fuel_calculated"), s.calculated[3]);
+  json.field(JSON_KEY("hydraulic_calculated"), s.calculated[4]);
+  json.field(JSON_KEY("sample_age_ms"), s.ageMs);
+  json.field(JSON_KEY("adc_dma_running"), true);
+  json.field(JSON_KEY("adc_dma_frames"), 123456u);
+  json.field(JSON_KEY("log_records_dropped"), 0u);
+  json.field(JSON_KEY("trace_records_dropped"), 0u);
+  json.endObject();
+}
+
+#ifdef HOST_HAS_ARDUINOJSON
+// What the handlers did before: fill a document, serialize into a growing
+// string, then the response copies it again
+static size_t writeRawSensorsArduinoJson(const RawSensorSample& s) {
+  StaticJsonDocument<768> doc;
+  doc["battery_raw"] = s.raw[0];
+  doc["temperature_raw"] = s.raw[1];
+  doc["pressure_raw"] = s.raw[2];
+  doc["fuel_raw"] = s.raw[3];
+  doc["hydraulic_raw"] = s.raw[4];
+  doc["battery_status"] = s.raw[0] > 100 ? "OK" : "CHECK";
+  doc["temperature_status"] = s.raw[1] > 10 ? "OK" : "CHECK";
+  doc["pressure_status"] = s.raw[2] < 4000 ? "OK" : "BROKEN";
+  doc["hydraulic_status"] = s.raw[4] < 4000 ? "OK" : "BROKEN";
+  doc["fuel_status"] = s.raw[3] > 10 ? "OK" : "CHECK";
+  doc["pressure_diagnostic"] = "Normal operation";
+  doc["battery_divider"] = s.divider;
+  doc["temp_offset"] = -40.0;
+  doc["temp_scale"] = s.scale;
+  doc["pressure_offset"] = 0.0;
+  doc["pressure_scale"] = s.pressureScale;
+  doc["hyd_pressure_scale"] = s.pressureScale;
+  doc["fuel_empty"] = 200;
+  doc["fuel_full"] = 3800;
+  doc["battery_calculated"] = s.calculated[0];
+  doc["temperature_calculated"] = s.calculated[1];
+  doc["pressure_calculated"] = s.calculated[2];
+  doc["fuel_calculated"] = s.calculated[3];
+  doc["hydraulic_calculated"] = s.calculated[4];
+  doc["sample_age_ms"] = s.ageMs;
+  doc["adc_dma_running"] = true;
+  doc["adc_dma_frames"] = 123456u;
+  doc["log_records_dropped"] = 0u;
+  doc["trace_records_dropped"] = 0u;
+  std::string body;
+  serializeJson(doc, body);
+  std::string response(body);
+  return response.size();
+}
+#endif
+
+static void runJsonBenchmark() {
+  const uint32_t iterations = 200000;
+  RawSensorSample sample = { { 2950, 2500, 120, 2000, 130 }, 0.004274f, 0.0421f, 0.1682f,
+                             { 12.61f, 88.4f, 100.0f, 47.3f, 100.0f }, 12 };
+  size_t bytes = 0;
+  size_t allocationsBefore = heapAllocations;
+  double writer = nsPerCall(iterations, [&](uint32_t i) {
+    char buffer[1024];
+    JsonBufferSink sink(buffer, sizeof(buffer));
+    JsonWriter<JsonBufferSink> json(sink);
+    sample.ageMs = i & 0xFFF;
+    writeRawSensors(json, sample);
+    bytes += sink.length();
+  });
+  double writerAllocs = (double)(heapAllocations - allocationsBefore) / iterations;
+  printf("json writer         %8.1f ns/doc, %6.1f MB/s, %.2f allocs/doc (%u bytes)\n",
+         writer, bytes / (writer * iterations) * 1000.0, writerAllocs, (unsigned)(bytes / iterations));
+
+#ifdef HOST_HAS_ARDUINOJSON
+  bytes = 0;
+  allocationsBefore = heapAllocations;
+  double baseline = nsPerCall(iterations, [&](uint32_t i) {
+    sample.ageMs = i & 0xFFF;
+    bytes += writeRawSensorsArduinoJson(sample);
+  });
+  double baselineAllocs = (double)(heapAllocations - allocationsBefore) / iterations;
+  printf("arduinojson+string  %8.1f ns/doc, %6.1f MB/s, %.2f allocs/doc (%u bytes)\n",
+         baseline, bytes / (baseline * iterations) * 1000.0, baselineAllocs, (unsigned)(bytes / iterations));
+#else
+  printf("arduinojson+string  (skipped: ArduinoJson not in the include path)\n");
+#endif
+}
+
+static void runBenchmarks() {
+  hostBoot();
+  submitCommand(CMD_KEY_POSITION, 1);
+  hostRun(SENSOR_SAMPLE_INTERVAL);
+
+  volatile float sink = 0;
+  double tick = nsPerCall(1000000, [](uint32_t) { runControlTick(); });
+  double sample = nsPerCall(1000000, [](uint32_t) { sampleSensors(); });
+  double convert = nsPerCall(1000000, [&sink](uint32_t i) {
+    const CalibrationConstants calibration = getCalibration();
+    sink = sink + convertEngineTemp(i & 4095, calibration) + convertBatteryVoltage(i & 4095, calibration) +
+           convertFuelLevel(i & 4095, calibration);
+  });
+  double save = nsPerCall(20000, [](uint32_t) { g_settingsManager.saveSettings(); });
+  double load = nsPerCall(20000, [](uint32_t) { g_settingsManager.loadSettings(); });
+  const BobcatSettingsV1 v1 = settingsV1();
+  double migrate = nsPerCall(20000, [&v1, &sink](uint32_t) {
+    BobcatSettings settings;
+    sink = sink + decodeSettings((const uint8_t*)&v1, sizeof(v1), settings);
+  });
+  uint8_t blob[SETTINGS_BLOB_MAX];
+  size_t blobLength = encodeSettings(g_settingsManager.getSettings(), blob, sizeof(blob));
+  double crc = nsPerCall(100000, [&blob, blobLength, &sink](uint32_t) { sink = sink + halCrc32(0, blob, blobLength); });
+  static const char* bodies[] = { "{\"action\":\"key_position\",\"position\":1}", "{\"action\":\"lights\"}",
+                                  "{\"action\":\"key_start_hold\",\"held\":true}", "{\"action\":\"bogus\"}" };
+  double control = nsPerCall(1000000, [&sink](uint32_t i) {
+    ControlActions::Request request;
+    const char* body = bodies[i & 3];
+    if (ControlActions::parse(body, strlen(body), request)) {
+      sink = sink + (ControlActions::find(request.action, request.actionLength) != nullptr);
+    }
+  });
+
+  printf("control tick        %8.1f ns\n", tick);
+  printf("sensor sample       %8.1f ns\n", sample);
+  printf("3 conversions       %8.1f ns\n", convert);
+  printf("settings save       %8.1f ns\n", save);
+  printf("settings load       %8.1f ns  (boot: NVS read, CRC32, records, validation)\n", load);
+  printf("settings v1 decode  %8.1f ns  (migration of the old layout)\n", migrate);
+  printf("crc32 %3u B         %8.1f ns\n", (unsigned)blobLength, crc);
+  printf("/control parse      %8.1f ns\n", control);
+
+  // Steps over a fixed pseudo-random event stream; the state feeds back, so
+  // neither loop can be folded away
+  uint8_t events[1024];
+  uint32_t lcg = 12345;
+  for (uint8_t& event : events) {
+    lcg = lcg * 1103515245u + 12345u;
+    event = (lcg >> 16) % IgnitionFsm::EVENT_COUNT;
+  }
+  uint8_t tableState = OFF;
+  uint8_t switchState = OFF;
+  double table = nsPerCall(10000000, [&](uint32_t i) {
+    const IgnitionFsm::Transition& t = IgnitionFsm::step(tableState, (IgnitionFsm::Event)events[i & 1023]);
+    tableState = t.next;
+    sink = sink + t.actions;
+  });
+  double branches = nsPerCall(10000000, [&](uint32_t i) {
+    SwitchStep t = switchStep(switchState, (IgnitionFsm::Event)events[i & 1023]);
+    switchState = t.next;
+    sink = sink + t.actions;
+  });
+  // The table costs a few ns more per step than the same transitions as a
+  // switch (the lookup is a dependent load); at most four steps run per
+  // control tick, and the table is what the safety static_asserts check
+  printf("fsm table step      %8.1f ns  (%.0f M steps/s, %+.0f %% vs switch)\n", table, 1000.0 / table,
+         (table / branches - 1.0) * 100.0);
+  printf("fsm switch step     %8.1f ns  (%.0f M steps/s, same transitions as a switch)\n", branches,
+         1000.0 / branches);
+
+  // One DMA read's worth of conversions (128) cycling over every input
+  static uint8_t adcFrame[256];
+  size_t adcLength = 0;
+  for (uint32_t i = 0; adcLength < sizeof(adcFrame); i++) {
+    adcLength = appendConversion(adcFrame, adcLength, ADC_TEST_CHANNELS[i % ADC_CHANNEL_COUNT], i);
+  }
+  adcSetChannelMap(ADC_TEST_CHANNELS);
+  double ingest = nsPerCall(200000, [](uint32_t) { adcDmaIngestFrame(adcFrame, sizeof(adcFrame)); });
+  double mean = nsPerCall(1000000, [&sink](uint32_t i) {
+    sink = sink + adcAverage((AdcChannelId)(i % ADC_CHANNEL_COUNT), ADC_DMA_AVERAGE_SAMPLES);
+  });
+  uint16_t decimated[16];
+  double decimate = nsPerCall(1000000, [&sink, &decimated](uint32_t i) {
+    sink = sink + adcRing((AdcChannelId)(i % ADC_CHANNEL_COUNT)).decimate(decimated, 16, 4);
+  });
+  printf("adc frame ingest    %8.1f ns  (%u conversions, %.1f ns each)\n", ingest,
+         (unsigned)(sizeof(adcFrame) / ADC_DMA_RESULT_BYTES), ingest / (sizeof(adcFrame) / ADC_DMA_RESULT_BYTES));
+  printf("adc %2u-sample mean  %8.1f ns\n", (unsigned)ADC_DMA_AVERAGE_SAMPLES, mean);
+  printf("adc decimate 16x4   %8.1f ns\n", decimate);
+
+  runJsonBenchmark();
+}
+
+// Operator model: key ON, preheat (skipped every fourth cycle), hold START
+// until the engine fires or the controller's crank timeout drops the
+// starter, run for half an hour, key OFF and wait before the next cycle.
+static void runPlantSimulation(uint32_t cycles, float ambient) {
+  hostBoot();
+  PlantModel plant(ambient);
+  uint32_t simStartMs = halMillis();
+  uint64_t simMs = 0;
+  uint32_t lastMs = simStartMs;
+  auto tick = [&](uint32_t ms) {
+    hostRun(ms, &plant);
+    simMs += halMillis() - lastMs;   // Wraps after ~49 days; accumulate deltas
+    lastMs = halMillis();
+  };
+  auto wallStart = std::chrono::steady_clock::now();
+
+  for (uint32_t cycle = 0; cycle < cycles; cycle++) {
+    submitCommand(CMD_KEY_POSITION, 1);
+    tick(1000);
+
+    if (cycle % 4 != 3) {
+      submitCommand(CMD_KEY_POSITION, 2);
+      tick(SENSOR_SAMPLE_INTERVAL);
+      while (g_systemState.currentState == GLOW_PLUG) {
+        tick(SENSOR_SAMPLE_INTERVAL);
+      }
+    }
+
+    submitCommand(CMD_KEY_START_HOLD, 1);
+    tick(SENSOR_SAMPLE_INTERVAL);
+    while (!plant.state().running && halHostDigitalOutput(STARTER_PIN) == HAL_HIGH) {
+      tick(SENSOR_SAMPLE_INTERVAL);
+    }
+    submitCommand(CMD_KEY_START_HOLD, 0);
+    tick(SENSOR_SAMPLE_INTERVAL);
+
+    if (plant.state().running) {
+      tick(30UL * 60 * 1000);
+    }
+    submitCommand(CMD_KEY_POSITION, 0);
+    tick(10UL * 60 * 1000);
+  }
+
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  double simSeconds = simMs / 1000.0;
+  const PlantStats& stats = plant.stats();
+  printf("simulated           %.1f h in %.2f s wall\n", simSeconds / 3600.0, wall);
+  printf("speed               %.0f sim-seconds per wall-second\n", simSeconds / wall);
+  printf("starts              %u of %u crank attempts (%u cycles)\n",
+         (unsigned)stats.starts, (unsigned)stats.crankAttempts, (unsigned)cycles);
+  printf("min crank voltage   %.2f V\n", stats.minCrankVoltage);
+  printf("battery SOC         %.0f %%, fuel %.0f %%, coolant %.0f C\n",
+         plant.state().batterySoc * 100.0f, plant.state().fuelLevel, plant.state().coolantTemp);
+  printf("deep sleeps         %u\n", (unsigned)hostDeepSleepCount());
+}
+
+// Records the scripted key sequence; a device trace comes from /api/trace
+static int recordTrace(const char* path) {
+  traceReset();
+  runKeySequence();
+  runCommandEdges();
+
+  std::vector<uint8_t> trace(traceExportSize());
+  trace.resize(traceExport(trace.data(), trace.size()));
+  FILE* file = fopen(path, "wb");
+  if (file == nullptr || fwrite(trace.data(), 1, trace.size(), file) != trace.size()) {
+    printf("cannot write %s\n", path);
+    return 1;
+  }
+  fclose(file);
+  printf("trace               %u bytes -> %s\n", (unsigned)trace.size(), path);
+  return failures == 0 ? 0 : 1;
+}
+
+static int replayTraceFile(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) {
+    printf("cannot read %s\n", path);
+    return 1;
+  }
+  std::vector<uint8_t> trace;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    trace.insert(trace.end(), chunk, chunk + n);
+  }
+  fclose(file);
+
+  hostBoot();
+  auto wallStart = std::chrono::steady_clock::now();
+  ReplayResult result = replayTrace(trace.data(), trace.size());
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+  if (result.error != nullptr) {
+    printf("trace error: %s\n", result.error);
+  }
+  printf("replayed            %u ticks, %u commands, %.1f s of control time in %.3f s wall\n",
+         (unsigned)result.ticks, (unsigned)result.commands, result.simulatedMs / 1000.0, wall);
+  printf("output mismatches   %u\n", (unsigned)result.mismatches);
+  return result.error == nullptr && result.mismatches == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+  Serial.setEnabled(false);
+
+  if (argc > 1 && strcmp(argv[1], "sim") == 0) {
+    uint32_t cycles = argc > 2 ? strtoul(argv[2], nullptr, 10) : 200;
+    float ambient = argc > 3 ? strtof(argv[3], nullptr) : 20.0f;
+    runPlantSimulation(cycles, ambient);
+    return 0;
+  }
+  if (argc > 2 && strcmp(argv[1], "record") == 0) {
+    return recordTrace(argv[2]);
+  }
+  if (argc > 2 && strcmp(argv[1], "replay") == 0) {
+    return replayTraceFile(argv[2]);
+  }
+
+  runKeySequence();
+  runCommandEdges();
+  runCommandSequencing();
+  runFsmChecks();
+  runDeadlineScheduler();
+  runSettingsRoundTrip();
+  runSettingsSchema();
+  runSettingsMigration();
+  runSettingsCoalescing();
+  runSnapshotStress();
+  runSensorSnapshotStress();
+  runAdcIngest();
+  runResumeState();
+  runStatusBinRoundTrip();
+  runControlActionChecks();
+  runPowerProfiles();
+  runTaskMonitor();
+  printf("functional checks: %s\n", failures == 0 ? "passed" : "FAILED");
+
+  runBenchmarks();
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,37 @@
+/*
+ * Host Runner Support Header for Bobcat Ignition Controller (env:native only)
+ * Helpers shared by the host runner, simulator and replay tools
+ */
+
+#ifndef HOST_SUPPORT_H
+#define HOST_SUPPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class PlantModel;
+
+// Boot the control core the way setup() does, minus WiFi/OTA/web
+void hostBoot();
+
+// Advance the virtual clock by `ms`, sampling sensors every
+// SENSOR_SAMPLE_INTERVAL and running a control tick after each sample.
+// With a plant, it is stepped just before each sample.
+void hostRun(uint32_t ms, PlantModel* plant = nullptr);
+
+// enterDeepSleep() calls since start (sleep_host.cpp)
+uint32_t hostDeepSleepCount();
+
+struct ReplayResult {
+  uint32_t ticks;
+  uint32_t commands;
+  uint32_t mismatches;   // Ticks whose relays/state differ from the recording
+  uint32_t simulatedMs;
+  const char* error;     // Malformed trace, or nullptr
+};
+
+// Feed a trace export (trace.h) through the control tick on the virtual
+// clock and compare every tick's relay/state outputs (trace_replay.cpp)
+ReplayResult replayTrace(const uint8_t* data, size_t len);
+
+#endif // HOST_SUPPORT_H
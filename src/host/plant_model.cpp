@@ -0,0 +1,164 @@
+/*
+ * Diesel Engine and Electrical Plant Model Implementation for Bobcat
+ * Ignition Controller (env:native only)
+ * Rough numbers for a small 4-cylinder diesel on a 12 V, 60 Ah battery.
+ * The aim is realistic timing and interactions, not accuracy.
+ */
+
+#include "plant_model.h"
+#include <math.h>
+#include "config.h"
+#include "hal.h"
+#include "hardware.h"
+
+// Electrical
+static const float BATTERY_CAPACITY_AH = 60.0f;
+static const float BATTERY_INTERNAL_OHMS = 0.015f;
+static const float ALTERNATOR_VOLTAGE = 14.2f;
+static const float ALTERNATOR_MAX_AMPS = 40.0f;
+static const float MAIN_POWER_AMPS = 1.5f;       // Fuel solenoid, gauges
+static const float GLOW_PLUG_AMPS = 40.0f;       // 4 plugs
+static const float STARTER_AMPS = 180.0f;
+static const float LIGHTS_AMPS = 8.0f;
+
+// Engine
+static const float CRANK_RPM = 250.0f;           // At 12 V
+static const float IDLE_RPM = 2400.0f;           // Governor set point (hand throttle)
+static const float MIN_FIRING_RPM = 120.0f;
+static const float BASE_CRANK_MS = 800.0f;       // Cranking needed when fully preheated
+static const float COLD_CRANK_MS = 8000.0f;      // Extra cranking with no preheat at 0 °C
+static const float FROST_CRANK_MS = 500.0f;      // Extra cranking per °C below zero
+static const float WARM_BLOCK_TEMP = 60.0f;      // Coolant temp that needs no preheat
+static const float MAX_OIL_PRESSURE = 350.0f;    // kPa at IDLE_RPM
+static const float OIL_SWITCH_KPA = 69.0f;       // Pressure switch closes above this
+static const float ALTERNATOR_CUT_IN_RPM = 1000.0f;
+static const float FUEL_BURN_PCT_PER_HOUR = 0.8f;   // ~0.5 L/h from a 60 L tank
+
+// Time constants (seconds)
+static const float TAU_GLOW_HEAT = 4.0f;
+static const float TAU_GLOW_COOL = 15.0f;
+static const float TAU_RPM_UP = 0.5f;
+static const float TAU_RPM_DOWN = 0.3f;
+static const float TAU_OIL = 0.5f;
+static const float TAU_COOLANT_WARM = 600.0f;
+static const float TAU_COOLANT_COOL = 3600.0f;
+static const float RUNNING_COOLANT_TEMP = 88.0f;
+
+// Move `value` toward `target` by the exact first-order response over dt
+static float approach(float value, float target, float tau, float dt) {
+  return target + (value - target) * expf(-dt / tau);
+}
+
+PlantModel::PlantModel(float ambientTemp) : ambient(ambientTemp), wasCranking(false) {
+  plant.batterySoc = 0.9f;
+  plant.batteryVoltage = 11.8f + 0.9f * plant.batterySoc;
+  plant.glowHeat = 0.0f;
+  plant.coolantTemp = ambientTemp;
+  plant.rpm = 0.0f;
+  plant.oilPressure = 0.0f;
+  plant.fuelLevel = 100.0f;
+  plant.running = false;
+  plant.crankMs = 0;
+
+  counters.starts = 0;
+  counters.crankAttempts = 0;
+  counters.shutdowns = 0;
+  counters.minCrankVoltage = plant.batteryVoltage;
+
+  writeInputs();
+}
+
+void PlantModel::step(uint32_t dtMs) {
+  float dt = dtMs / 1000.0f;
+  bool mainPower = halHostDigitalOutput(MAIN_POWER_PIN) == HAL_HIGH;
+  bool glow = halHostDigitalOutput(GLOW_PLUGS_PIN) == HAL_HIGH;
+  bool starter = halHostDigitalOutput(STARTER_PIN) == HAL_HIGH;
+  bool lights = halHostDigitalOutput(LIGHTS_PIN) == HAL_HIGH;
+
+  // --- Electrical load and battery -----------------------------------------
+  float load = (mainPower ? MAIN_POWER_AMPS : 0) + (glow ? GLOW_PLUG_AMPS : 0) +
+               (starter ? STARTER_AMPS : 0) + (lights ? LIGHTS_AMPS : 0);
+  float openCircuit = 11.8f + 0.9f * plant.batterySoc;
+  float batteryAmps = -load;   // Positive = charging
+  float terminal = openCircuit - load * BATTERY_INTERNAL_OHMS;
+
+  if (plant.rpm >= ALTERNATOR_CUT_IN_RPM) {
+    float charge = (ALTERNATOR_VOLTAGE - openCircuit) / BATTERY_INTERNAL_OHMS;
+    charge = fminf(fmaxf(charge, 0.0f), ALTERNATOR_MAX_AMPS);
+    batteryAmps = charge;
+    terminal = fminf(ALTERNATOR_VOLTAGE, openCircuit + charge * BATTERY_INTERNAL_OHMS);
+  }
+
+  plant.batterySoc += batteryAmps * dt / 3600.0f / BATTERY_CAPACITY_AH;
+  plant.batterySoc = fminf(fmaxf(plant.batterySoc, 0.0f), 1.0f);
+  plant.batteryVoltage = terminal;
+
+  // --- Glow plugs ------------------------------------------------------------
+  plant.glowHeat = glow ? approach(plant.glowHeat, 1.0f, TAU_GLOW_HEAT, dt)
+                        : approach(plant.glowHeat, 0.0f, TAU_GLOW_COOL, dt);
+
+  // --- Starter and combustion -----------------------------------------------
+  bool cranking = starter && !plant.running;
+  if (cranking && !wasCranking) {
+    counters.crankAttempts++;
+    plant.crankMs = 0;
+  }
+  wasCranking = cranking;
+
+  if ((!mainPower || plant.fuelLevel <= 0.0f) && plant.running) {
+    plant.running = false;   // Fuel solenoid closed (or tank dry)
+    counters.shutdowns++;
+  }
+
+  float targetRpm = 0.0f;
+  if (plant.running) {
+    targetRpm = IDLE_RPM;
+  } else if (starter) {
+    targetRpm = CRANK_RPM * fminf(terminal / 12.0f, 1.0f);
+    counters.minCrankVoltage = fminf(counters.minCrankVoltage, terminal);
+  }
+  plant.rpm = approach(plant.rpm, targetRpm, targetRpm > plant.rpm ? TAU_RPM_UP : TAU_RPM_DOWN, dt);
+
+  if (cranking && mainPower && plant.fuelLevel > 0.0f && plant.rpm >= MIN_FIRING_RPM) {
+    plant.crankMs += dtMs;
+    float warmth = fminf(fmaxf(plant.coolantTemp / WARM_BLOCK_TEMP, 0.0f), 1.0f);
+    float preheat = fmaxf(plant.glowHeat, warmth);
+    float needed = BASE_CRANK_MS + (1.0f - preheat) * (COLD_CRANK_MS + fmaxf(-plant.coolantTemp, 0.0f) * FROST_CRANK_MS);
+    if (plant.crankMs >= needed) {
+      plant.running = true;
+      counters.starts++;
+    }
+  }
+
+  if (!cranking) {
+    plant.crankMs = 0;
+  }
+
+  // --- Lubrication, cooling, fuel -------------------------------------------
+  plant.oilPressure = approach(plant.oilPressure, MAX_OIL_PRESSURE * plant.rpm / IDLE_RPM, TAU_OIL, dt);
+  plant.coolantTemp = plant.running ? approach(plant.coolantTemp, RUNNING_COOLANT_TEMP, TAU_COOLANT_WARM, dt)
+                                    : approach(plant.coolantTemp, ambient, TAU_COOLANT_COOL, dt);
+  if (plant.running) {
+    plant.fuelLevel = fmaxf(plant.fuelLevel - FUEL_BURN_PCT_PER_HOUR * dt / 3600.0f, 0.0f);
+  }
+
+  writeInputs();
+}
+
+// Inverse of the conversions in hardware.cpp, using the live calibration
+void PlantModel::writeInputs() {
+  const CalibrationConstants calibration = getCalibration();
+  float batteryRaw = plant.batteryVoltage / calibration.batteryDivider;
+  float tempRaw = (150.0f - plant.coolantTemp) / calibration.tempScale;
+  float fuelRaw = calibration.fuelEmpty + plant.fuelLevel * (calibration.fuelFull - calibration.fuelEmpty) / 100.0f;
+
+  halHostSetAnalogInput(BATTERY_VOLTAGE_PIN, (uint16_t)fminf(fmaxf(batteryRaw, 0.0f), 4095.0f));
+  halHostSetAnalogInput(ENGINE_TEMP_PIN, (uint16_t)fminf(fmaxf(tempRaw, 0.0f), 4095.0f));
+  halHostSetAnalogInput(FUEL_LEVEL_PIN, (uint16_t)fminf(fmaxf(fuelRaw, 0.0f), 4095.0f));
+
+  // Switches are active LOW (INPUT_PULLUP)
+  halHostSetDigitalInput(OIL_PRESSURE_PIN, plant.oilPressure > OIL_SWITCH_KPA ? HAL_LOW : HAL_HIGH);
+  halHostSetDigitalInput(HYD_PRESSURE_PIN, plant.rpm > ALTERNATOR_CUT_IN_RPM ? HAL_LOW : HAL_HIGH);
+  halHostSetDigitalInput(ALTERNATOR_CHARGE_PIN, plant.rpm >= ALTERNATOR_CUT_IN_RPM ? HAL_LOW : HAL_HIGH);
+  halHostSetDigitalInput(ENGINE_RUN_FEEDBACK_PIN, plant.running ? HAL_HIGH : HAL_LOW);
+}
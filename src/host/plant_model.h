@@ -0,0 +1,55 @@
+/*
+ * Diesel Engine and Electrical Plant Model for Bobcat Ignition Controller
+ * (env:native only)
+ * Reacts to the relay outputs the controller writes through the host HAL
+ * and drives the analog/digital inputs hardware.cpp reads: starter draw
+ * sags the battery, glow plugs preheat, the engine fires after enough
+ * cranking, oil pressure builds, the alternator charges and the coolant
+ * warms up. Every time constant is integrated exactly (exp(-dt/tau)), so
+ * the model is stable at any step size and runs far faster than real time.
+ */
+
+#ifndef PLANT_MODEL_H
+#define PLANT_MODEL_H
+
+#include <stdint.h>
+
+struct PlantState {
+  float batteryVoltage;     // Terminal voltage (V)
+  float batterySoc;         // State of charge (0-1)
+  float glowHeat;           // Glow plug preheat (0 = ambient, 1 = fully hot)
+  float coolantTemp;        // °C
+  float rpm;
+  float oilPressure;        // kPa
+  float fuelLevel;          // %
+  bool running;             // Engine combusting on its own
+  uint32_t crankMs;         // Cranking time in the current attempt
+};
+
+struct PlantStats {
+  uint32_t starts;          // Successful starts
+  uint32_t crankAttempts;   // Starter engagements
+  uint32_t shutdowns;       // Engine stopped by main power (key OFF) or empty tank
+  float minCrankVoltage;    // Lowest terminal voltage while cranking
+};
+
+class PlantModel {
+public:
+  explicit PlantModel(float ambientTemp = 20.0f);
+
+  // Read the relays, advance the physics by dtMs, then write the inputs
+  void step(uint32_t dtMs);
+
+  const PlantState& state() const { return plant; }
+  const PlantStats& stats() const { return counters; }
+
+private:
+  float ambient;
+  PlantState plant;
+  PlantStats counters;
+  bool wasCranking;
+
+  void writeInputs();
+};
+
+#endif // PLANT_MODEL_H
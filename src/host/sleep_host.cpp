@@ -0,0 +1,39 @@
+/*
+ * Host Deep Sleep Stand-ins for Bobcat Ignition Controller (env:native only)
+ * There is no deep sleep on the host: entering it turns the relays off and
+ * is counted, and the simulated controller keeps running
+ */
+
+#include "hardware.h"
+#include "config.h"
+#include "hal.h"
+#include "system_state.h"
+#include "logger.h"
+#include "resume_state.h"
+
+static uint32_t sleepCount = 0;
+
+void initializeSleepMode() {
+  g_systemState.lastActivityTime = halMillis();
+  g_systemState.sleepModeEnabled = true;
+  g_systemState.wakeUpPending = false;
+  g_systemState.sleepTimer = halMillis();
+}
+
+void enterDeepSleep() {
+  prepareForSleep();
+  sleepCount++;
+  LOG_INFO("Deep sleep requested (host: continuing)");
+}
+
+void handleWakeUp() {
+  g_systemState.keyPosition = 0;
+  g_systemState.currentState = OFF;
+  g_systemState.wakeUpPending = false;
+  g_systemState.lastActivityTime = halMillis();
+  restoreResumeState();
+}
+
+uint32_t hostDeepSleepCount() {
+  return sleepCount;
+}
@@ -0,0 +1,123 @@
+/*
+ * Control Trace Replay for Bobcat Ignition Controller (env:native only)
+ * Restores each keyframe, then re-runs every recorded tick at its recorded
+ * time with the recorded snapshot and commands. The clock only jumps
+ * between ticks, so replay runs as fast as the control code does.
+ */
+
+#include <stdio.h>
+#include "host_support.h"
+#include "config.h"
+#include "hal.h"
+#include "commands.h"
+#include "control_scheduler.h"
+#include "hardware.h"
+#include "sensors.h"
+#include "system_state.h"
+#include "trace.h"
+
+static const uint32_t MAX_REPORTED_MISMATCHES = 10;
+
+// Code that still reads the switches directly sees the recorded levels
+static void applyInputs(const SensorSnapshot& s) {
+  publishSensorSnapshot(s);
+  halHostSetDigitalInput(OIL_PRESSURE_PIN, s.oilPressureOk ? HAL_LOW : HAL_HIGH);
+  halHostSetDigitalInput(HYD_PRESSURE_PIN, s.hydPressureOk ? HAL_LOW : HAL_HIGH);
+  halHostSetDigitalInput(ALTERNATOR_CHARGE_PIN, s.alternatorCharging ? HAL_LOW : HAL_HIGH);
+  halHostSetDigitalInput(ENGINE_RUN_FEEDBACK_PIN, s.engineRunning ? HAL_HIGH : HAL_LOW);
+  halHostSetDigitalInput(SEAT_BAR_PIN, s.seatBarEngaged ? HAL_LOW : HAL_HIGH);
+  halHostSetDigitalInput(NEUTRAL_SAFETY_PIN, s.inNeutral ? HAL_LOW : HAL_HIGH);
+}
+
+static void restoreRelays(uint8_t relays) {
+  controlMainPower(relays & RELAY_MAIN_POWER);
+  controlGlowPlugs(relays & RELAY_GLOW_PLUGS);
+  controlStarter(relays & RELAY_STARTER);
+  controlLights(relays & RELAY_LIGHTS);
+}
+
+ReplayResult replayTrace(const uint8_t* data, size_t len) {
+  ReplayResult result = {};
+  TraceReader reader;
+  if (!reader.open(data, len)) {
+    result.error = reader.error();
+    return result;
+  }
+
+  bool tickPending = false;
+  uint32_t tickTime = 0;
+  uint32_t firstMs = 0;
+  uint8_t expectedRelays = 0;
+  uint8_t expectedState = 0;
+
+  auto runPendingTick = [&]() {
+    if (!tickPending) {
+      return;
+    }
+    tickPending = false;
+    halHostSetTime(tickTime);
+    runControlTick();
+    result.ticks++;
+
+    uint8_t relays = getRelayStates();
+    uint8_t state = (uint8_t)g_systemState.currentState;
+    if (relays != expectedRelays || state != expectedState) {
+      if (result.mismatches < MAX_REPORTED_MISMATCHES) {
+        printf("t=%u ms: recorded relays 0x%02x %s, replay relays 0x%02x %s\n",
+               (unsigned)tickTime, expectedRelays, systemStateToString(expectedState),
+               relays, systemStateToString(state));
+      }
+      result.mismatches++;
+      // Carry on from the recorded outputs so one divergence is reported once
+      restoreRelays(expectedRelays);
+      g_systemState.currentState = expectedState;
+    }
+  };
+
+  TraceEvent event;
+  bool first = true;
+  while (reader.next(event)) {
+    if (first) {
+      firstMs = event.timeMs;
+      first = false;
+    }
+
+    switch (event.kind) {
+      case TRACE_KEYFRAME:
+        runPendingTick();
+        halHostSetTime(event.timeMs);
+        g_systemState = event.state;
+        restoreRelays(event.relays);
+        applyInputs(event.snapshot);
+        expectedRelays = event.relays;
+        expectedState = (uint8_t)event.state.currentState;
+        break;
+
+      case TRACE_TICK:
+        runPendingTick();
+        tickPending = true;
+        tickTime = event.timeMs;
+        break;
+
+      case TRACE_SNAPSHOT:
+        applyInputs(event.snapshot);
+        break;
+
+      case TRACE_COMMAND:
+        submitCommand((CommandType)event.commandType, event.commandArg);
+        result.commands++;
+        break;
+
+      case TRACE_OUTPUT:
+        expectedRelays = event.relays;
+        expectedState = event.currentState;
+        runPendingTick();
+        break;
+    }
+    result.simulatedMs = event.timeMs - firstMs;
+  }
+  runPendingTick();
+
+  result.error = reader.error();
+  return result;
+}
@@ -0,0 +1,176 @@
+/*
+ * Asynchronous Logger Implementation for Bobcat Ignition Controller
+ * Producers only touch the queue; formatting and UART writes happen in
+ * the drain task
+ */
+
+#include <atomic>
+#include "logger.h"
+#include "config.h"
+#include "hal.h"
+#include "mpsc_queue.h"
+#include "task_monitor.h"
+
+static MpscQueue<LogRecord, 64> logQueue;
+static std::atomic<uint32_t> dropped(0);
+static std::atomic<uint32_t> queued(0);
+static std::atomic<uint32_t> written(0);
+
+static const char LEVEL_TAGS[] = { '-', 'E', 'W', 'I', 'D' };
+
+static void writePendingRecords();
+
+#ifdef ARDUINO
+static TaskHandle_t drainTask = nullptr;
+#endif
+
+void submitLogRecord(LogRecord& record) {
+  record.timestampMs = halMillis();
+  if (!logQueue.push(record)) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  queued.fetch_add(1, std::memory_order_relaxed);
+#ifdef ARDUINO
+  if (drainTask != nullptr) {
+    xTaskNotifyGive(drainTask);
+  }
+#else
+  writePendingRecords(); // Host builds are single-threaded: write through
+#endif
+}
+
+// Format one conversion spec (e.g. "%.2f") with its typed argument
+static int formatArg(char* out, size_t size, const char* spec, const LogArg& arg) {
+  switch (arg.type) {
+    case LOG_ARG_INT:    return snprintf(out, size, spec, (int)arg.i);
+    case LOG_ARG_UINT:   return snprintf(out, size, spec, (unsigned int)arg.u);
+    case LOG_ARG_FLOAT:  return snprintf(out, size, spec, (double)arg.f);
+    case LOG_ARG_STRING: return snprintf(out, size, spec, arg.s ? arg.s : "(null)");
+  }
+  return 0;
+}
+
+// Expand the format string into `line`. Only the argument types recorded at
+// the call site are used, so a spec/type mismatch can't read past the record.
+static size_t formatRecord(const LogRecord& record, char* line, size_t size) {
+  int len = snprintf(line, size, "[%8lu] %c ", (unsigned long)record.timestampMs,
+                     LEVEL_TAGS[record.level <= LOG_LEVEL_DEBUG ? record.level : 0]);
+  size_t pos = len > 0 ? len : 0;
+  uint8_t argIndex = 0;
+
+  for (const char* p = record.format; *p && pos < size - 1; p++) {
+    if (*p != '%') {
+      line[pos++] = *p;
+      continue;
+    }
+    if (p[1] == '%') {
+      line[pos++] = '%';
+      p++;
+      continue;
+    }
+
+    // Copy the spec up to and including its conversion letter
+    char spec[12];
+    size_t specLen = 0;
+    spec[specLen++] = *p++;
+    while (*p && specLen < sizeof(spec) - 2 && strchr("0123456789.-+ #l", *p)) {
+      if (*p != 'l') {
+        spec[specLen++] = *p;   // Length modifiers are re-derived from the type
+      }
+      p++;
+    }
+    if (!*p) {
+      break;
+    }
+    char conversion = *p;
+    if (argIndex >= record.argCount) {
+      continue;   // Missing argument: drop the spec
+    }
+    const LogArg& arg = record.args[argIndex++];
+    if (arg.type == LOG_ARG_FLOAT && !strchr("fFeEgG", conversion)) {
+      conversion = 'f';
+    } else if (arg.type == LOG_ARG_STRING) {
+      conversion = 's';
+    } else if (arg.type != LOG_ARG_FLOAT && strchr("fFeEgGs", conversion)) {
+      conversion = arg.type == LOG_ARG_UINT ? 'u' : 'd';
+    }
+    spec[specLen++] = conversion;
+    spec[specLen] = '\0';
+
+    int n = formatArg(line + pos, size - pos, spec, arg);
+    if (n > 0) {
+      pos += n;
+      if (pos > size - 1) {
+        pos = size - 1;
+      }
+    }
+  }
+
+  line[pos] = '\0';
+  return pos;
+}
+
+// Consumer side: only the drain task (or the host's single thread) calls this
+static void writePendingRecords() {
+  static uint32_t reportedDropped = 0;
+  char line[160];
+  LogRecord record;
+
+  while (logQueue.pop(record)) {
+    size_t len = formatRecord(record, line, sizeof(line) - 2);
+    line[len++] = '\r';
+    line[len++] = '\n';
+    Serial.write((const uint8_t*)line, len);
+    written.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint32_t lost = dropped.load(std::memory_order_relaxed);
+  if (lost != reportedDropped) {
+    Serial.printf("[log] %u records dropped\r\n", (unsigned int)(lost - reportedDropped));
+    reportedDropped = lost;
+  }
+}
+
+#ifdef ARDUINO
+static void drainLoop(void*) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint32_t started = halMicros();
+    writePendingRecords();
+    noteTaskBusy(TASK_LOG, halMicros() - started);
+  }
+}
+
+void startLogger() {
+  if (drainTask != nullptr) {
+    return;
+  }
+  xTaskCreatePinnedToCore(drainLoop, "log", LOG_TASK_STACK_SIZE, nullptr,
+                          LOG_TASK_PRIORITY, &drainTask, NETWORK_CORE);
+  xTaskNotifyGive(drainTask); // Flush anything logged before the task existed
+}
+
+void flushLog(uint32_t timeoutMs) {
+  if (drainTask == nullptr) {
+    return;
+  }
+  uint32_t start = millis();
+  uint32_t target = queued.load(std::memory_order_relaxed);
+  xTaskNotifyGive(drainTask);
+  while ((int32_t)(written.load(std::memory_order_relaxed) - target) < 0 && millis() - start < timeoutMs) {
+    vTaskDelay(pdMS_TO_TICKS(2));
+  }
+  Serial.flush();
+}
+#else
+void startLogger() {}
+
+void flushLog(uint32_t) {
+  writePendingRecords();
+}
+#endif
+
+uint32_t logRecordsDropped() {
+  return dropped.load(std::memory_order_relaxed);
+}
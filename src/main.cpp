@@ -16,8 +16,16 @@
 #include "config.h"
 #include "hardware.h"
 #include "safety.h"
+#include "sensors.h"
+#include "commands.h"
+#include "control_scheduler.h"
+#include "boot_profile.h"
+#include "resume_state.h"
+#include "power_manager.h"
+#include "logger.h"
 #include "system_state.h"
 #include "web_interface.h"
+#include "status_report.h"
 #include "settings.h"
 #include <ElegantOTA.h>
 // Optional CLI-friendly OTA (PlatformIO espota.py)
@@ -25,43 +33,88 @@
 #include <WiFi.h>
 
 static bool g_otaInitialized = false;
+// Set by loop() on the network core, so the control task never calls into
+// the WiFi driver to find out
+static volatile bool g_clientConnected = false;
+
+// Pinned to CONTROL_CORE above the network stack: HTTP handlers and WiFi
+// events run on the other core and can no longer delay a tick
+static void controlTask(void* parameter) {
+  registerControlTask();
+  for (;;) {
+    // Sleep check, queued commands, ignition state machine, safety checks
+    runControlTick();
+
+    // Full clock while the engine needs it or someone is using the web UI
+    updatePowerProfile(g_systemState.currentState, g_clientConnected);
+
+    // Sleep until the next glow/crank/countdown/sleep deadline, the
+    // housekeeping interval, or until a queued command wakes us
+    scheduleControlDeadlines();
+    waitForNextControlEvent();
+  }
+}
 
 void setup() {
+  // Wake-up cause first: the boot profile starts with it
+  esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
+  startBootProfile(wakeup_reason != ESP_SLEEP_WAKEUP_UNDEFINED);
+
+  startBootPhase(BOOT_PHASE_CONSOLE);
   Serial.begin(115200);
+  startLogger(); // Control-path messages go through the async log queue
   Serial.println("Bobcat Ignition Controller Starting...");
+  endBootPhase(BOOT_PHASE_CONSOLE);
   
   // Check if this is a wake-up from deep sleep
-  esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
+  startBootPhase(BOOT_PHASE_WAKE);
   if (wakeup_reason != ESP_SLEEP_WAKEUP_UNDEFINED) {
     handleWakeUp();
   } else {
     Serial.println("Cold boot - initializing normally...");
   }
+  endBootPhase(BOOT_PHASE_WAKE);
   
-  // Initialize settings manager first
-  if (!g_settingsManager.begin()) {
+  // Initialize settings manager first (a wake restored them from RTC memory)
+  bool resumed = lastResumeResult() == RESUME_RESTORED;
+  if (!g_settingsManager.begin(!resumed)) {
     Serial.println("WARNING: Settings manager failed to initialize, using defaults");
   }
+  g_settingsManager.startCommitTask(); // Settings edits reach flash after a quiet period
   
+  startBootPhase(BOOT_PHASE_PINS);
   initializePins();
+  applyResumedOutputs();
+  endBootPhase(BOOT_PHASE_PINS);
+  startBootPhase(BOOT_PHASE_SENSORS);
+  startSensorSampling(); // Fixed-rate sampling; everything else reads the snapshot
   initializeSleepMode(); // Initialize deep sleep functionality
+  endBootPhase(BOOT_PHASE_SENSORS);
   
   g_systemState.currentState = OFF;  // Start in OFF state like a real ignition
   g_systemState.keyPosition = 0;     // Key starts in OFF position
   
-  setupWebServer(); // Initialize the web server
+  setupWebServer(); // Access point and web server; the home network joins in the background
 
   // Configure ArduinoOTA (begin is deferred until WiFi connected)
+  startBootPhase(BOOT_PHASE_OTA);
   ArduinoOTA.setHostname("bobcat-ignition");
   // To require a password, uncomment and pass via PIO with --auth
   // ArduinoOTA.setPassword("change_me");
   ArduinoOTA.onStart([]() { Serial.println("ArduinoOTA: Start"); });
   ArduinoOTA.onEnd([]() { Serial.println("ArduinoOTA: End"); });
   ArduinoOTA.onError([](ota_error_t error) { Serial.printf("ArduinoOTA Error[%u]\n", error); });
+  endBootPhase(BOOT_PHASE_OTA);
+
+  startPowerManagement(); // Idle profile until the state or a client asks for more
+  xTaskCreatePinnedToCore(controlTask, "control", CONTROL_TASK_STACK_SIZE, nullptr,
+                          CONTROL_TASK_PRIORITY, nullptr, CONTROL_CORE);
 
   Serial.println("System initialized - Key is in OFF position");
   Serial.println("Turn key to ON, then GLOW PLUG, then hold START to crank engine");
   Serial.println("System will auto-sleep after 30 minutes of inactivity");
+  markBootMilestone(BOOT_SETUP_DONE);
+  printBootProfile();
 }
 
 void loop() {
@@ -76,41 +129,8 @@ void loop() {
     Serial.println(":3232");
   }
   ArduinoOTA.handle();
-  
-  // Don't allow automatic sleep for the first 2 minutes after boot
-  // This gives time to connect and configure the system
-  unsigned long currentTime = millis();
-  const unsigned long BOOT_GRACE_PERIOD = 120000; // 2 minutes
-  
-  if (currentTime < BOOT_GRACE_PERIOD) {
-    // During grace period, just update activity timer to keep system awake
-    g_systemState.lastActivityTime = currentTime;
-  } else {
-    // After grace period, check for sleep conditions and enter sleep if appropriate
-    if (checkSleepConditions()) {
-      unsigned long timeSinceActivity = currentTime - g_systemState.lastActivityTime;
-      
-      if (timeSinceActivity >= SLEEP_TIMEOUT) {
-        Serial.println("Sleep timeout reached - entering deep sleep mode");
-        enterDeepSleep();
-        // Code will not reach here as ESP32 will sleep
-      }
-    }
-  }
-  
-  // Main ignition key sequence control
-  runIgnitionSequence();
-  
-  // Only check engine vitals when running
-  if (g_systemState.currentState == RUNNING) { 
-    checkEngineVitals();
-  } 
-  
-  // Always run safety checks except during start cranking
-  if (g_systemState.currentState != START) {
-    checkSafetyInputs();
-  }
-  
-  // Small delay to prevent overwhelming the system
-  delay(10);
+
+  g_clientConnected = WiFi.softAPgetStationNum() > 0 || statusStreamClients() > 0;
+  updateModemSleep(); // The control task picked the profile; the radio follows here
+  delay(OTA_POLL_INTERVAL); // The control loop runs in controlTask
 }
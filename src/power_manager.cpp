@@ -0,0 +1,155 @@
+/*
+ * Power Manager Implementation for Bobcat Ignition Controller
+ * The idle configuration is installed once; the other profiles only
+ * acquire locks on top of it, so switching profile never reconfigures
+ * the clock tree. The PM locks are taken on the control task; modem sleep
+ * is a WiFi driver call and follows the profile from loop() instead.
+ */
+
+#include "power_manager.h"
+#include "config.h"
+#include "hal.h"
+
+#ifdef ARDUINO
+#include <WiFi.h>
+#include <esp_pm.h>
+
+static esp_pm_lock_handle_t cpuLock = nullptr;     // ESP_PM_CPU_FREQ_MAX
+static esp_pm_lock_handle_t awakeLock = nullptr;   // ESP_PM_NO_LIGHT_SLEEP
+static bool locksHeld = false;
+static int8_t modemSleep = -1;   // As last set by updateModemSleep(), -1 = not yet
+// getPowerStats() is called from the web server task, the profile is
+// followed from loop()
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+#define STATS_LOCK() portENTER_CRITICAL(&statsMux)
+#define STATS_UNLOCK() portEXIT_CRITICAL(&statsMux)
+#else
+#define STATS_LOCK()
+#define STATS_UNLOCK()
+#endif
+
+static PowerStats stats = {};
+static bool applied = false;   // No profile until the first update
+static uint32_t enteredAt = 0;
+
+#ifdef ARDUINO
+static void applyProfile(PowerProfile profile) {
+  bool hold = profile != POWER_IDLE;
+  if (stats.frequencyScaling) {
+    if (hold && !locksHeld) {
+      esp_pm_lock_acquire(cpuLock);
+      esp_pm_lock_acquire(awakeLock);
+    } else if (!hold && locksHeld) {
+      esp_pm_lock_release(awakeLock);
+      esp_pm_lock_release(cpuLock);
+    }
+    locksHeld = hold;
+  } else {
+    // No esp_pm in this build: a fixed lower clock is the most we can do
+    setCpuFrequencyMhz(hold ? POWER_FULL_CPU_MHZ : POWER_IDLE_CPU_MAX_MHZ);
+  }
+}
+
+void updateModemSleep() {
+  STATS_LOCK();
+  bool known = applied;
+  PowerProfile profile = stats.profile;
+  STATS_UNLOCK();
+  // Modem sleep adds up to a DTIM interval to every reply
+  int8_t sleep = profile != POWER_CLIENT;
+  if (known && sleep != modemSleep) {
+    WiFi.setSleep(sleep != 0);
+    modemSleep = sleep;
+  }
+}
+#else
+static void applyProfile(PowerProfile) {}
+void updateModemSleep() {}
+#endif
+
+PowerProfile selectPowerProfile(int state, bool clientConnected) {
+  if (state != OFF && state != ON) {
+    return POWER_ENGINE;   // Relay timing and the safety checks come first
+  }
+  return clientConnected ? POWER_CLIENT : POWER_IDLE;
+}
+
+void startPowerManagement() {
+#ifdef ARDUINO
+  esp_pm_config_esp32_t config = {};
+  config.max_freq_mhz = POWER_IDLE_CPU_MAX_MHZ;
+  config.min_freq_mhz = POWER_IDLE_CPU_MIN_MHZ;
+  config.light_sleep_enable = true;
+  esp_err_t err = esp_pm_configure(&config);
+  stats.lightSleep = err == ESP_OK;
+  if (err == ESP_ERR_NOT_SUPPORTED) {
+    // Built without tickless idle: frequency scaling only
+    config.light_sleep_enable = false;
+    err = esp_pm_configure(&config);
+  }
+  stats.frequencyScaling = err == ESP_OK &&
+                           esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "power", &cpuLock) == ESP_OK &&
+                           esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "power", &awakeLock) == ESP_OK;
+  Serial.printf("Power management: %s, light sleep %s\n",
+                stats.frequencyScaling ? "frequency scaling" : "fixed clock",
+                stats.lightSleep ? "on" : "unavailable");
+#endif
+}
+
+void updatePowerProfile(int state, bool clientConnected) {
+  PowerProfile next = selectPowerProfile(state, clientConnected);
+  uint32_t now = halMillis();
+  if (applied && next == stats.profile) {
+    return;
+  }
+
+  // Locks first when leaving idle, so the next tick already runs at full clock
+  applyProfile(next);
+  STATS_LOCK();
+  if (applied) {
+    stats.profileMs[stats.profile] += now - enteredAt;
+    stats.transitions++;
+  }
+  stats.profile = next;
+  enteredAt = now;
+  applied = true;
+  STATS_UNLOCK();
+}
+
+PowerProfile currentPowerProfile() {
+  return stats.profile;
+}
+
+const char* powerProfileName(PowerProfile profile) {
+  switch (profile) {
+    case POWER_IDLE: return "idle";
+    case POWER_CLIENT: return "client";
+    case POWER_ENGINE: return "engine";
+    case POWER_PROFILE_COUNT: break;
+  }
+  return "?";
+}
+
+PowerStats getPowerStats() {
+  uint32_t now = halMillis();
+  STATS_LOCK();
+  PowerStats copy = stats;
+  if (applied) {
+    copy.profileMs[copy.profile] += now - enteredAt;
+  }
+  STATS_UNLOCK();
+  return copy;
+}
+
+float estimatedAverageCurrentMa(const PowerStats& stats) {
+  const float currentMa[POWER_PROFILE_COUNT] = {
+    POWER_IDLE_CURRENT_MA, POWER_CLIENT_CURRENT_MA, POWER_ENGINE_CURRENT_MA
+  };
+  float charge = 0.0f;
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < POWER_PROFILE_COUNT; i++) {
+    charge += currentMa[i] * stats.profileMs[i];
+    total += stats.profileMs[i];
+  }
+  return total > 0 ? charge / total : 0.0f;
+}
@@ -0,0 +1,110 @@
+/*
+ * Resume State Implementation for Bobcat Ignition Controller
+ * One block in RTC slow memory, written as the last step before deep
+ * sleep and consumed on the next wake
+ */
+
+#include "resume_state.h"
+#include "config.h"
+#include "hal.h"
+#include "hardware.h"
+#include "settings.h"
+#include "system_state.h"
+#include <stddef.h>
+#include <string.h>
+
+static const uint32_t RESUME_MAGIC = 0x52534D31;   // "1MSR" in memory order
+
+struct ResumeBlock {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;                   // sizeof(ResumeBlock) in the firmware that wrote it
+  uint32_t sleepCycles;
+  int8_t sleepState;
+  bool workLightsOn;
+  BobcatSettings settings;
+  CalibrationConstants calibration;
+  TempFilterState tempFilter;
+  FlashWriteStats flashStats;
+  uint32_t crc;                    // Of everything above
+};
+
+#ifdef ARDUINO
+// Kept through deep sleep, random after a power-on (the CRC tells them apart)
+RTC_DATA_ATTR static ResumeBlock resumeBlock;
+#else
+static ResumeBlock resumeBlock;    // Host: kept through a simulated deep sleep
+#endif
+
+static ResumeResult result = RESUME_NONE;
+static uint32_t cycles = 0;
+static int sleptIn = -1;
+
+static uint32_t blockCrc() {
+  return halCrc32(0, &resumeBlock, offsetof(ResumeBlock, crc));
+}
+
+void saveResumeState() {
+  memset(&resumeBlock, 0, sizeof(resumeBlock));   // Padding too, for the CRC
+  resumeBlock.magic = RESUME_MAGIC;
+  resumeBlock.version = RESUME_STATE_VERSION;
+  resumeBlock.size = sizeof(ResumeBlock);
+  resumeBlock.sleepCycles = cycles + 1;
+  resumeBlock.sleepState = (int8_t)g_systemState.currentState;
+  resumeBlock.workLightsOn = g_systemState.workLightsOn;
+  resumeBlock.settings = g_settingsManager.getSettings();
+  resumeBlock.calibration = getCalibration();
+  resumeBlock.tempFilter = getTempFilter();
+  resumeBlock.flashStats = g_settingsManager.getFlashStats();
+  resumeBlock.crc = blockCrc();
+}
+
+ResumeResult restoreResumeState() {
+  if (resumeBlock.magic != RESUME_MAGIC) {
+    result = RESUME_NONE;
+    return result;
+  }
+  bool valid = resumeBlock.version == RESUME_STATE_VERSION && resumeBlock.size == sizeof(ResumeBlock) &&
+               resumeBlock.crc == blockCrc() && g_settingsManager.validateSettings(resumeBlock.settings);
+  resumeBlock.magic = 0;   // Consumed: a reset after this wake boots normally
+  if (!valid) {
+    result = RESUME_INVALID;
+    return result;
+  }
+
+  g_settingsManager.restore(resumeBlock.settings, resumeBlock.flashStats);
+  publishCalibration(resumeBlock.calibration);
+  restoreTempFilter(resumeBlock.tempFilter);
+  g_systemState.workLightsOn = resumeBlock.workLightsOn;
+  cycles = resumeBlock.sleepCycles;
+  sleptIn = resumeBlock.sleepState;
+  result = RESUME_RESTORED;
+  return result;
+}
+
+void applyResumedOutputs() {
+  if (result == RESUME_RESTORED && g_systemState.workLightsOn) {
+    controlLights(true);
+  }
+}
+
+ResumeResult lastResumeResult() {
+  return result;
+}
+
+const char* resumeResultName(ResumeResult value) {
+  switch (value) {
+    case RESUME_NONE: return "none";
+    case RESUME_RESTORED: return "restored";
+    case RESUME_INVALID: return "invalid";
+  }
+  return "?";
+}
+
+uint32_t deepSleepCycles() {
+  return cycles;
+}
+
+int lastSleepState() {
+  return sleptIn;
+}
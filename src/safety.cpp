@@ -6,20 +6,14 @@
 #include "safety.h"
 #include "config.h"
 #include "hardware.h"
+#include "sensors.h"
 #include "system_state.h"
+#include "logger.h"
+#include "hal.h"
 
-void checkSafetyInputs() {
-  // Read analog sensors
-  int batteryVoltage = analogRead(BATTERY_VOLTAGE_PIN);
-  int engineTemp = analogRead(ENGINE_TEMP_PIN);
-  int oilPressure = analogRead(OIL_PRESSURE_PIN);
-  
-  // Convert ADC readings to meaningful values
-  // Battery voltage: assuming voltage divider for 12V system
-  float batteryVolts = (batteryVoltage * 3.3 / 4095.0) * (12.0 / 3.3); // Adjust divider ratio as needed
-  
-  // Check for low battery voltage
-  if (batteryVolts < 10.5 && g_systemState.currentState != OFF) {
+void checkSafetyInputs(const SensorSnapshot& sensors) {
+  // Check for low battery voltage (calibrated divider, same value the dashboard shows)
+  if (sensors.batteryVoltage < 10.5 && g_systemState.currentState != OFF) {
     handleError("Low battery voltage");
     return;
   }
@@ -30,52 +24,44 @@ void checkSafetyInputs() {
   // - Emergency stop conditions
 }
 
-void checkEngineVitals() {
+void checkEngineVitals(const SensorSnapshot& sensors) {
   if (g_systemState.currentState != RUNNING) {
     return; // Only check vitals when the engine is supposed to be running
   }
 
-  // Read and convert sensor values
-  int tempReading = analogRead(ENGINE_TEMP_PIN);
-  float engineTemp = (tempReading * TEMP_SENSOR_SCALE) + TEMP_SENSOR_OFFSET;
-
-  int pressureReading = analogRead(OIL_PRESSURE_PIN);
-  float oilPressure = (pressureReading * OIL_PRESSURE_SCALE) + OIL_PRESSURE_OFFSET;
-
   // Check for high temperature
-  if (engineTemp > MAX_COOLANT_TEMP) {
+  if (sensors.engineTemp > MAX_COOLANT_TEMP) {
     g_systemState.currentState = HIGH_TEMPERATURE;
     handleError("Engine temperature too high!");
   }
 
-  // Check for low oil pressure
-  if (oilPressure < MIN_OIL_PRESSURE) {
+  // Check for low oil pressure (P/N 6969775 is a switch, open = low pressure)
+  if (!sensors.oilPressureOk) {
     g_systemState.currentState = LOW_OIL_PRESSURE;
     handleError("Oil pressure too low!");
   }
 }
 
 void handleError(const char* errorMessage) {
-  Serial.print("ALERT: ");
-  Serial.println(errorMessage);
+  LOG_ERROR("ALERT: %s", errorMessage);
   
   // Don't shut down the engine, just set alert state
   // The engine must be manually shut down with the lever
 }
 
 void overrideStart() {
-    Serial.println("OVERRIDE: Bypassing safety checks and starting engine!");
+    LOG_WARN("OVERRIDE: Bypassing safety checks and starting engine!");
     
     // Make sure main power is on
     controlMainPower(true);
     
     // Set state and start cranking
     g_systemState.currentState = START;
-    g_systemState.ignitionStartTime = millis();
+    g_systemState.ignitionStartTime = halMillis();
     g_systemState.keyStartHeld = true;
     g_systemState.keyPosition = 3;
-    g_systemState.startHoldTime = millis();
+    g_systemState.startHoldTime = halMillis();
     controlStarter(true);
     
-    Serial.println("OVERRIDE: Starter engaged");
+    LOG_WARN("OVERRIDE: Starter engaged");
 }
@@ -0,0 +1,139 @@
+/*
+ * Sensor Sampling Implementation for Bobcat Ignition Controller
+ * Reads every channel at SENSOR_SAMPLE_INTERVAL and publishes a SensorSnapshot
+ */
+
+#include "sensors.h"
+#include "config.h"
+#include "hal.h"
+#include "hardware.h"
+#include "snapshot_publisher.h"
+#include "control_scheduler.h"
+#include "task_monitor.h"
+#ifdef ARDUINO
+#include "adc_dma.h"
+#endif
+
+static SnapshotPublisher<SensorSnapshot> sensorPublisher;
+static uint32_t sampleSequence = 0;
+static uint8_t lastInputs = 0;   // Digital inputs of the last sample, one bit each
+
+// Only ever called from the sampling task (or setup() before it starts),
+// so the temperature filter in hardware.cpp advances at a fixed rate.
+void sampleSensors() {
+  SensorSnapshot snapshot = {};
+
+#ifdef ARDUINO
+  if (isAdcDmaRunning()) {
+    // Decimated average of the continuous conversions - no blocking ADC reads
+    snapshot.batteryRaw = adcAverage(ADC_CH_BATTERY, ADC_DMA_AVERAGE_SAMPLES);
+    snapshot.temperatureRaw = adcAverage(ADC_CH_ENGINE_TEMP, ADC_DMA_AVERAGE_SAMPLES);
+    snapshot.pressureRaw = adcAverage(ADC_CH_OIL_PRESSURE, ADC_DMA_AVERAGE_SAMPLES);
+    snapshot.fuelRaw = adcAverage(ADC_CH_FUEL_LEVEL, ADC_DMA_AVERAGE_SAMPLES);
+    snapshot.hydraulicRaw = adcAverage(ADC_CH_HYD_PRESSURE, ADC_DMA_AVERAGE_SAMPLES);
+  } else
+#endif
+  {
+    snapshot.batteryRaw = halAnalogRead(BATTERY_VOLTAGE_PIN);
+    snapshot.temperatureRaw = halAnalogRead(ENGINE_TEMP_PIN);
+    snapshot.pressureRaw = halAnalogRead(OIL_PRESSURE_PIN);
+    snapshot.fuelRaw = halAnalogRead(FUEL_LEVEL_PIN);
+    snapshot.hydraulicRaw = halAnalogRead(HYD_PRESSURE_PIN);
+  }
+
+  const CalibrationConstants calibration = getCalibration();
+  snapshot.batteryVoltage = convertBatteryVoltage(snapshot.batteryRaw, calibration);
+  snapshot.engineTemp = convertEngineTemp(snapshot.temperatureRaw, calibration);
+  snapshot.fuelLevel = convertFuelLevel(snapshot.fuelRaw, calibration);
+
+  snapshot.oilPressureOk = readOilPressureSwitch();
+  snapshot.hydPressureOk = readHydraulicPressureSwitch();
+  snapshot.alternatorCharging = readAlternatorCharge();
+  snapshot.engineRunning = readEngineRunFeedback();
+  snapshot.seatBarEngaged = readSeatBarSafety();
+  snapshot.inNeutral = readNeutralSafety();
+
+  snapshot.sequence = ++sampleSequence;
+  snapshot.timestampMs = halMillis();
+  sensorPublisher.publish(snapshot);
+
+  // The interlocks and safety checks act on the switches: a change wakes
+  // the control loop now instead of at the next housekeeping deadline
+  uint8_t inputs = snapshot.oilPressureOk | snapshot.hydPressureOk << 1 | snapshot.alternatorCharging << 2 |
+                   snapshot.engineRunning << 3 | snapshot.seatBarEngaged << 4 | snapshot.inNeutral << 5;
+  if (inputs != lastInputs) {
+    lastInputs = inputs;
+    wakeControlLoop();
+  }
+}
+
+#ifdef ARDUINO
+static TaskHandle_t sensorTaskHandle = nullptr;
+static volatile bool stopRequested = false;
+static volatile bool taskStopped = false;
+
+static void sensorTask(void* parameter) {
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SENSOR_SAMPLE_INTERVAL));
+    if (stopRequested) {
+      break;   // Never in the middle of an ADC read
+    }
+    uint32_t started = halMicros();
+    sampleSensors();
+    noteTaskBusy(TASK_SENSORS, halMicros() - started);
+  }
+  taskStopped = true;
+  vTaskDelete(nullptr);
+}
+
+void startSensorSampling() {
+  if (sensorTaskHandle != nullptr) {
+    return;
+  }
+
+  // Continuous ADC feeds the rings; without it we fall back to analogRead()
+  if (startAdcDma()) {
+    delay(ADC_DMA_AVERAGE_SAMPLES * ADC_CHANNEL_COUNT * 1000 / ADC_DMA_SAMPLE_RATE + 1);
+  }
+
+  // Publish one sample before anything can ask for it
+  sampleSensors();
+
+  xTaskCreatePinnedToCore(sensorTask, "sensors", SENSOR_TASK_STACK_SIZE, nullptr,
+                          SENSOR_TASK_PRIORITY, &sensorTaskHandle, CONTROL_CORE);
+
+  Serial.print("Sensor sampling task started (");
+  Serial.print(SENSOR_SAMPLE_INTERVAL);
+  Serial.println(" ms period)");
+}
+
+void stopSensorSampling() {
+  if (sensorTaskHandle == nullptr) {
+    return;
+  }
+  stopRequested = true;
+  while (!taskStopped) {
+    vTaskDelay(1);   // At most one sample period
+  }
+  sensorTaskHandle = nullptr;
+  stopAdcDma();
+}
+#else
+// Host builds have no sampling task: the runner calls sampleSensors() on its
+// virtual clock
+void startSensorSampling() {
+  sampleSensors();
+}
+
+void stopSensorSampling() {}
+#endif
+
+SensorSnapshot getSensorSnapshot() {
+  return sensorPublisher.read();
+}
+
+void publishSensorSnapshot(const SensorSnapshot& snapshot) {
+  sampleSequence = snapshot.sequence;
+  sensorPublisher.publish(snapshot);
+}
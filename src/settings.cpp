@@ -4,23 +4,45 @@
  */
 
 #include "settings.h"
-#include <esp32-hal-log.h>
+#include "settings_format.h"
+#include "boot_profile.h"
+#include "config.h"
 #include <string.h>
 
 // Global settings manager instance
 SettingsManager g_settingsManager;
 
-SettingsManager::SettingsManager() {
+#ifdef ARDUINO
+static TaskHandle_t commitTask = nullptr;
+
+// flashStats is written by the web server and commit tasks, read by both
+// and by saveResumeState()
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+#define STATS_LOCK() portENTER_CRITICAL(&statsMux)
+#define STATS_UNLOCK() portEXIT_CRITICAL(&statsMux)
+#else
+#define STATS_LOCK()
+#define STATS_UNLOCK()
+#endif
+
+SettingsManager::SettingsManager() : dirty(false), lastChangeMs(0), flashStats() {
     // Initialize with default settings
     setDefaultSettings();
 }
 
-bool SettingsManager::begin() {
+bool SettingsManager::begin(bool loadFromStorage) {
+    startBootPhase(BOOT_PHASE_SETTINGS);
     // Initialize Preferences library
     if (!prefs.begin("bobcat", false)) {
         Serial.println("ERROR: Failed to initialize settings storage");
+        endBootPhase(BOOT_PHASE_SETTINGS);
         return false;
     }
+    if (!loadFromStorage) {
+        Serial.println("Settings restored from RTC memory");
+        endBootPhase(BOOT_PHASE_SETTINGS);
+        return true;
+    }
     
     // Load settings from storage or use defaults
     if (!loadSettings()) {
@@ -28,353 +50,215 @@ bool SettingsManager::begin() {
         setDefaultSettings();
         saveSettings(); // Save defaults to storage
     }
+    endBootPhase(BOOT_PHASE_SETTINGS);
     
+    startBootPhase(BOOT_PHASE_SETTINGS_PRINT);
     Serial.println("Settings Manager initialized successfully");
     printCurrentSettings();
+    endBootPhase(BOOT_PHASE_SETTINGS_PRINT);
     return true;
 }
 
 bool SettingsManager::loadSettings() {
-    size_t expectedSize = sizeof(BobcatSettings);
-    size_t actualSize = prefs.getBytesLength("settings");
-    
-    if (actualSize != expectedSize) {
-        Serial.printf("Settings size mismatch: expected %d, got %d\n", expectedSize, actualSize);
+    size_t length = prefs.getBytesLength("settings");
+    if (length == 0 || length > SETTINGS_BLOB_MAX) {
+        Serial.printf("No usable settings in storage (%u bytes)\n", (unsigned)length);
         return false;
     }
     
-    // Load settings from storage
-    size_t bytesRead = prefs.getBytes("settings", &currentSettings, expectedSize);
-    if (bytesRead != expectedSize) {
+    // Load settings from storage into a scratch copy; readers keep the
+    // published snapshot until this one has been checked
+    uint8_t blob[SETTINGS_BLOB_MAX];
+    if (prefs.getBytes("settings", blob, length) != length) {
         Serial.println("Failed to read settings from storage");
         return false;
     }
     
-    // Validate settings version and checksum
-    if (currentSettings.settingsVersion != SETTINGS_VERSION) {
-        Serial.printf("Settings version mismatch: expected %d, got %d\n", 
-                     SETTINGS_VERSION, currentSettings.settingsVersion);
-        return false;
-    }
-    
-    if (!validateChecksum(currentSettings)) {
-        Serial.println("Settings checksum validation failed - data may be corrupt");
+    // Fields the stored layout does not have keep their defaults
+    BobcatSettings loaded;
+    settingsDefaults(loaded);
+    uint16_t fromVersion = 0;
+    SettingsDecodeResult result = decodeSettings(blob, length, loaded, &fromVersion);
+    if (result == SETTINGS_CORRUPT || result == SETTINGS_UNKNOWN) {
+        Serial.printf("Settings in storage rejected: %s (format v%u)\n",
+                     settingsDecodeResultName(result), (unsigned)fromVersion);
         return false;
     }
     
     // Validate settings values
-    if (!validateSettings(currentSettings)) {
+    if (!validateSettings(loaded)) {
         Serial.println("Settings validation failed - using defaults");
         return false;
     }
     
+    currentSettings = loaded;
+    publish();
+    if (result == SETTINGS_MIGRATED) {
+        Serial.printf("Settings migrated from format v%u to v%u\n", (unsigned)fromVersion, (unsigned)SETTINGS_FORMAT_VERSION);
+        saveSettings();
+    }
     Serial.println("Settings loaded successfully from storage");
     return true;
 }
 
 bool SettingsManager::saveSettings() {
-    // Update checksum before saving
-    currentSettings.settingsVersion = SETTINGS_VERSION;
-    currentSettings.checksum = calculateChecksum(currentSettings);
+    dirty.store(false, std::memory_order_release);
+    return writeSettings();
+}
+
+bool SettingsManager::writeSettings() {
+    uint32_t start = halMicros();
+
+    // Runs on the commit task: encode the published snapshot, so the
+    // writer's working copy is never touched from here
+    uint8_t blob[SETTINGS_BLOB_MAX];
+    size_t length = encodeSettings(getSettings(), blob, sizeof(blob));
     
     // Save to preferences
-    size_t bytesWritten = prefs.putBytes("settings", &currentSettings, sizeof(BobcatSettings));
-    if (bytesWritten != sizeof(BobcatSettings)) {
+    size_t bytesWritten = length > 0 ? prefs.putBytes("settings", blob, length) : 0;
+    if (bytesWritten != length || length == 0) {
         Serial.println("ERROR: Failed to save settings to storage");
         return false;
     }
-    
-    Serial.println("Settings saved successfully to storage");
-    return true;
-}
 
-bool SettingsManager::resetToDefaults() {
-    Serial.println("Resetting settings to factory defaults");
-    setDefaultSettings();
-    return saveSettings();
-}
-
-void SettingsManager::setDefaultSettings() {
-    // Engine Parameters (convert seconds to milliseconds)
-    currentSettings.glowPlugDuration = 20000;      // 20 seconds
-    currentSettings.crankingTimeout = 10000;       // 10 seconds
-    currentSettings.cooldownDuration = 120000;     // 2 minutes
-    
-    // Alarm Thresholds
-    currentSettings.maxCoolantTemp = 104;          // °C
-    currentSettings.minOilPressure = 69;           // kPa (~0.7 bar)
-    currentSettings.minHydPressure = 0;            // disabled by default
-    currentSettings.minBatteryVoltage = 11.0f;     // V
-    currentSettings.maxBatteryVoltage = 15.0f;     // V
-    
-    // WiFi Configuration
-    strcpy(currentSettings.wifiSSID, "Bobcat-743");
-    strcpy(currentSettings.wifiPassword, "bobcat123");
-    
-    // Sensor Calibration
-    // Note: Temperature uses inverted NTC formula (150 - ADC*scale), no offset needed
-    currentSettings.pressureScale = 0.1682f;       // kPa per ADC unit
-    currentSettings.hydPressureScale = 0.1682f;    // default similar to oil until calibrated
-    currentSettings.fuelLevelEmpty = 200;          // ADC value
-    currentSettings.fuelLevelFull = 3800;          // ADC value
-    currentSettings.fuelLevelLowThreshold = 15;    // % for low fuel warning
-    
-    // System metadata
-    currentSettings.settingsVersion = SETTINGS_VERSION;
-    currentSettings.checksum = 0; // Will be calculated when saving
+    uint32_t commitUs = halMicros() - start;
+    STATS_LOCK();
+    flashStats.settingsCommits++;
+    flashStats.lastCommitUs = commitUs;
+    if (commitUs > flashStats.maxCommitUs) {
+        flashStats.maxCommitUs = commitUs;
+    }
+    STATS_UNLOCK();
+    Serial.printf("Settings saved successfully to storage (%u us)\n", (unsigned)commitUs);
+    return true;
 }
 
-bool SettingsManager::updateEngineSettings(uint32_t glowDuration, uint32_t crankTimeout, uint32_t cooldown) {
-    // Convert from seconds to milliseconds and validate
-    uint32_t glowMs = glowDuration * 1000;
-    uint32_t crankMs = crankTimeout * 1000;
-    uint32_t cooldownMs = cooldown * 1000;
-    
-    if (glowDuration < SettingsLimits::MIN_GLOW_DURATION || 
-        glowDuration > SettingsLimits::MAX_GLOW_DURATION) {
-        Serial.printf("Invalid glow duration: %d (must be %d-%d seconds)\n", 
-                     glowDuration, SettingsLimits::MIN_GLOW_DURATION, SettingsLimits::MAX_GLOW_DURATION);
+bool SettingsManager::applySettings(const BobcatSettings& candidate) {
+    if (!validateSettings(candidate)) {
+        Serial.println("Settings batch rejected - a value is out of range");
         return false;
     }
-    
-    if (crankTimeout < SettingsLimits::MIN_CRANKING_TIMEOUT || 
-        crankTimeout > SettingsLimits::MAX_CRANKING_TIMEOUT) {
-        Serial.printf("Invalid cranking timeout: %d (must be %d-%d seconds)\n", 
-                     crankTimeout, SettingsLimits::MIN_CRANKING_TIMEOUT, SettingsLimits::MAX_CRANKING_TIMEOUT);
-        return false;
+    if (memcmp(&candidate, &currentSettings, sizeof(BobcatSettings)) == 0) {
+        return true;   // Nothing changed, nothing to write
     }
-    
-    if (cooldown < SettingsLimits::MIN_COOLDOWN_DURATION || 
-        cooldown > SettingsLimits::MAX_COOLDOWN_DURATION) {
-        Serial.printf("Invalid cooldown duration: %d (must be %d-%d seconds)\n", 
-                     cooldown, SettingsLimits::MIN_COOLDOWN_DURATION, SettingsLimits::MAX_COOLDOWN_DURATION);
-        return false;
+    char oldValue[72];
+    char newValue[72];
+    for (const SettingDescriptor& setting : SETTINGS) {
+        if (settingChanged(currentSettings, candidate, setting)) {
+            formatSetting(oldValue, sizeof(oldValue), currentSettings, setting);
+            formatSetting(newValue, sizeof(newValue), candidate, setting);
+            logSettingsChange(setting.name, oldValue, newValue);
+        }
     }
-    
-    // Log changes
-    char oldVal[64], newVal[64];
-    sprintf(oldVal, "%d/%d/%d", currentSettings.glowPlugDuration/1000, 
-            currentSettings.crankingTimeout/1000, currentSettings.cooldownDuration/1000);
-    sprintf(newVal, "%d/%d/%d", glowDuration, crankTimeout, cooldown);
-    logSettingsChange("Engine Timing", oldVal, newVal);
-    
-    // Update settings
-    currentSettings.glowPlugDuration = glowMs;
-    currentSettings.crankingTimeout = crankMs;
-    currentSettings.cooldownDuration = cooldownMs;
-    
+    Serial.printf("SETTINGS: batch applied, written after %lu ms without further changes\n", SETTINGS_COMMIT_DELAY);
+    currentSettings = candidate;
+    markDirty();
     return true;
 }
 
-bool SettingsManager::updateAlarmThresholds(int16_t maxTemp, int16_t minPressure, float minVolt, float maxVolt) {
-    // Validate thresholds
-    if (maxTemp < SettingsLimits::MIN_COOLANT_TEMP || maxTemp > SettingsLimits::MAX_COOLANT_TEMP) {
-        Serial.printf("Invalid max temperature: %d (must be %d-%d°C)\n", 
-                     maxTemp, SettingsLimits::MIN_COOLANT_TEMP, SettingsLimits::MAX_COOLANT_TEMP);
-        return false;
+void SettingsManager::markDirty() {
+    publish();
+    lastChangeMs.store(halMillis(), std::memory_order_relaxed);
+    if (dirty.exchange(true, std::memory_order_acq_rel)) {
+        STATS_LOCK();
+        flashStats.coalescedChanges++;
+        STATS_UNLOCK();
     }
-    
-    if (minPressure < SettingsLimits::MIN_OIL_PRESSURE_LIMIT || 
-        minPressure > SettingsLimits::MAX_OIL_PRESSURE_LIMIT) {
-        Serial.printf("Invalid min oil pressure: %d (must be %d-%d kPa)\n", 
-                     minPressure, SettingsLimits::MIN_OIL_PRESSURE_LIMIT, SettingsLimits::MAX_OIL_PRESSURE_LIMIT);
-        return false;
-    }
-    
-    if (minVolt < SettingsLimits::MIN_BATTERY_VOLTAGE_LIMIT || 
-        minVolt > SettingsLimits::MAX_BATTERY_VOLTAGE_LIMIT) {
-        Serial.printf("Invalid min battery voltage: %.1f (must be %.1f-%.1fV)\n", 
-                     minVolt, SettingsLimits::MIN_BATTERY_VOLTAGE_LIMIT, SettingsLimits::MAX_BATTERY_VOLTAGE_LIMIT);
-        return false;
+#ifdef ARDUINO
+    if (commitTask != nullptr) {
+        xTaskNotifyGive(commitTask);
     }
-    
-    if (maxVolt < SettingsLimits::MIN_BATTERY_VOLTAGE_LIMIT || 
-        maxVolt > SettingsLimits::MAX_BATTERY_VOLTAGE_LIMIT || maxVolt <= minVolt) {
-        Serial.printf("Invalid max battery voltage: %.1f (must be %.1f-%.1fV and > min voltage)\n", 
-                     maxVolt, SettingsLimits::MIN_BATTERY_VOLTAGE_LIMIT, SettingsLimits::MAX_BATTERY_VOLTAGE_LIMIT);
-        return false;
-    }
-    
-    // Log changes
-    char oldVal[64], newVal[64];
-    sprintf(oldVal, "T:%d P:%d V:%.1f-%.1f", currentSettings.maxCoolantTemp, 
-            currentSettings.minOilPressure, currentSettings.minBatteryVoltage, currentSettings.maxBatteryVoltage);
-    sprintf(newVal, "T:%d P:%d V:%.1f-%.1f", maxTemp, minPressure, minVolt, maxVolt);
-    logSettingsChange("Alarm Thresholds", oldVal, newVal);
-    
-    // Update settings
-    currentSettings.maxCoolantTemp = maxTemp;
-    currentSettings.minOilPressure = minPressure;
-    currentSettings.minBatteryVoltage = minVolt;
-    currentSettings.maxBatteryVoltage = maxVolt;
-    
-    return true;
+#endif
 }
 
-bool SettingsManager::updateWifiSettings(const char* ssid, const char* password) {
-    if (!ssid || strlen(ssid) < SettingsLimits::MIN_SSID_LENGTH || 
-        strlen(ssid) > SettingsLimits::MAX_SSID_LENGTH) {
-        Serial.printf("Invalid SSID length: %d (must be %d-%d characters)\n", 
-                     ssid ? strlen(ssid) : 0, SettingsLimits::MIN_SSID_LENGTH, SettingsLimits::MAX_SSID_LENGTH);
-        return false;
-    }
-    
-    if (password && strlen(password) > 0 && 
-        (strlen(password) < SettingsLimits::MIN_PASSWORD_LENGTH || 
-         strlen(password) > SettingsLimits::MAX_PASSWORD_LENGTH)) {
-        Serial.printf("Invalid password length: %d (must be %d-%d characters or empty)\n", 
-                     strlen(password), SettingsLimits::MIN_PASSWORD_LENGTH, SettingsLimits::MAX_PASSWORD_LENGTH);
+FlashWriteStats SettingsManager::getFlashStats() const {
+    STATS_LOCK();
+    FlashWriteStats copy = flashStats;
+    STATS_UNLOCK();
+    return copy;
+}
+
+void SettingsManager::recordCalibrationWrites(uint32_t count) {
+    STATS_LOCK();
+    flashStats.calibrationWrites += count;
+    STATS_UNLOCK();
+}
+
+bool SettingsManager::commitIfQuiet(uint32_t now) {
+    if (!isDirty() || now - lastChangeMs.load(std::memory_order_relaxed) < SETTINGS_COMMIT_DELAY) {
         return false;
     }
-    
-    // Log changes (don't log passwords)
-    logSettingsChange("WiFi SSID", currentSettings.wifiSSID, ssid);
-    if (password && strlen(password) > 0) {
-        logSettingsChange("WiFi Password", "****", "****");
-    }
-    
-    // Update settings
-    strncpy(currentSettings.wifiSSID, ssid, sizeof(currentSettings.wifiSSID) - 1);
-    currentSettings.wifiSSID[sizeof(currentSettings.wifiSSID) - 1] = '\0';
-    
-    if (password) {
-        strncpy(currentSettings.wifiPassword, password, sizeof(currentSettings.wifiPassword) - 1);
-        currentSettings.wifiPassword[sizeof(currentSettings.wifiPassword) - 1] = '\0';
-    }
-    
-    return true;
+    return flush();
 }
 
-bool SettingsManager::updateSensorCalibration(float tempOffset, float pressScale, uint16_t fuelEmpty, uint16_t fuelFull, uint8_t fuelLowThreshold) {
-    // Validate sensor calibration values
-    // Note: tempOffset is kept for compatibility but not used in current formula
-    if (tempOffset < SettingsLimits::MIN_TEMP_OFFSET || tempOffset > SettingsLimits::MAX_TEMP_OFFSET) {
-        Serial.printf("Invalid temperature offset: %.1f (must be %.1f-%.1f°C) [UNUSED]\n", 
-                     tempOffset, SettingsLimits::MIN_TEMP_OFFSET, SettingsLimits::MAX_TEMP_OFFSET);
+bool SettingsManager::flush() {
+    // Cleared before the copy is taken: a change made during the write
+    // marks the settings dirty again and gets its own commit
+    if (!dirty.exchange(false, std::memory_order_acq_rel)) {
         return false;
     }
-    
-    if (pressScale < SettingsLimits::MIN_PRESSURE_SCALE || pressScale > SettingsLimits::MAX_PRESSURE_SCALE) {
-        Serial.printf("Invalid pressure scale: %.3f (must be %.3f-%.3f)\n", 
-                     pressScale, SettingsLimits::MIN_PRESSURE_SCALE, SettingsLimits::MAX_PRESSURE_SCALE);
-        return false;
+    return writeSettings();
+}
+
+#ifdef ARDUINO
+static void commitLoop(void*) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);   // First change of a burst
+        while (g_settingsManager.isDirty()) {
+            vTaskDelay(pdMS_TO_TICKS(SETTINGS_COMMIT_DELAY / 4));
+            g_settingsManager.commitIfQuiet(halMillis());
+        }
     }
-    
-    if (fuelEmpty >= fuelFull || fuelEmpty > SettingsLimits::MAX_FUEL_ADC || fuelFull > SettingsLimits::MAX_FUEL_ADC) {
-        Serial.printf("Invalid fuel levels: empty=%d, full=%d (empty must be < full, both 0-%d)\n", 
-                     fuelEmpty, fuelFull, SettingsLimits::MAX_FUEL_ADC);
-        return false;
+}
+
+void SettingsManager::startCommitTask() {
+    if (commitTask != nullptr) {
+        return;
     }
-    
-    if (fuelLowThreshold > 100) {
-        Serial.printf("Invalid fuel low threshold: %d%% (must be 0-100%%)\n", fuelLowThreshold);
-        return false;
+    xTaskCreatePinnedToCore(commitLoop, "settings", SETTINGS_TASK_STACK_SIZE, nullptr,
+                            SETTINGS_TASK_PRIORITY, &commitTask, NETWORK_CORE);
+    if (isDirty()) {
+        xTaskNotifyGive(commitTask);
     }
-    
-    // Log changes
-    char oldVal[80], newVal[80];
-    sprintf(oldVal, "TO:%.1f PS:%.3f HPS:%.3f FE:%d FF:%d FL:%d%%", currentSettings.tempSensorOffset, 
-        currentSettings.pressureScale, currentSettings.hydPressureScale, currentSettings.fuelLevelEmpty, currentSettings.fuelLevelFull, currentSettings.fuelLevelLowThreshold);
-    sprintf(newVal, "TO:%.1f PS:%.3f HPS:%.3f FE:%d FF:%d FL:%d%%", tempOffset, pressScale, currentSettings.hydPressureScale, fuelEmpty, fuelFull, fuelLowThreshold);
-    logSettingsChange("Sensor Calibration", oldVal, newVal);
-    
-    // Update settings
-    currentSettings.tempSensorOffset = tempOffset;
-    currentSettings.pressureScale = pressScale;
-    currentSettings.fuelLevelEmpty = fuelEmpty;
-    currentSettings.fuelLevelFull = fuelFull;
-    currentSettings.fuelLevelLowThreshold = fuelLowThreshold;
-    
-    return true;
 }
+#else
+void SettingsManager::startCommitTask() {}
+#endif
 
-bool SettingsManager::validateSettings(const BobcatSettings& settings) {
-    // Validate all settings ranges
-    if (settings.glowPlugDuration < SettingsLimits::MIN_GLOW_DURATION * 1000 || 
-        settings.glowPlugDuration > SettingsLimits::MAX_GLOW_DURATION * 1000) return false;
-    
-    if (settings.crankingTimeout < SettingsLimits::MIN_CRANKING_TIMEOUT * 1000 || 
-        settings.crankingTimeout > SettingsLimits::MAX_CRANKING_TIMEOUT * 1000) return false;
-    
-    if (settings.cooldownDuration < SettingsLimits::MIN_COOLDOWN_DURATION * 1000 || 
-        settings.cooldownDuration > SettingsLimits::MAX_COOLDOWN_DURATION * 1000) return false;
-    
-    if (settings.maxCoolantTemp < SettingsLimits::MIN_COOLANT_TEMP || 
-        settings.maxCoolantTemp > SettingsLimits::MAX_COOLANT_TEMP) return false;
-    
-    if (settings.minOilPressure < SettingsLimits::MIN_OIL_PRESSURE_LIMIT || 
-        settings.minOilPressure > SettingsLimits::MAX_OIL_PRESSURE_LIMIT) return false;
-    
-    if (settings.minBatteryVoltage < SettingsLimits::MIN_BATTERY_VOLTAGE_LIMIT || 
-        settings.minBatteryVoltage > SettingsLimits::MAX_BATTERY_VOLTAGE_LIMIT) return false;
-    
-    if (settings.maxBatteryVoltage < SettingsLimits::MIN_BATTERY_VOLTAGE_LIMIT || 
-        settings.maxBatteryVoltage > SettingsLimits::MAX_BATTERY_VOLTAGE_LIMIT || 
-        settings.maxBatteryVoltage <= settings.minBatteryVoltage) return false;
-    
-    // Validate WiFi settings
-    if (strlen(settings.wifiSSID) < SettingsLimits::MIN_SSID_LENGTH || 
-        strlen(settings.wifiSSID) > SettingsLimits::MAX_SSID_LENGTH) return false;
-    
-    // Validate sensor calibration
-    if (settings.tempSensorOffset < SettingsLimits::MIN_TEMP_OFFSET || 
-        settings.tempSensorOffset > SettingsLimits::MAX_TEMP_OFFSET) return false;
-    
-    if (settings.pressureScale < SettingsLimits::MIN_PRESSURE_SCALE || 
-        settings.pressureScale > SettingsLimits::MAX_PRESSURE_SCALE) return false;
-    
-    if (settings.fuelLevelEmpty >= settings.fuelLevelFull || 
-        settings.fuelLevelEmpty > SettingsLimits::MAX_FUEL_ADC || 
-        settings.fuelLevelFull > SettingsLimits::MAX_FUEL_ADC) return false;
-    if (settings.minHydPressure < SettingsLimits::MIN_HYD_PRESSURE_LIMIT || settings.minHydPressure > SettingsLimits::MAX_HYD_PRESSURE_LIMIT) return false;
-    if (settings.hydPressureScale < SettingsLimits::MIN_HYD_PRESSURE_SCALE || settings.hydPressureScale > SettingsLimits::MAX_HYD_PRESSURE_SCALE) return false;
-    
-    return true;
+bool SettingsManager::resetToDefaults() {
+    Serial.println("Resetting settings to factory defaults");
+    setDefaultSettings();
+    return saveSettings();
 }
 
-bool SettingsManager::updateHydraulicThreshold(int16_t minHydPressure) {
-    if (minHydPressure < SettingsLimits::MIN_HYD_PRESSURE_LIMIT || minHydPressure > SettingsLimits::MAX_HYD_PRESSURE_LIMIT) {
-        Serial.printf("Invalid min hydraulic pressure: %d (must be %d-%d kPa)\n", minHydPressure, SettingsLimits::MIN_HYD_PRESSURE_LIMIT, SettingsLimits::MAX_HYD_PRESSURE_LIMIT);
-        return false;
-    }
-    char oldVal[32], newVal[32];
-    sprintf(oldVal, "%d", currentSettings.minHydPressure);
-    sprintf(newVal, "%d", minHydPressure);
-    logSettingsChange("Hydraulic Threshold", oldVal, newVal);
-    currentSettings.minHydPressure = minHydPressure;
-    return true;
+void SettingsManager::restore(const BobcatSettings& settings, const FlashWriteStats& stats) {
+    currentSettings = settings;
+    STATS_LOCK();
+    flashStats = stats;
+    STATS_UNLOCK();
+    publish();
 }
 
-bool SettingsManager::updateHydraulicCalibration(float hydPressScale) {
-    if (hydPressScale < SettingsLimits::MIN_HYD_PRESSURE_SCALE || hydPressScale > SettingsLimits::MAX_HYD_PRESSURE_SCALE) {
-        Serial.printf("Invalid hydraulic pressure scale: %.3f (must be %.3f-%.3f)\n", hydPressScale, SettingsLimits::MIN_HYD_PRESSURE_SCALE, SettingsLimits::MAX_HYD_PRESSURE_SCALE);
-        return false;
-    }
-    char oldVal[32], newVal[32];
-    sprintf(oldVal, "%.3f", currentSettings.hydPressureScale);
-    sprintf(newVal, "%.3f", hydPressScale);
-    logSettingsChange("Hydraulic Pressure Scale", oldVal, newVal);
-    currentSettings.hydPressureScale = hydPressScale;
-    return true;
+void SettingsManager::setDefaultSettings() {
+    settingsDefaults(currentSettings);
+    publish();
 }
 
-uint32_t SettingsManager::calculateChecksum(const BobcatSettings& settings) {
-    uint32_t checksum = 0;
-    const uint8_t* data = reinterpret_cast<const uint8_t*>(&settings);
-    size_t size = sizeof(BobcatSettings) - sizeof(uint32_t); // Exclude checksum field itself
-    
-    // Simple XOR checksum
-    for (size_t i = 0; i < size; i++) {
-        checksum ^= data[i];
-        checksum = (checksum << 1) | (checksum >> 31); // Rotate left
+bool SettingsManager::validateSettings(const BobcatSettings& settings) {
+    // Validate all settings ranges (limits from the schema)
+    for (const SettingDescriptor& setting : SETTINGS) {
+        if (!settingInRange(settings, setting)) {
+            Serial.printf("Setting %s is out of range\n", setting.name);
+            return false;
+        }
     }
     
-    return checksum;
-}
-
-bool SettingsManager::validateChecksum(const BobcatSettings& settings) {
-    uint32_t calculatedChecksum = calculateChecksum(settings);
-    return calculatedChecksum == settings.checksum;
+    // Checks between fields
+    if (settings.maxBatteryVoltage <= settings.minBatteryVoltage) return false;
+    if (settings.fuelLevelEmpty >= settings.fuelLevelFull) return false;
+    if (settings.homeStaticIP[0] != '\0' && settings.homeGateway[0] == '\0') return false;
+    
+    return true;
 }
 
 bool SettingsManager::performFactoryReset() {
@@ -399,23 +283,11 @@ void SettingsManager::logSettingsChange(const char* parameter, const char* oldVa
 
 void SettingsManager::printCurrentSettings() {
     Serial.println("=== CURRENT SETTINGS ===");
-    Serial.printf("Engine - Glow: %ds, Crank: %ds, Cooldown: %ds\n", 
-                 currentSettings.glowPlugDuration/1000, 
-                 currentSettings.crankingTimeout/1000, 
-                 currentSettings.cooldownDuration/1000);
-    Serial.printf("Alarms - Max Temp: %d°C, Min Pressure: %dkPa, Voltage: %.1f-%.1fV\n", 
-                 currentSettings.maxCoolantTemp, 
-                 currentSettings.minOilPressure, 
-                 currentSettings.minBatteryVoltage, 
-                 currentSettings.maxBatteryVoltage);
-    Serial.printf("WiFi - SSID: %s\n", currentSettings.wifiSSID);
-    Serial.printf("Sensors - Temp Offset: %.1f°C, Pressure Scale: %.3f, Fuel: %d-%d\n", 
-                 currentSettings.tempSensorOffset, 
-                 currentSettings.pressureScale, 
-                 currentSettings.fuelLevelEmpty, 
-                 currentSettings.fuelLevelFull);
-    Serial.printf("Version: %d, Checksum: 0x%08X\n", 
-                 currentSettings.settingsVersion, 
-                 currentSettings.checksum);
+    char value[72];
+    for (const SettingDescriptor& setting : SETTINGS) {
+        formatSetting(value, sizeof(value), currentSettings, setting);
+        Serial.printf("%s: %s\n", setting.name, value);
+    }
+    Serial.printf("Storage format: v%u (tagged records, CRC32)\n", (unsigned)SETTINGS_FORMAT_VERSION);
     Serial.println("========================");
 }
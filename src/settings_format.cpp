@@ -0,0 +1,183 @@
+/*
+ * Settings Storage Format Implementation for Bobcat Ignition Controller
+ * Tagged records with a CRC32 header, and migration of older layouts
+ */
+
+#include "settings_format.h"
+#include "settings.h"
+#include "hal.h"
+#include <stddef.h>
+#include <string.h>
+
+// Largest blob encodeSettings() can produce
+constexpr size_t settingsBlobWorstCase() {
+    size_t size = sizeof(SettingsBlobHeader);
+    for (const SettingDescriptor& field : SETTINGS) {
+        size += 2 + (field.type == SETTING_TEXT ? field.size - 1 : field.size);
+    }
+    return size;
+}
+
+static_assert(settingsBlobWorstCase() <= SETTINGS_BLOB_MAX, "SETTINGS_BLOB_MAX too small for the schema");
+
+size_t encodeSettings(const BobcatSettings& settings, uint8_t* blob, size_t capacity) {
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(&settings);
+    size_t used = sizeof(SettingsBlobHeader);
+    if (capacity < used) {
+        return 0;
+    }
+
+    for (const SettingDescriptor& field : SETTINGS) {
+        const uint8_t* value = base + field.offset;
+        size_t size = field.type == SETTING_TEXT ? strnlen((const char*)value, field.size - 1) : field.size;
+        if (used + 2 + size > capacity) {
+            return 0;
+        }
+        blob[used++] = field.tag;
+        blob[used++] = (uint8_t)size;
+        memcpy(blob + used, value, size);
+        used += size;
+    }
+
+    SettingsBlobHeader header;
+    header.magic = SETTINGS_FORMAT_MAGIC;
+    header.version = SETTINGS_FORMAT_VERSION;
+    header.length = (uint16_t)(used - sizeof(SettingsBlobHeader));
+    header.crc = halCrc32(0, blob + sizeof(SettingsBlobHeader), header.length);
+    memcpy(blob, &header, sizeof(header));
+    return used;
+}
+
+static SettingsDecodeResult decodeRecords(const uint8_t* records, size_t length, BobcatSettings& settings) {
+    uint8_t* base = reinterpret_cast<uint8_t*>(&settings);
+    size_t pos = 0;
+    while (pos < length) {
+        if (pos + 2 > length || pos + 2 + records[pos + 1] > length) {
+            return SETTINGS_CORRUPT;
+        }
+        uint8_t tag = records[pos];
+        uint8_t size = records[pos + 1];
+        const uint8_t* value = records + pos + 2;
+        pos += 2 + size;
+
+        const SettingDescriptor* field = findSettingByTag(tag);
+        if (field == nullptr) {
+            continue;   // Written by a newer firmware
+        }
+        if (field->type == SETTING_TEXT) {
+            size_t n = size < field->size - 1 ? size : field->size - 1;
+            memcpy(base + field->offset, value, n);
+            base[field->offset + n] = '\0';
+        } else if (size == field->size) {
+            memcpy(base + field->offset, value, size);
+        }
+        // A numeric record of another width keeps the default
+    }
+    return SETTINGS_DECODED;
+}
+
+// ============================================================================
+// HISTORICAL LAYOUTS
+// ============================================================================
+uint32_t settingsChecksumV1(const BobcatSettingsV1& settings) {
+    uint32_t checksum = 0;
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(&settings);
+    size_t size = sizeof(BobcatSettingsV1) - sizeof(uint32_t); // Exclude checksum field itself
+
+    // Simple XOR checksum
+    for (size_t i = 0; i < size; i++) {
+        checksum ^= data[i];
+        checksum = (checksum << 1) | (checksum >> 31); // Rotate left
+    }
+
+    return checksum;
+}
+
+static bool migrateV1(const uint8_t* blob, BobcatSettings& settings) {
+    BobcatSettingsV1 v1;
+    memcpy(&v1, blob, sizeof(v1));
+    if (settingsChecksumV1(v1) != v1.checksum) {
+        return false;
+    }
+
+    settings.glowPlugDuration = v1.glowPlugDuration;
+    settings.crankingTimeout = v1.crankingTimeout;
+    settings.cooldownDuration = v1.cooldownDuration;
+    settings.maxCoolantTemp = v1.maxCoolantTemp;
+    settings.minOilPressure = v1.minOilPressure;
+    settings.minHydPressure = v1.minHydPressure;
+    settings.minBatteryVoltage = v1.minBatteryVoltage;
+    settings.maxBatteryVoltage = v1.maxBatteryVoltage;
+    memcpy(settings.wifiSSID, v1.wifiSSID, sizeof(settings.wifiSSID));
+    settings.wifiSSID[sizeof(settings.wifiSSID) - 1] = '\0';
+    memcpy(settings.wifiPassword, v1.wifiPassword, sizeof(settings.wifiPassword));
+    settings.wifiPassword[sizeof(settings.wifiPassword) - 1] = '\0';
+    settings.tempSensorOffset = v1.tempSensorOffset;
+    settings.pressureScale = v1.pressureScale;
+    settings.hydPressureScale = v1.hydPressureScale;
+    settings.fuelLevelEmpty = v1.fuelLevelEmpty;
+    settings.fuelLevelFull = v1.fuelLevelFull;
+    settings.fuelLevelLowThreshold = v1.fuelLevelLowThreshold;
+    return true;
+}
+
+// Raw-struct layouts, recognised by size and their version field
+struct LegacyLayout {
+    uint16_t version;
+    size_t size;
+    size_t versionOffset;
+    bool (*migrate)(const uint8_t* blob, BobcatSettings& settings);
+};
+
+static const LegacyLayout LEGACY_LAYOUTS[] = {
+    { 1, sizeof(BobcatSettingsV1), offsetof(BobcatSettingsV1, settingsVersion), migrateV1 },
+};
+
+SettingsDecodeResult decodeSettings(const uint8_t* blob, size_t length, BobcatSettings& settings, uint16_t* fromVersion) {
+    SettingsBlobHeader header;
+    if (length >= sizeof(header)) {
+        memcpy(&header, blob, sizeof(header));
+    } else {
+        header.magic = 0;
+    }
+
+    if (header.magic == SETTINGS_FORMAT_MAGIC) {
+        if (fromVersion != nullptr) {
+            *fromVersion = header.version;
+        }
+        if (header.version > SETTINGS_FORMAT_VERSION) {
+            return SETTINGS_UNKNOWN;
+        }
+        if (sizeof(header) + header.length > length ||
+            halCrc32(0, blob + sizeof(header), header.length) != header.crc) {
+            return SETTINGS_CORRUPT;
+        }
+        return decodeRecords(blob + sizeof(header), header.length, settings);
+    }
+
+    for (const LegacyLayout& layout : LEGACY_LAYOUTS) {
+        uint32_t version;
+        if (length != layout.size) {
+            continue;
+        }
+        memcpy(&version, blob + layout.versionOffset, sizeof(version));
+        if (version != layout.version) {
+            continue;
+        }
+        if (fromVersion != nullptr) {
+            *fromVersion = layout.version;
+        }
+        return layout.migrate(blob, settings) ? SETTINGS_MIGRATED : SETTINGS_CORRUPT;
+    }
+    return SETTINGS_UNKNOWN;
+}
+
+const char* settingsDecodeResultName(SettingsDecodeResult result) {
+    switch (result) {
+        case SETTINGS_DECODED: return "decoded";
+        case SETTINGS_MIGRATED: return "migrated";
+        case SETTINGS_CORRUPT: return "corrupt";
+        case SETTINGS_UNKNOWN: return "unknown layout";
+    }
+    return "?";
+}
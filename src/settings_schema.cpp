@@ -0,0 +1,156 @@
+/*
+ * Settings Schema Implementation for Bobcat Ignition Controller
+ * Typed access to BobcatSettings fields through their descriptors
+ */
+
+#include "settings_schema.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static uint8_t* field(BobcatSettings& settings, const SettingDescriptor& setting) {
+    return reinterpret_cast<uint8_t*>(&settings) + setting.offset;
+}
+
+static const uint8_t* field(const BobcatSettings& settings, const SettingDescriptor& setting) {
+    return reinterpret_cast<const uint8_t*>(&settings) + setting.offset;
+}
+
+template <typename T>
+static T load(const uint8_t* p) {
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+template <typename T>
+static void store(uint8_t* p, T value) {
+    memcpy(p, &value, sizeof(T));
+}
+
+// Stored units
+static float storedValue(const BobcatSettings& settings, const SettingDescriptor& setting) {
+    const uint8_t* p = field(settings, setting);
+    switch (setting.type) {
+        case SETTING_U8: return *p;
+        case SETTING_U16: return load<uint16_t>(p);
+        case SETTING_U32: return (float)load<uint32_t>(p);
+        case SETTING_I16: return load<int16_t>(p);
+        case SETTING_FLOAT: return load<float>(p);
+        case SETTING_TEXT: break;
+    }
+    return 0.0f;
+}
+
+static void storeValue(BobcatSettings& settings, const SettingDescriptor& setting, float stored) {
+    uint8_t* p = field(settings, setting);
+    switch (setting.type) {
+        case SETTING_U8: *p = (uint8_t)lroundf(stored); break;
+        case SETTING_U16: store<uint16_t>(p, (uint16_t)lroundf(stored)); break;
+        case SETTING_U32: store<uint32_t>(p, (uint32_t)llroundf(stored)); break;
+        case SETTING_I16: store<int16_t>(p, (int16_t)lroundf(stored)); break;
+        case SETTING_FLOAT: store<float>(p, stored); break;
+        case SETTING_TEXT: break;
+    }
+}
+
+void settingsDefaults(BobcatSettings& settings) {
+    memset(&settings, 0, sizeof(settings));
+    for (const SettingDescriptor& setting : SETTINGS) {
+        if (setting.type == SETTING_TEXT) {
+            strncpy((char*)field(settings, setting), setting.defaultText, setting.size - 1);
+        } else {
+            storeValue(settings, setting, setting.defaultValue * setting.scale);
+        }
+    }
+}
+
+float settingValue(const BobcatSettings& settings, const SettingDescriptor& setting) {
+    return storedValue(settings, setting) / setting.scale;
+}
+
+const char* settingText(const BobcatSettings& settings, const SettingDescriptor& setting) {
+    return setting.type == SETTING_TEXT ? (const char*)field(settings, setting) : "";
+}
+
+bool setSettingValue(BobcatSettings& settings, const SettingDescriptor& setting, float value) {
+    if (setting.type == SETTING_TEXT || !(value >= setting.minimum && value <= setting.maximum)) {
+        return false;   // Also rejects NaN
+    }
+    storeValue(settings, setting, value * setting.scale);
+    return true;
+}
+
+bool parseIPv4(const char* text, uint8_t octets[4]) {
+    for (uint8_t i = 0; i < 4; i++) {
+        unsigned value = 0;
+        uint8_t digits = 0;
+        while (*text >= '0' && *text <= '9' && digits < 3) {
+            value = value * 10 + (unsigned)(*text++ - '0');
+            digits++;
+        }
+        if (digits == 0 || value > 255 || *text != (i < 3 ? '.' : '\0')) {
+            return false;
+        }
+        octets[i] = (uint8_t)value;
+        text++;
+    }
+    return true;
+}
+
+static bool textValid(const SettingDescriptor& setting, const char* text, size_t length) {
+    if (length == 0 && (setting.flags & SETTING_OPTIONAL)) {
+        return true;
+    }
+    if (setting.flags & SETTING_IPV4) {
+        uint8_t octets[4];
+        return parseIPv4(text, octets);
+    }
+    return length >= setting.minLength;
+}
+
+bool setSettingText(BobcatSettings& settings, const SettingDescriptor& setting, const char* text) {
+    if (setting.type != SETTING_TEXT) {
+        return false;
+    }
+    size_t length = text ? strlen(text) : 0;
+    if (length == 0 && (setting.flags & SETTING_SECRET)) {
+        return true;   // Keep the stored secret
+    }
+    if (length >= setting.size || !textValid(setting, text ? text : "", length)) {
+        return false;
+    }
+    char* target = (char*)field(settings, setting);
+    memset(target, 0, setting.size);
+    memcpy(target, text ? text : "", length);
+    return true;
+}
+
+bool settingInRange(const BobcatSettings& settings, const SettingDescriptor& setting) {
+    if (setting.type == SETTING_TEXT) {
+        size_t length = strnlen(settingText(settings, setting), setting.size);
+        if (length == setting.size) {
+            return false;   // No terminator
+        }
+        return textValid(setting, settingText(settings, setting), length);
+    }
+    float value = settingValue(settings, setting);
+    return value >= setting.minimum && value <= setting.maximum;
+}
+
+bool settingChanged(const BobcatSettings& a, const BobcatSettings& b, const SettingDescriptor& setting) {
+    if (setting.type == SETTING_TEXT) {
+        return strncmp(settingText(a, setting), settingText(b, setting), setting.size) != 0;
+    }
+    return memcmp(field(a, setting), field(b, setting), setting.size) != 0;
+}
+
+void formatSetting(char* buffer, size_t size, const BobcatSettings& settings, const SettingDescriptor& setting) {
+    if (setting.flags & SETTING_SECRET) {
+        snprintf(buffer, size, "****");
+    } else if (setting.type == SETTING_TEXT) {
+        snprintf(buffer, size, "%s", settingText(settings, setting));
+    } else {
+        snprintf(buffer, size, "%.*f %s", setting.decimals, settingValue(settings, setting), setting.unit);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * Deep Sleep Implementation for Bobcat Ignition Controller
+ * ESP32 sleep entry and wake-up handling (not part of the host build)
+ */
+
+#include "hardware.h"
+#include "config.h"
+#include "system_state.h"
+#include "logger.h"
+#include "resume_state.h"
+#include "sensors.h"
+#include "ulp_monitor.h"
+
+void initializeSleepMode() {
+  Serial.println("Initializing deep sleep mode...");
+  
+  // Configure wake-up button
+  pinMode(WAKE_UP_BUTTON_PIN, INPUT_PULLUP);
+  pinMode(SLEEP_ENABLE_PIN, INPUT_PULLUP);
+  
+  // Configure wake-up sources
+  esp_sleep_enable_ext0_wakeup(GPIO_NUM_0, 0); // Wake on button press (LOW)
+  
+  // Initialize sleep-related state
+  g_systemState.lastActivityTime = millis();
+  g_systemState.sleepModeEnabled = true;
+  g_systemState.wakeUpPending = false;
+  g_systemState.sleepTimer = millis();
+  
+  Serial.println("Deep sleep mode initialized - Wake up button: GPIO0");
+}
+
+void enterDeepSleep() {
+  Serial.println("Preparing for deep sleep...");
+  
+  // Prepare system for sleep
+  prepareForSleep();
+
+  // ADC1 and the seat bar belong to the ULP from here on
+  stopSensorSampling();
+  bool monitored = startSleepMonitor();
+  
+  // Print wake-up information
+  flushLog(); // Queued records first, so the console output stays in order
+  Serial.println("Entering deep sleep mode...");
+  Serial.println(monitored ? "Wake up by pressing the BOOT button (GPIO0), the seat bar or a low battery"
+                           : "Wake up by pressing the BOOT button (GPIO0)");
+  Serial.flush(); // Ensure all serial output is sent
+  
+  // Enter deep sleep
+  esp_deep_sleep_start();
+}
+
+void handleWakeUp() {
+  // The ULP keeps sampling after any wake until it is stopped
+  stopSleepMonitor();
+  Serial.println("=== WAKE UP FROM DEEP SLEEP ===");
+  
+  // Check wake-up reason
+  esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
+  
+  switch(wakeup_reason) {
+    case ESP_SLEEP_WAKEUP_EXT0:
+      Serial.println("Woke up by external signal (button press)");
+      break;
+    case ESP_SLEEP_WAKEUP_ULP:
+      Serial.printf("Woke up by the ULP monitor (%s)\n", ulpWakeReasonName(sleepMonitorReport().wakeReason));
+      break;
+    case ESP_SLEEP_WAKEUP_TIMER:
+      Serial.println("Woke up by timer");
+      break;
+    default:
+      Serial.println("Woke up for unknown reason");
+      break;
+  }
+  
+  // Reset system state after wake-up
+  g_systemState.keyPosition = 0; // OFF
+  g_systemState.currentState = OFF;
+  g_systemState.wakeUpPending = false;
+  g_systemState.lastActivityTime = millis();
+  
+  // Settings, calibration, filter and counters from before the sleep; the
+  // pins are initialized once, by setup()
+  ResumeResult resume = restoreResumeState();
+  Serial.printf("Resume state: %s (wake %lu, slept in %s)\n", resumeResultName(resume),
+                (unsigned long)deepSleepCycles(),
+                resume == RESUME_RESTORED ? systemStateToString(lastSleepState()) : "?");
+}
@@ -0,0 +1,368 @@
+/*
+ * Status Report Implementation for Bobcat Ignition Controller
+ * A low-priority task compares the live status against the last published
+ * one. On a change it pushes the difference to /events clients and
+ * serializes the full /status body once for all pollers.
+ */
+
+#include "status_report.h"
+#include "config.h"
+#include "hardware.h"
+#include "sensors.h"
+#include "system_state.h"
+#include "commands.h"
+#include "status_bin.h"
+#include "task_monitor.h"
+#include <WiFi.h>
+#include <memory>
+
+static const size_t STATUS_JSON_CAPACITY = 1024;  // Full /status is ~720 bytes
+
+// Immutable once published; handlers keep a reference until sent
+struct StatusBody {
+    uint32_t generation;
+    char etag[16];
+    size_t length;
+    char json[STATUS_JSON_CAPACITY];
+    uint8_t bin[STATUS_BIN_SIZE];   // /status.bin, same generation
+};
+
+static AsyncEventSource events("/events");
+static TaskHandle_t pushTaskHandle = nullptr;
+
+static portMUX_TYPE bodyMux = portMUX_INITIALIZER_UNLOCKED;
+static std::shared_ptr<const StatusBody> currentBody;
+static uint32_t generation = 0;
+
+void captureStatusState(StatusState& state) {
+    SensorSnapshot sensors = getSensorSnapshot();
+    state.state = (uint8_t)g_systemState.currentState;
+    state.relays = getRelayStates();
+    state.keyPosition = (uint8_t)g_systemState.keyPosition;
+    state.startKeyHeld = g_systemState.keyStartHeld;
+    state.sleepModeEnabled = g_systemState.sleepModeEnabled;
+    state.oilPressureOk = sensors.oilPressureOk;
+    state.hydPressureOk = sensors.hydPressureOk;
+    state.lastCommandSeq = lastAppliedCommandSequence();
+
+    // Glow plug countdown (whenever glow plugs are on and timer is running)
+    state.glowCountdown = 0;
+    if ((state.relays & RELAY_GLOW_PLUGS) && g_systemState.glowPlugStartTime > 0) {
+        unsigned long elapsed = millis() - g_systemState.glowPlugStartTime;
+        if (elapsed < GLOW_PLUG_DURATION) {
+            state.glowCountdown = (GLOW_PLUG_DURATION - elapsed) / 1000;
+        }
+    }
+}
+
+void captureStatusSensors(StatusSensors& sensors) {
+    SensorSnapshot snapshot = getSensorSnapshot();
+    sensors.engineTemp = snapshot.engineTemp;
+    sensors.batteryVoltage = snapshot.batteryVoltage;
+    sensors.fuelLevel = snapshot.fuelLevel;
+
+    unsigned long timeSinceActivity = millis() - g_systemState.lastActivityTime;
+    sensors.timeSinceActivity = timeSinceActivity / 1000;
+    sensors.timeUntilSleep = timeSinceActivity < SLEEP_TIMEOUT ? (SLEEP_TIMEOUT - timeSinceActivity) / 1000 : 0;
+    sensors.sleepEligible = checkSleepConditions();
+
+    sensors.wifiConnected = WiFi.status() == WL_CONNECTED;
+    sensors.wifiIp = sensors.wifiConnected ? (uint32_t)WiFi.localIP() : 0;
+    sensors.wifiSsid[0] = '\0';
+    if (sensors.wifiConnected) {
+        strlcpy(sensors.wifiSsid, WiFi.SSID().c_str(), sizeof(sensors.wifiSsid));
+    }
+    sensors.apIp = (uint32_t)WiFi.softAPIP();
+    sensors.apClients = WiFi.softAPgetStationNum();
+}
+
+// Dotted quad without going through IPAddress::toString() (a String)
+static void writeIp(JsonWriter<JsonBufferSink>& json, JsonKey key, uint32_t address) {
+    IPAddress ip(address);
+    json.fieldf(key, "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+}
+
+uint16_t writeStatusJson(JsonWriter<JsonBufferSink>& json, const StatusReport& report, const StatusReport* previous) {
+    uint16_t fieldsBefore = json.fieldsWritten();
+    const StatusState& now = report.state;
+    const StatusSensors& sensors = report.sensors;
+    const StatusState* before = previous ? &previous->state : nullptr;
+    const StatusSensors* sensorsBefore = previous ? &previous->sensors : nullptr;
+
+    if (!before || now.state != before->state) {
+        json.field(JSON_KEY("state"), systemStateToString(now.state));
+        json.field(JSON_KEY("status"), systemStateToString(now.state)); // Keep for backward compatibility
+        json.field(JSON_KEY("engine_fault"), (now.state == ERROR));
+        json.field(JSON_KEY("low_oil_pressure"), (now.state == LOW_OIL_PRESSURE));
+        json.field(JSON_KEY("high_temperature"), (now.state == HIGH_TEMPERATURE));
+    }
+    if (!before || now.relays != before->relays) {
+        json.field(JSON_KEY("lights_on"), (now.relays & RELAY_LIGHTS) != 0);
+        json.field(JSON_KEY("main_power_on"), (now.relays & RELAY_MAIN_POWER) != 0);
+        json.field(JSON_KEY("glow_plugs_on"), (now.relays & RELAY_GLOW_PLUGS) != 0);
+        json.field(JSON_KEY("starter_on"), (now.relays & RELAY_STARTER) != 0);
+        json.field(JSON_KEY("glow_active"), (now.relays & RELAY_GLOW_PLUGS) != 0);
+    }
+    if (!before || now.oilPressureOk != before->oilPressureOk) {
+        float oilPressure = now.oilPressureOk ? 100.0 : 0.0;  // Switch: 100 kPa when pressure OK
+        json.field(JSON_KEY("pressure"), oilPressure);
+        json.field(JSON_KEY("oil_pressure"), oilPressure);
+    }
+    if (!before || now.hydPressureOk != before->hydPressureOk) {
+        json.field(JSON_KEY("hyd_pressure"), now.hydPressureOk ? 100.0 : 0.0);
+    }
+    if (!before || now.glowCountdown != before->glowCountdown) {
+        json.field(JSON_KEY("countdown"), now.glowCountdown);
+    }
+    if (!before || now.keyPosition != before->keyPosition) {
+        json.field(JSON_KEY("key_position"), now.keyPosition);
+    }
+    if (!before || now.startKeyHeld != before->startKeyHeld) {
+        json.field(JSON_KEY("start_key_held"), now.startKeyHeld);
+    }
+    if (!before || now.lastCommandSeq != before->lastCommandSeq) {
+        json.field(JSON_KEY("last_command_seq"), now.lastCommandSeq);
+    }
+    if (!before || now.sleepModeEnabled != before->sleepModeEnabled) {
+        json.field(JSON_KEY("sleep_mode_enabled"), now.sleepModeEnabled);
+    }
+
+    if (!sensorsBefore || sensors.engineTemp != sensorsBefore->engineTemp) {
+        json.field(JSON_KEY("temperature"), sensors.engineTemp);
+        json.field(JSON_KEY("engine_temp"), sensors.engineTemp);
+    }
+    if (!sensorsBefore || sensors.batteryVoltage != sensorsBefore->batteryVoltage) {
+        json.field(JSON_KEY("battery"), sensors.batteryVoltage);
+        json.field(JSON_KEY("battery_voltage"), sensors.batteryVoltage);
+        json.field(JSON_KEY("low_battery"), (sensors.batteryVoltage < 11.5));
+    }
+    if (!sensorsBefore || sensors.fuelLevel != sensorsBefore->fuelLevel) {
+        json.field(JSON_KEY("fuel_level"), sensors.fuelLevel);
+    }
+    if (!sensorsBefore) {
+        json.field(JSON_KEY("engine_hours"), 1234);
+    }
+    if (!sensorsBefore || sensors.timeSinceActivity != sensorsBefore->timeSinceActivity) {
+        json.field(JSON_KEY("time_since_activity"), sensors.timeSinceActivity);
+    }
+    if (!sensorsBefore || sensors.timeUntilSleep != sensorsBefore->timeUntilSleep) {
+        json.field(JSON_KEY("time_until_sleep"), sensors.timeUntilSleep);
+    }
+    if (!sensorsBefore || sensors.sleepEligible != sensorsBefore->sleepEligible) {
+        json.field(JSON_KEY("sleep_eligible"), sensors.sleepEligible);
+    }
+    if (!sensorsBefore || sensors.wifiConnected != sensorsBefore->wifiConnected ||
+        sensors.wifiIp != sensorsBefore->wifiIp || strcmp(sensors.wifiSsid, sensorsBefore->wifiSsid) != 0) {
+        json.field(JSON_KEY("wifi_connected"), sensors.wifiConnected);
+        if (sensors.wifiConnected) {
+            writeIp(json, JSON_KEY("wifi_ip"), sensors.wifiIp);
+            json.field(JSON_KEY("wifi_ssid"), (const char*)sensors.wifiSsid);
+        }
+    }
+    if (!sensorsBefore || sensors.apIp != sensorsBefore->apIp) {
+        writeIp(json, JSON_KEY("ap_ip"), sensors.apIp);
+    }
+    if (!sensorsBefore || sensors.apClients != sensorsBefore->apClients) {
+        json.field(JSON_KEY("ap_clients"), sensors.apClients);
+    }
+    return json.fieldsWritten() - fieldsBefore;
+}
+
+static std::shared_ptr<const StatusBody> latestBody() {
+    portENTER_CRITICAL(&bodyMux);
+    std::shared_ptr<const StatusBody> body = currentBody;
+    portEXIT_CRITICAL(&bodyMux);
+    return body;
+}
+
+uint32_t statusGeneration() {
+    return latestBody()->generation;
+}
+
+size_t statusStreamClients() {
+    return events.count();
+}
+
+static void toStatusBin(const StatusReport& report, uint32_t generation, StatusBin& bin) {
+    const StatusState& state = report.state;
+    const StatusSensors& sensors = report.sensors;
+    bin.flags = ((state.relays & RELAY_LIGHTS) ? STATUS_BIN_LIGHTS : 0) |
+                ((state.relays & RELAY_MAIN_POWER) ? STATUS_BIN_MAIN_POWER : 0) |
+                ((state.relays & RELAY_GLOW_PLUGS) ? STATUS_BIN_GLOW_PLUGS : 0) |
+                ((state.relays & RELAY_STARTER) ? STATUS_BIN_STARTER : 0) |
+                (state.oilPressureOk ? STATUS_BIN_OIL_PRESSURE_OK : 0) |
+                (state.hydPressureOk ? STATUS_BIN_HYD_PRESSURE_OK : 0) |
+                (state.startKeyHeld ? STATUS_BIN_START_KEY_HELD : 0) |
+                (state.sleepModeEnabled ? STATUS_BIN_SLEEP_ENABLED : 0) |
+                (sensors.sleepEligible ? STATUS_BIN_SLEEP_ELIGIBLE : 0) |
+                (sensors.wifiConnected ? STATUS_BIN_WIFI_CONNECTED : 0) |
+                (sensors.batteryVoltage < 11.5 ? STATUS_BIN_LOW_BATTERY : 0);
+    bin.generation = generation;
+    bin.state = state.state;
+    bin.keyPosition = state.keyPosition;
+    bin.apClients = sensors.apClients;
+    bin.glowCountdown = state.glowCountdown;
+    bin.engineTempDeci = (int16_t)constrain(lroundf(sensors.engineTemp * 10.0f), -32768L, 32767L);
+    bin.batteryMillivolts = (uint16_t)constrain(lroundf(sensors.batteryVoltage * 1000.0f), 0L, 65535L);
+    bin.fuelCentiPercent = (uint16_t)constrain(lroundf(sensors.fuelLevel * 100.0f), 0L, 10000L);
+    bin.lastCommandSeq = state.lastCommandSeq;
+    bin.timeSinceActivity = sensors.timeSinceActivity;
+    bin.timeUntilSleep = sensors.timeUntilSleep;
+    IPAddress wifiIp(sensors.wifiIp);
+    IPAddress apIp(sensors.apIp);
+    for (int i = 0; i < 4; i++) {
+        bin.wifiIp[i] = wifiIp[i];
+        bin.apIp[i] = apIp[i];
+    }
+    bin.uptimeMs = millis();
+}
+
+// Only called from the status task (and setup() before it starts)
+static void publishBody(const StatusReport& report) {
+    std::shared_ptr<StatusBody> body = std::make_shared<StatusBody>();
+    body->generation = ++generation;
+    snprintf(body->etag, sizeof(body->etag), "\"%lu\"", (unsigned long)body->generation);
+
+    JsonBufferSink sink(body->json, sizeof(body->json));
+    JsonWriter<JsonBufferSink> json(sink);
+    json.beginObject();
+    writeStatusJson(json, report);
+    json.field(JSON_KEY("generation"), body->generation);
+    json.endObject();
+    body->length = sink.length();
+
+    StatusBin bin;
+    toStatusBin(report, body->generation, bin);
+    encodeStatusBin(bin, body->bin);
+
+    std::shared_ptr<const StatusBody> previous = body;
+    portENTER_CRITICAL(&bodyMux);
+    currentBody.swap(previous);
+    portEXIT_CRITICAL(&bodyMux);
+    // `previous` (the old body) is released here, outside the critical section
+}
+
+// Stream the JSON or binary form out of the shared body, chunk by chunk
+static size_t fillFromBody(const StatusBody& body, bool binary, uint8_t* buffer, size_t maxLen, size_t index) {
+    const uint8_t* data = binary ? body.bin : (const uint8_t*)body.json;
+    size_t length = binary ? sizeof(body.bin) : body.length;
+    size_t len = std::min(maxLen, length - index);
+    memcpy(buffer, data + index, len);
+    return len;
+}
+
+// /status and /status.bin: same generation, ETag and long-poll rules
+static void handleStatusRequest(AsyncWebServerRequest* request, bool binary) {
+    const char* contentType = binary ? "application/octet-stream" : "application/json";
+    std::shared_ptr<const StatusBody> body = latestBody();
+
+    // ?since=<generation>: hold the request until the status moves on
+    if (request->hasParam("since") &&
+        (uint32_t)request->getParam("since")->value().toInt() == body->generation) {
+        uint32_t since = body->generation;
+        uint32_t heldAt = millis();
+        std::shared_ptr<std::shared_ptr<const StatusBody>> held = std::make_shared<std::shared_ptr<const StatusBody>>();
+        AsyncWebServerResponse* response = request->beginChunkedResponse(contentType,
+            [since, heldAt, held, binary](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                if (!*held) {
+                    std::shared_ptr<const StatusBody> latest = latestBody();
+                    if (latest->generation == since && millis() - heldAt < STATUS_LONG_POLL_TIMEOUT) {
+                        return RESPONSE_TRY_AGAIN;   // Asked again on the next TCP poll
+                    }
+                    *held = latest;
+                }
+                return fillFromBody(**held, binary, buffer, maxLen, index);
+            });
+        response->addHeader("Cache-Control", "no-store");
+        request->send(response);
+        return;
+    }
+
+    if (request->hasHeader("If-None-Match") &&
+        request->getHeader("If-None-Match")->value() == body->etag) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", body->etag);
+        request->send(response);
+        return;
+    }
+
+    size_t length = binary ? sizeof(body->bin) : body->length;
+    AsyncWebServerResponse* response = request->beginResponse(contentType, length,
+        [body, binary](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            return fillFromBody(*body, binary, buffer, maxLen, index);
+        });
+    response->addHeader("ETag", body->etag);
+    response->addHeader("Cache-Control", "no-cache");   // Browsers revalidate with If-None-Match
+    request->send(response);
+}
+
+// Every client starts from the full status; later events only carry changes
+static void sendFullStatus(AsyncEventSourceClient* client) {
+    std::shared_ptr<const StatusBody> body = latestBody();
+    client->send(body->json, "status", body->generation);
+}
+
+static void statusTask(void* parameter) {
+    StatusReport published = {};
+    uint32_t lastSensorCapture = millis();
+    TickType_t lastWake = xTaskGetTickCount();
+    uint32_t passStart = micros();
+
+    captureStatusState(published.state);
+    captureStatusSensors(published.sensors);
+
+    for (;;) {
+        // Measured here so the passes that end early with continue count too
+        noteTaskBusy(TASK_STATUS, micros() - passStart);
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(STATUS_STATE_POLL_INTERVAL));
+        passStart = micros();
+
+        StatusReport current = {};
+        captureStatusState(current.state);
+        uint32_t now = millis();
+        if (now - lastSensorCapture >= STATUS_SENSOR_PUSH_INTERVAL) {
+            captureStatusSensors(current.sensors);
+            lastSensorCapture = now;
+        } else {
+            current.sensors = published.sensors;
+        }
+
+        char delta[STATUS_JSON_CAPACITY];
+        JsonBufferSink sink(delta, sizeof(delta));
+        JsonWriter<JsonBufferSink> json(sink);
+        json.beginObject();
+        if (writeStatusJson(json, current, &published) == 0) {
+            continue;   // Nothing changed: pollers keep getting 304s
+        }
+
+        publishBody(current);
+        if (events.count() > 0) {
+            json.field(JSON_KEY("generation"), statusGeneration());
+            json.endObject();
+            events.send(delta, "status", statusGeneration());
+        }
+        published = current;
+    }
+}
+
+void setupStatusEndpoints(AsyncWebServer& server) {
+    // Publish the first body before any request can ask for it
+    StatusReport report = {};
+    captureStatusState(report.state);
+    captureStatusSensors(report.sensors);
+    publishBody(report);
+
+    server.on("/status.bin", HTTP_GET, [](AsyncWebServerRequest* request) {
+        handleStatusRequest(request, true);
+    });
+    server.on("/status", HTTP_GET, [](AsyncWebServerRequest* request) {
+        handleStatusRequest(request, false);
+    });
+    events.onConnect(sendFullStatus);
+    server.addHandler(&events);
+
+    if (pushTaskHandle == nullptr) {
+        xTaskCreatePinnedToCore(statusTask, "status", STATUS_PUSH_TASK_STACK_SIZE, nullptr,
+                                STATUS_PUSH_TASK_PRIORITY, &pushTaskHandle, NETWORK_CORE);
+    }
+}
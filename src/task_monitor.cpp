@@ -0,0 +1,115 @@
+/*
+ * Task Monitor Implementation for Bobcat Ignition Controller
+ * Busy time is measured by the tasks themselves: the precompiled Arduino
+ * core decides whether FreeRTOS keeps run-time statistics, not this
+ * project. Tasks without their own figures still get core, priority and
+ * stack high-water mark from the web handler.
+ */
+
+#include "task_monitor.h"
+#include "hal.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+// Written from both cores, read from the web server task
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+#define STATS_LOCK() portENTER_CRITICAL(&statsMux)
+#define STATS_UNLOCK() portEXIT_CRITICAL(&statsMux)
+#else
+#define STATS_LOCK()
+#define STATS_UNLOCK()
+#endif
+
+static const char* const TASK_NAMES[MONITORED_TASK_COUNT] = {
+#define MONITORED_TASK_NAME(id, name, timed) name,
+  MONITORED_TASKS(MONITORED_TASK_NAME)
+#undef MONITORED_TASK_NAME
+};
+
+static const bool TASK_TIMED[MONITORED_TASK_COUNT] = {
+#define MONITORED_TASK_TIMED(id, name, timed) timed,
+  MONITORED_TASKS(MONITORED_TASK_TIMED)
+#undef MONITORED_TASK_TIMED
+};
+
+static ControlTimingStats control = {};
+static uint64_t busyUs[MONITORED_TASK_COUNT] = {};
+static uint32_t windowStart = 0;
+
+void noteControlPass(uint32_t passUs) {
+  STATS_LOCK();
+  control.passes++;
+  control.passTotalUs += passUs;
+  if (passUs > control.passMaxUs) {
+    control.passMaxUs = passUs;
+  }
+  busyUs[TASK_CONTROL] += passUs;
+  STATS_UNLOCK();
+}
+
+void noteControlWake(uint32_t lateUs) {
+  STATS_LOCK();
+  control.deadlineWakes++;
+  control.lateTotalUs += lateUs;
+  if (lateUs > control.lateMaxUs) {
+    control.lateMaxUs = lateUs;
+  }
+  STATS_UNLOCK();
+}
+
+void noteTaskBusy(MonitoredTask task, uint32_t taskUs) {
+  if (task >= MONITORED_TASK_COUNT) {
+    return;
+  }
+  STATS_LOCK();
+  busyUs[task] += taskUs;
+  STATS_UNLOCK();
+}
+
+void resetTaskMonitor() {
+  uint32_t now = halMillis();
+  STATS_LOCK();
+  control = {};
+  for (uint8_t i = 0; i < MONITORED_TASK_COUNT; i++) {
+    busyUs[i] = 0;
+  }
+  windowStart = now;
+  STATS_UNLOCK();
+}
+
+ControlTimingStats getControlTimingStats() {
+  STATS_LOCK();
+  ControlTimingStats copy = control;
+  STATS_UNLOCK();
+  return copy;
+}
+
+uint32_t taskMonitorWindowMs() {
+  return halMillis() - windowStart;
+}
+
+uint64_t taskBusyUs(MonitoredTask task) {
+  if (task >= MONITORED_TASK_COUNT) {
+    return 0;
+  }
+  STATS_LOCK();
+  uint64_t value = busyUs[task];
+  STATS_UNLOCK();
+  return value;
+}
+
+float taskCpuPercent(MonitoredTask task) {
+  if (task >= MONITORED_TASK_COUNT || !TASK_TIMED[task]) {
+    return -1.0f;
+  }
+  uint32_t window = taskMonitorWindowMs();
+  if (window == 0) {
+    return 0.0f;
+  }
+  return taskBusyUs(task) / (window * 10.0f);   // µs / (ms * 1000) * 100
+}
+
+const char* monitoredTaskName(MonitoredTask task) {
+  return task < MONITORED_TASK_COUNT ? TASK_NAMES[task] : "?";
+}
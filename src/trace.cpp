@@ -0,0 +1,495 @@
+/*
+ * Control Input Trace Implementation for Bobcat Ignition Controller
+ * Records are built in a small scratch buffer and appended in one step
+ * under a short lock. Committed bytes never change until their segment is
+ * recycled, so the exporter copies them outside the lock and retries if a
+ * segment was recycled in the meantime.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+#include "config.h"
+#include "hardware.h"
+
+// Room left in a segment below which a new tick starts the other segment:
+// keyframe + snapshot + a full command queue + output
+static const size_t TICK_RESERVE = 512;
+static const size_t MAX_RECORD = 128;
+
+enum SnapshotField : uint16_t {
+  SNAP_SEQUENCE     = 1 << 0,
+  SNAP_TIMESTAMP    = 1 << 1,
+  SNAP_BATTERY_RAW  = 1 << 2,
+  SNAP_TEMP_RAW     = 1 << 3,
+  SNAP_PRESSURE_RAW = 1 << 4,
+  SNAP_FUEL_RAW     = 1 << 5,
+  SNAP_HYD_RAW      = 1 << 6,
+  SNAP_BATTERY_V    = 1 << 7,
+  SNAP_ENGINE_TEMP  = 1 << 8,
+  SNAP_FUEL_LEVEL   = 1 << 9,
+  SNAP_DIGITAL      = 1 << 10,
+  SNAP_ALL          = (1 << 11) - 1
+};
+
+#ifdef ARDUINO
+static portMUX_TYPE traceMux = portMUX_INITIALIZER_UNLOCKED;
+#define TRACE_LOCK() portENTER_CRITICAL(&traceMux)
+#define TRACE_UNLOCK() portEXIT_CRITICAL(&traceMux)
+#else
+#define TRACE_LOCK()
+#define TRACE_UNLOCK()
+#endif
+
+// Shared with the exporter (under the lock)
+static uint8_t* buffer = nullptr;
+static size_t segmentSize = 0;
+static size_t used[2];        // Bytes written, including the tick in progress
+static size_t committed[2];   // Bytes of finished ticks
+static uint8_t active = 0;
+static bool olderValid = false;
+static uint32_t generation = 0;   // Bumped whenever a segment is cleared for reuse
+static volatile bool resetRequested = false;
+static uint32_t dropped = 0;
+
+// Control task only
+static bool needKeyframe = true;
+static uint32_t lastTickMs = 0;
+static SensorSnapshot baseline;
+static uint8_t lastRelays = 0;
+static uint8_t lastState = 0;
+
+// ============================================================================
+// Encoding helpers
+// ============================================================================
+
+struct Writer {
+  uint8_t bytes[MAX_RECORD];
+  size_t len = 0;
+
+  void u8(uint8_t v) { if (len < sizeof(bytes)) bytes[len++] = v; }
+  void u16(uint16_t v) { u8(v & 0xFF); u8(v >> 8); }
+  void u32(uint32_t v) { u16(v & 0xFFFF); u16(v >> 16); }
+  void f32(float v) { uint32_t bits; memcpy(&bits, &v, 4); u32(bits); }
+  void varint(uint32_t v) {
+    while (v >= 0x80) { u8((v & 0x7F) | 0x80); v >>= 7; }
+    u8(v);
+  }
+  void zigzag(int32_t v) { varint(((uint32_t)v << 1) ^ (uint32_t)(v >> 31)); }
+};
+
+static bool sameFloat(float a, float b) {
+  return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+static uint8_t digitalFlags(const SensorSnapshot& s) {
+  return (s.oilPressureOk << 0) | (s.hydPressureOk << 1) | (s.alternatorCharging << 2) |
+         (s.engineRunning << 3) | (s.seatBarEngaged << 4) | (s.inNeutral << 5);
+}
+
+static void encodeSnapshot(Writer& w, const SensorSnapshot& s, const SensorSnapshot& prev, uint16_t mask) {
+  if (s.sequence != prev.sequence) mask |= SNAP_SEQUENCE;
+  if (s.timestampMs != prev.timestampMs) mask |= SNAP_TIMESTAMP;
+  if (s.batteryRaw != prev.batteryRaw) mask |= SNAP_BATTERY_RAW;
+  if (s.temperatureRaw != prev.temperatureRaw) mask |= SNAP_TEMP_RAW;
+  if (s.pressureRaw != prev.pressureRaw) mask |= SNAP_PRESSURE_RAW;
+  if (s.fuelRaw != prev.fuelRaw) mask |= SNAP_FUEL_RAW;
+  if (s.hydraulicRaw != prev.hydraulicRaw) mask |= SNAP_HYD_RAW;
+  if (!sameFloat(s.batteryVoltage, prev.batteryVoltage)) mask |= SNAP_BATTERY_V;
+  if (!sameFloat(s.engineTemp, prev.engineTemp)) mask |= SNAP_ENGINE_TEMP;
+  if (!sameFloat(s.fuelLevel, prev.fuelLevel)) mask |= SNAP_FUEL_LEVEL;
+  if (digitalFlags(s) != digitalFlags(prev)) mask |= SNAP_DIGITAL;
+
+  w.varint(mask);
+  if (mask & SNAP_SEQUENCE) w.zigzag((int32_t)(s.sequence - prev.sequence));
+  if (mask & SNAP_TIMESTAMP) w.zigzag((int32_t)(s.timestampMs - prev.timestampMs));
+  if (mask & SNAP_BATTERY_RAW) w.zigzag(s.batteryRaw - prev.batteryRaw);
+  if (mask & SNAP_TEMP_RAW) w.zigzag(s.temperatureRaw - prev.temperatureRaw);
+  if (mask & SNAP_PRESSURE_RAW) w.zigzag(s.pressureRaw - prev.pressureRaw);
+  if (mask & SNAP_FUEL_RAW) w.zigzag(s.fuelRaw - prev.fuelRaw);
+  if (mask & SNAP_HYD_RAW) w.zigzag(s.hydraulicRaw - prev.hydraulicRaw);
+  if (mask & SNAP_BATTERY_V) w.f32(s.batteryVoltage);
+  if (mask & SNAP_ENGINE_TEMP) w.f32(s.engineTemp);
+  if (mask & SNAP_FUEL_LEVEL) w.f32(s.fuelLevel);
+  if (mask & SNAP_DIGITAL) w.u8(digitalFlags(s));
+}
+
+// SystemState_t uses unsigned long, which is 64-bit on most hosts, so the
+// fields are written one by one at fixed widths
+static void encodeState(Writer& w, const SystemState_t& s) {
+  w.u8((uint8_t)s.keyPosition);
+  w.u8((uint8_t)s.currentState);
+  w.u8((s.keyStartHeld << 0) | (s.shutdownInProgress << 1) | (s.emergencyStopPressed << 2) |
+       (s.lightsTogglePressed << 3) | (s.workLightsOn << 4) | (s.sleepModeEnabled << 5) |
+       (s.wakeUpPending << 6));
+  w.u32(s.startHoldTime);
+  w.u32(s.glowPlugStartTime);
+  w.u32(s.ignitionStartTime);
+  w.u32(s.shutdownStartTime);
+  w.u32(s.lastCountdownLog);
+  w.u32(s.lastActivityTime);
+  w.u32(s.sleepTimer);
+  w.f32(s.engineTemp);
+  w.f32(s.oilPressure);
+  w.f32(s.batteryVoltage);
+  w.f32(s.fuelLevel);
+}
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+static bool append(const Writer& w) {
+  bool fits;
+  TRACE_LOCK();
+  fits = used[active] + w.len <= segmentSize;
+  if (fits) {
+    memcpy(buffer + active * segmentSize + used[active], w.bytes, w.len);
+    used[active] += w.len;
+  } else {
+    dropped++;
+  }
+  TRACE_UNLOCK();
+  if (!fits) {
+    needKeyframe = true; // The rest of this segment no longer replays
+  }
+  return fits;
+}
+
+static void startSegment(uint32_t now) {
+  TRACE_LOCK();
+  if (resetRequested) {
+    used[0] = used[1] = committed[0] = committed[1] = 0;
+    olderValid = false;
+    resetRequested = false;
+  } else if (used[active] > 0) {
+    active ^= 1;
+    olderValid = true;
+  }
+  used[active] = 0;
+  committed[active] = 0;
+  generation++;
+  TRACE_UNLOCK();
+
+  Writer w;
+  w.u8(TRACE_KEYFRAME);
+  w.u32(now);
+  encodeState(w, g_systemState);
+  lastRelays = getRelayStates();
+  lastState = (uint8_t)g_systemState.currentState;
+  w.u8(lastRelays);
+  SensorSnapshot zero = {};
+  encodeSnapshot(w, baseline, zero, SNAP_ALL);
+  append(w);
+  lastTickMs = now;
+  needKeyframe = false;
+}
+
+void traceTick(uint32_t now) {
+  if (buffer == nullptr) {
+    buffer = (uint8_t*)malloc(TRACE_BUFFER_SIZE);
+    if (buffer == nullptr) {
+      return;
+    }
+    segmentSize = TRACE_BUFFER_SIZE / 2;
+  }
+
+  if (needKeyframe || resetRequested || used[active] + TICK_RESERVE > segmentSize) {
+    startSegment(now);
+  }
+
+  Writer w;
+  w.u8(TRACE_TICK);
+  w.varint(now - lastTickMs);
+  lastTickMs = now;
+  append(w);
+}
+
+void traceSnapshot(const SensorSnapshot& sensors) {
+  if (buffer == nullptr || sensors.sequence == baseline.sequence) {
+    return;
+  }
+  Writer w;
+  w.u8(TRACE_SNAPSHOT);
+  encodeSnapshot(w, sensors, baseline, 0);
+  append(w);
+  baseline = sensors;
+}
+
+void traceCommand(uint8_t type, int32_t arg) {
+  if (buffer == nullptr) {
+    return;
+  }
+  Writer w;
+  w.u8(TRACE_COMMAND);
+  w.u8(type);
+  w.zigzag(arg);
+  append(w);
+}
+
+void traceOutputs(uint8_t relays, uint8_t state) {
+  if (buffer == nullptr) {
+    return;
+  }
+  if (relays != lastRelays || state != lastState) {
+    Writer w;
+    w.u8(TRACE_OUTPUT);
+    w.u8(relays);
+    w.u8(state);
+    append(w);
+    lastRelays = relays;
+    lastState = state;
+  }
+  TRACE_LOCK();
+  if (needKeyframe) {
+    used[active] = committed[active]; // A record of this tick was dropped: discard the tick
+  } else {
+    committed[active] = used[active];
+  }
+  TRACE_UNLOCK();
+}
+
+// ============================================================================
+// Export
+// ============================================================================
+
+static const uint8_t TRACE_MAGIC[4] = { 'B', 'T', 'R', 'C' };
+
+static size_t exportSizeLocked() {
+  size_t size = sizeof(TRACE_MAGIC) + 2 + 4 + committed[active];
+  if (olderValid) {
+    size += 4 + committed[active ^ 1];
+  }
+  return size;
+}
+
+size_t traceExportSize() {
+  TRACE_LOCK();
+  size_t size = buffer != nullptr ? exportSizeLocked() : sizeof(TRACE_MAGIC) + 2;
+  TRACE_UNLOCK();
+  return size;
+}
+
+static size_t putSegment(uint8_t* out, uint8_t index, uint32_t len) {
+  for (int i = 0; i < 4; i++) {
+    out[i] = (len >> (8 * i)) & 0xFF;
+  }
+  memcpy(out + 4, buffer + index * segmentSize, len);
+  return 4 + len;
+}
+
+size_t traceExport(uint8_t* out, size_t maxLen) {
+  if (maxLen < sizeof(TRACE_MAGIC) + 2) {
+    return 0;
+  }
+  memcpy(out, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  out[4] = TRACE_VERSION;
+
+  for (int attempt = 0; attempt < 3; attempt++) {
+    // Only the layout is taken under the lock; the control task keeps
+    // appending past the committed lengths while we copy
+    TRACE_LOCK();
+    bool allocated = buffer != nullptr;
+    bool fits = allocated && exportSizeLocked() <= maxLen;
+    uint32_t startGeneration = generation;
+    uint8_t newer = active;
+    bool older = olderValid;
+    uint32_t newerLen = committed[newer];
+    uint32_t olderLen = committed[newer ^ 1];
+    TRACE_UNLOCK();
+
+    if (!allocated) {
+      out[5] = 0;
+      return 6;
+    }
+    if (!fits) {
+      return 0;
+    }
+
+    size_t pos = 6;
+    out[5] = older ? 2 : 1;
+    if (older) {
+      pos += putSegment(out + pos, newer ^ 1, olderLen);
+    }
+    pos += putSegment(out + pos, newer, newerLen);
+
+    TRACE_LOCK();
+    bool unchanged = generation == startGeneration;
+    TRACE_UNLOCK();
+    if (unchanged) {
+      return pos;
+    }
+  }
+  return 0;   // Segments kept being recycled under us; the caller retries
+}
+
+void traceReset() {
+  resetRequested = true;
+}
+
+uint32_t traceRecordsDropped() {
+  return dropped;
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+struct Cursor {
+  const uint8_t* data;
+  size_t pos;
+  size_t end;
+  bool ok;
+
+  uint8_t u8() {
+    if (pos >= end) { ok = false; return 0; }
+    return data[pos++];
+  }
+  uint16_t u16() { uint16_t lo = u8(); return lo | (uint16_t)u8() << 8; }
+  uint32_t u32() { uint32_t lo = u16(); return lo | (uint32_t)u16() << 16; }
+  float f32() { uint32_t bits = u32(); float v; memcpy(&v, &bits, 4); return v; }
+  uint32_t varint() {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      uint8_t b = u8();
+      v |= (uint32_t)(b & 0x7F) << shift;
+      if (!(b & 0x80)) return v;
+    }
+    ok = false;
+    return 0;
+  }
+  int32_t zigzag() { uint32_t v = varint(); return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+};
+
+static void decodeSnapshot(Cursor& c, SensorSnapshot& s) {
+  uint32_t mask = c.varint();
+  if (mask & SNAP_SEQUENCE) s.sequence += c.zigzag();
+  if (mask & SNAP_TIMESTAMP) s.timestampMs += c.zigzag();
+  if (mask & SNAP_BATTERY_RAW) s.batteryRaw += c.zigzag();
+  if (mask & SNAP_TEMP_RAW) s.temperatureRaw += c.zigzag();
+  if (mask & SNAP_PRESSURE_RAW) s.pressureRaw += c.zigzag();
+  if (mask & SNAP_FUEL_RAW) s.fuelRaw += c.zigzag();
+  if (mask & SNAP_HYD_RAW) s.hydraulicRaw += c.zigzag();
+  if (mask & SNAP_BATTERY_V) s.batteryVoltage = c.f32();
+  if (mask & SNAP_ENGINE_TEMP) s.engineTemp = c.f32();
+  if (mask & SNAP_FUEL_LEVEL) s.fuelLevel = c.f32();
+  if (mask & SNAP_DIGITAL) {
+    uint8_t flags = c.u8();
+    s.oilPressureOk = flags & (1 << 0);
+    s.hydPressureOk = flags & (1 << 1);
+    s.alternatorCharging = flags & (1 << 2);
+    s.engineRunning = flags & (1 << 3);
+    s.seatBarEngaged = flags & (1 << 4);
+    s.inNeutral = flags & (1 << 5);
+  }
+}
+
+static void decodeState(Cursor& c, SystemState_t& s) {
+  s = SystemState_t();
+  s.keyPosition = c.u8();
+  s.currentState = c.u8();
+  uint8_t flags = c.u8();
+  s.keyStartHeld = flags & (1 << 0);
+  s.shutdownInProgress = flags & (1 << 1);
+  s.emergencyStopPressed = flags & (1 << 2);
+  s.lightsTogglePressed = flags & (1 << 3);
+  s.workLightsOn = flags & (1 << 4);
+  s.sleepModeEnabled = flags & (1 << 5);
+  s.wakeUpPending = flags & (1 << 6);
+  s.startHoldTime = c.u32();
+  s.glowPlugStartTime = c.u32();
+  s.ignitionStartTime = c.u32();
+  s.shutdownStartTime = c.u32();
+  s.lastCountdownLog = c.u32();
+  s.lastActivityTime = c.u32();
+  s.sleepTimer = c.u32();
+  s.engineTemp = c.f32();
+  s.oilPressure = c.f32();
+  s.batteryVoltage = c.f32();
+  s.fuelLevel = c.f32();
+}
+
+bool TraceReader::open(const uint8_t* bytes, size_t length) {
+  data = bytes;
+  len = length;
+  pos = segmentEnd = 6;
+  timeMs = 0;
+  baseline = SensorSnapshot();
+  errorMessage = nullptr;
+  if (length < 6 || memcmp(bytes, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+    errorMessage = "not a trace";
+    return false;
+  }
+  if (bytes[4] != TRACE_VERSION) {
+    errorMessage = "unsupported trace version";
+    return false;
+  }
+  segmentsLeft = bytes[5];
+  return true;
+}
+
+bool TraceReader::next(TraceEvent& event) {
+  bool segmentStart = false;
+  if (pos >= segmentEnd) {
+    if (segmentsLeft == 0) {
+      return false;
+    }
+    Cursor header = { data, pos, len, true };
+    uint32_t segmentLen = header.u32();
+    if (!header.ok || header.pos + segmentLen > len) {
+      errorMessage = "truncated segment";
+      return false;
+    }
+    segmentsLeft--;
+    pos = header.pos;
+    segmentEnd = pos + segmentLen;
+    segmentStart = true;
+    if (segmentLen == 0) {
+      return next(event);
+    }
+  }
+
+  Cursor c = { data, pos, segmentEnd, true };
+  event.kind = (TraceKind)c.u8();
+  if (segmentStart && event.kind != TRACE_KEYFRAME) {
+    errorMessage = "segment does not start with a keyframe";
+    return false;
+  }
+
+  switch (event.kind) {
+    case TRACE_KEYFRAME:
+      timeMs = c.u32();
+      decodeState(c, event.state);
+      event.relays = c.u8();
+      baseline = SensorSnapshot();
+      decodeSnapshot(c, baseline);
+      event.snapshot = baseline;
+      break;
+    case TRACE_TICK:
+      timeMs += c.varint();
+      break;
+    case TRACE_SNAPSHOT:
+      decodeSnapshot(c, baseline);
+      event.snapshot = baseline;
+      break;
+    case TRACE_COMMAND:
+      event.commandType = c.u8();
+      event.commandArg = c.zigzag();
+      break;
+    case TRACE_OUTPUT:
+      event.relays = c.u8();
+      event.currentState = c.u8();
+      break;
+    default:
+      errorMessage = "unknown record kind";
+      return false;
+  }
+
+  if (!c.ok) {
+    errorMessage = "truncated record";
+    return false;
+  }
+  event.timeMs = timeMs;
+  pos = c.pos;
+  return true;
+}
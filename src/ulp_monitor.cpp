@@ -0,0 +1,288 @@
+/*
+ * Deep Sleep Monitor Implementation for Bobcat Ignition Controller
+ * The ULP program is assembled at run time from the ulp.h macros (the pin
+ * numbers and the threshold come from config and settings) and keeps its
+ * variables at the start of RTC slow memory, ahead of the program
+ */
+
+#include "ulp_monitor.h"
+#include "config.h"
+#include "hardware.h"
+#include "sensors.h"
+#include "settings.h"
+#include <Arduino.h>
+#include <driver/adc.h>
+#include <driver/rtc_io.h>
+#include <esp32/ulp.h>
+#include <esp_sleep.h>
+#include <soc/rtc_cntl_reg.h>
+#include <soc/rtc_io_reg.h>
+
+static const uint32_t ULP_MAGIC = 0x554C5031;   // Written by the main CPU only
+
+// Word offsets in RTC slow memory. The ULP stores 16-bit values (the upper
+// half of a word it writes is not data).
+enum UlpVariable : uint32_t {
+  VAR_MAGIC,
+  VAR_THRESHOLD,     // Raw count below which the battery wakes the controller (0 = off)
+  VAR_BELOW,         // Battery was below the threshold at the last sample
+  VAR_SEAT,          // Seat bar was engaged at the last poll
+  VAR_WAKE,          // UlpWakeReason
+  VAR_SAMPLES,
+  VAR_LAST,
+  VAR_MIN,
+  VAR_MAX,
+  VAR_WINDOW,        // Samples in the current window
+  VAR_WINDOWS,       // Completed windows, up to ULP_HISTORY_SLOTS
+  VAR_SLOT,          // Word offset of the current window's {min, max}
+  VAR_HISTORY,       // ULP_HISTORY_SLOTS x {min, max}
+  ULP_DATA_WORDS = VAR_HISTORY + 2 * ULP_HISTORY_SLOTS
+};
+
+enum UlpLabel {
+  L_COUNTED, L_NEW_MIN, L_MIN_DONE, L_NEW_MAX, L_MAX_DONE, L_SLOT_MIN, L_SLOT_MIN_DONE,
+  L_SLOT_MAX, L_SLOT_MAX_DONE, L_NO_WRAP, L_WINDOW_OPEN, L_BELOW, L_SEAT, L_SEAT_FREE,
+  L_WAKE, L_DONE
+};
+
+static SleepMonitorReport report = {};
+
+static uint16_t ulpWord(uint32_t variable) {
+  return (uint16_t)(RTC_SLOW_MEM[variable] & 0xFFFF);
+}
+
+bool startSleepMonitor() {
+  int8_t adcChannel = digitalPinToAnalogChannel(BATTERY_VOLTAGE_PIN);
+  int seatRtcIo = rtc_io_number_get((gpio_num_t)SEAT_BAR_PIN);
+  if (adcChannel < 0 || adcChannel > 7 || seatRtcIo < 0) {
+    Serial.println("ULP monitor: battery must be on ADC1 and the seat bar on an RTC GPIO");
+    return false;
+  }
+
+  float wakeVolts = g_settingsManager.getSettings().sleepWakeVoltage;
+  float divider = getCalibration().batteryDivider;
+  uint32_t threshold = (wakeVolts > 0.0f && divider > 0.0f) ? (uint32_t)(wakeVolts / divider) : 0;
+  if (threshold > 4095) {
+    threshold = 4095;
+  }
+  uint32_t windowSamples = ULP_HISTORY_WINDOW / ULP_SAMPLE_INTERVAL;
+  if (windowSamples == 0 || windowSamples > 0xFFFF) {
+    windowSamples = 0xFFFF;
+  }
+
+  // R1 = battery sample, R2 = current window, R3 = 0 (base for the
+  // variables). a - b sets the overflow flag when a < b.
+  const ulp_insn_t program[] = {
+    I_MOVI(R3, 0),
+
+    // Battery: mean of four conversions
+    I_ADC(R1, 0, adcChannel),
+    I_ADC(R2, 0, adcChannel),
+    I_ADDR(R1, R1, R2),
+    I_ADC(R2, 0, adcChannel),
+    I_ADDR(R1, R1, R2),
+    I_ADC(R2, 0, adcChannel),
+    I_ADDR(R1, R1, R2),
+    I_RSHI(R1, R1, 2),
+    I_ST(R1, R3, VAR_LAST),
+
+    I_LD(R0, R3, VAR_SAMPLES),
+    M_BGE(L_COUNTED, 0xFFFF),
+    I_ADDI(R0, R0, 1),
+    I_ST(R0, R3, VAR_SAMPLES),
+    M_LABEL(L_COUNTED),
+
+    // Since the controller slept
+    I_LD(R0, R3, VAR_MIN),
+    I_SUBR(R0, R1, R0),
+    M_BXF(L_NEW_MIN),
+    M_BX(L_MIN_DONE),
+    M_LABEL(L_NEW_MIN),
+    I_ST(R1, R3, VAR_MIN),
+    M_LABEL(L_MIN_DONE),
+    I_LD(R0, R3, VAR_MAX),
+    I_SUBR(R0, R0, R1),
+    M_BXF(L_NEW_MAX),
+    M_BX(L_MAX_DONE),
+    M_LABEL(L_NEW_MAX),
+    I_ST(R1, R3, VAR_MAX),
+    M_LABEL(L_MAX_DONE),
+
+    // Current window
+    I_LD(R2, R3, VAR_SLOT),
+    I_LD(R0, R2, 0),
+    I_SUBR(R0, R1, R0),
+    M_BXF(L_SLOT_MIN),
+    M_BX(L_SLOT_MIN_DONE),
+    M_LABEL(L_SLOT_MIN),
+    I_ST(R1, R2, 0),
+    M_LABEL(L_SLOT_MIN_DONE),
+    I_LD(R0, R2, 1),
+    I_SUBR(R0, R0, R1),
+    M_BXF(L_SLOT_MAX),
+    M_BX(L_SLOT_MAX_DONE),
+    M_LABEL(L_SLOT_MAX),
+    I_ST(R1, R2, 1),
+    M_LABEL(L_SLOT_MAX_DONE),
+
+    // Window full: move to the next slot (wrapping) and start it empty
+    I_LD(R0, R3, VAR_WINDOW),
+    I_ADDI(R0, R0, 1),
+    I_ST(R0, R3, VAR_WINDOW),
+    M_BL(L_WINDOW_OPEN, windowSamples),
+    I_MOVI(R0, 0),
+    I_ST(R0, R3, VAR_WINDOW),
+    I_ADDI(R2, R2, 2),
+    I_MOVR(R0, R2),
+    M_BL(L_NO_WRAP, ULP_DATA_WORDS),
+    I_MOVI(R2, VAR_HISTORY),
+    M_LABEL(L_NO_WRAP),
+    I_ST(R2, R3, VAR_SLOT),
+    I_MOVI(R0, 0xFFFF),
+    I_ST(R0, R2, 0),
+    I_MOVI(R0, 0),
+    I_ST(R0, R2, 1),
+    I_LD(R0, R3, VAR_WINDOWS),
+    M_BGE(L_WINDOW_OPEN, ULP_HISTORY_SLOTS),
+    I_ADDI(R0, R0, 1),
+    I_ST(R0, R3, VAR_WINDOWS),
+    M_LABEL(L_WINDOW_OPEN),
+
+    // Battery crossing below the threshold (not if it was already below)
+    I_LD(R0, R3, VAR_THRESHOLD),
+    I_SUBR(R0, R1, R0),
+    M_BXF(L_BELOW),
+    I_MOVI(R0, 0),
+    I_ST(R0, R3, VAR_BELOW),
+    M_BX(L_SEAT),
+    M_LABEL(L_BELOW),
+    I_LD(R0, R3, VAR_BELOW),
+    M_BGE(L_SEAT, 1),
+    I_MOVI(R0, 1),
+    I_ST(R0, R3, VAR_BELOW),
+    I_MOVI(R0, ULP_WAKE_LOW_BATTERY),
+    I_ST(R0, R3, VAR_WAKE),
+    M_BX(L_WAKE),
+
+    // Seat bar engaging (closes to ground); an operator already seated
+    // when the controller slept has to get up first
+    M_LABEL(L_SEAT),
+    I_RD_REG(RTC_GPIO_IN_REG, RTC_GPIO_IN_NEXT_S + seatRtcIo, RTC_GPIO_IN_NEXT_S + seatRtcIo),
+    M_BGE(L_SEAT_FREE, 1),
+    I_LD(R0, R3, VAR_SEAT),
+    M_BGE(L_DONE, 1),
+    I_MOVI(R0, 1),
+    I_ST(R0, R3, VAR_SEAT),
+    I_MOVI(R0, ULP_WAKE_SEAT_BAR),
+    I_ST(R0, R3, VAR_WAKE),
+    M_BX(L_WAKE),
+    M_LABEL(L_SEAT_FREE),
+    I_MOVI(R0, 0),
+    I_ST(R0, R3, VAR_SEAT),
+    M_BX(L_DONE),
+
+    M_LABEL(L_WAKE),
+    I_WAKE(),
+    I_END(),     // Stop the ULP timer until the next sleep
+    M_LABEL(L_DONE),
+    I_HALT()
+  };
+
+  const SensorSnapshot sensors = getSensorSnapshot();
+  for (uint32_t i = 0; i < ULP_DATA_WORDS; i++) {
+    RTC_SLOW_MEM[i] = 0;
+  }
+  RTC_SLOW_MEM[VAR_THRESHOLD] = threshold;
+  RTC_SLOW_MEM[VAR_BELOW] = sensors.batteryRaw < threshold;
+  RTC_SLOW_MEM[VAR_SEAT] = sensors.seatBarEngaged;
+  RTC_SLOW_MEM[VAR_MIN] = 0xFFFF;
+  RTC_SLOW_MEM[VAR_SLOT] = VAR_HISTORY;
+  for (uint8_t i = 0; i < ULP_HISTORY_SLOTS; i++) {
+    RTC_SLOW_MEM[VAR_HISTORY + 2 * i] = 0xFFFF;   // Empty: min > max
+  }
+
+  size_t size = sizeof(program) / sizeof(ulp_insn_t);
+  esp_err_t result = ulp_process_macros_and_load(ULP_DATA_WORDS, program, &size);
+  if (result != ESP_OK) {
+    Serial.printf("ULP monitor: program not loaded (%s)\n", esp_err_to_name(result));
+    return false;
+  }
+
+  // ADC1 to the ULP, seat bar pulled up in the RTC domain (which stays
+  // powered for it)
+  adc1_config_width(ADC_WIDTH_BIT_12);
+  adc1_config_channel_atten((adc1_channel_t)adcChannel, ADC_ATTEN_DB_11);
+  adc1_ulp_enable();
+  gpio_num_t seatPin = (gpio_num_t)SEAT_BAR_PIN;
+  rtc_gpio_init(seatPin);
+  rtc_gpio_set_direction(seatPin, RTC_GPIO_MODE_INPUT_ONLY);
+  rtc_gpio_pulldown_dis(seatPin);
+  rtc_gpio_pullup_en(seatPin);
+  esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+
+  ulp_set_wakeup_period(0, ULP_SAMPLE_INTERVAL * 1000);
+  esp_sleep_enable_ulp_wakeup();
+  RTC_SLOW_MEM[VAR_MAGIC] = ULP_MAGIC;
+  result = ulp_run(ULP_DATA_WORDS);
+  if (result != ESP_OK) {
+    RTC_SLOW_MEM[VAR_MAGIC] = 0;
+    Serial.printf("ULP monitor: not started (%s)\n", esp_err_to_name(result));
+    return false;
+  }
+  Serial.printf("ULP monitor: every %lu ms, %u instructions, wake below %.2f V or on the seat bar\n",
+                (unsigned long)ULP_SAMPLE_INTERVAL, (unsigned)size, threshold * divider);
+  return true;
+}
+
+void stopSleepMonitor() {
+  CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+  delayMicroseconds(200);   // Let a run already started finish (a few µs of ADC)
+  if (rtc_gpio_is_valid_gpio((gpio_num_t)SEAT_BAR_PIN)) {
+    rtc_gpio_deinit((gpio_num_t)SEAT_BAR_PIN);
+  }
+
+  report = SleepMonitorReport();
+  if (RTC_SLOW_MEM[VAR_MAGIC] != ULP_MAGIC) {
+    return;   // Power-on, or the ULP was not started before this sleep
+  }
+  RTC_SLOW_MEM[VAR_MAGIC] = 0;
+
+  uint16_t wake = ulpWord(VAR_WAKE);
+  report.valid = true;
+  report.wakeReason = wake <= ULP_WAKE_LOW_BATTERY ? (UlpWakeReason)wake : ULP_WAKE_NONE;
+  report.samples = ulpWord(VAR_SAMPLES);
+  report.lastRaw = ulpWord(VAR_LAST);
+  report.minRaw = ulpWord(VAR_MIN);
+  report.maxRaw = ulpWord(VAR_MAX);
+
+  // Oldest first, ending with the current window if it has samples
+  uint16_t slot = (ulpWord(VAR_SLOT) - VAR_HISTORY) / 2;
+  if (slot >= ULP_HISTORY_SLOTS) {
+    return;
+  }
+  bool currentUsed = ulpWord(VAR_WINDOW) > 0;
+  uint16_t count = ulpWord(VAR_WINDOWS) + (currentUsed ? 1 : 0);
+  if (count > ULP_HISTORY_SLOTS) {
+    count = ULP_HISTORY_SLOTS;
+  }
+  uint16_t newest = currentUsed ? slot : (slot + ULP_HISTORY_SLOTS - 1) % ULP_HISTORY_SLOTS;
+  for (uint16_t i = 0; i < count; i++) {
+    uint16_t index = (newest + ULP_HISTORY_SLOTS - (count - 1 - i)) % ULP_HISTORY_SLOTS;
+    report.history[i].minRaw = ulpWord(VAR_HISTORY + 2 * index);
+    report.history[i].maxRaw = ulpWord(VAR_HISTORY + 2 * index + 1);
+  }
+  report.windows = (uint8_t)count;
+}
+
+const SleepMonitorReport& sleepMonitorReport() {
+  return report;
+}
+
+const char* ulpWakeReasonName(UlpWakeReason reason) {
+  switch (reason) {
+    case ULP_WAKE_NONE: return "none";
+    case ULP_WAKE_SEAT_BAR: return "seat_bar";
+    case ULP_WAKE_LOW_BATTERY: return "low_battery";
+  }
+  return "?";
+}
@@ -6,203 +6,240 @@
 #include "web_interface.h"
 #include "config.h"
 #include "hardware.h"
+#include "sensors.h"
+#include "adc_dma.h"
 #include "system_state.h"
 #include "safety.h"
 #include "settings.h"
+#include "commands.h"
+#include "logger.h"
+#include "trace.h"
+#include "status_report.h"
+#include "json_writer.h"
+#include "control_actions.h"
+#include "boot_profile.h"
+#include "resume_state.h"
+#include "wifi_station.h"
+#include "power_manager.h"
+#include "ulp_monitor.h"
+#include "task_monitor.h"
 #include <WiFi.h>
 #include <ESPAsyncWebServer.h>
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 #include <ElegantOTA.h>
 #include <Preferences.h>
+#include <memory>
+#include <vector>
 
-// WiFi credentials for the Access Point
+// WiFi credentials for the Access Point (the home network ones are settings)
 const char* ssid = "Bobcat-Control";
 const char* password = "bobcat123";
 
-// WiFi credentials for connecting to home network
-const char* home_ssid = "fabfarm";
-const char* home_password = "imakestuff";
-
 // Create AsyncWebServer object on port 80
 AsyncWebServer server(80);
 
+// Stream a JSON object straight into the response: `body` writes the fields
+template <typename F>
+static void sendJson(AsyncWebServerRequest *request, int code, F body) {
+    AsyncResponseStream *response = request->beginResponseStream("application/json", 512);
+    response->setCode(code);
+    JsonWriter<Print> json(*response);
+    json.beginObject();
+    body(json);
+    json.endObject();
+    request->send(response);
+}
+
+// Legacy GET endpoints: plain text, the sequence number to poll the
+// outcome with, 503 like /control when the queue is full
+static void sendLegacyCommand(AsyncWebServerRequest *request, CommandType type, const char* message) {
+    uint32_t sequence = submitCommand(type);
+    if (sequence == 0) {
+        request->send(503, "text/plain", "Command queue full - try again");
+        return;
+    }
+    char text[64];
+    snprintf(text, sizeof(text), "%s (seq %lu)", message, (unsigned long)sequence);
+    request->send(200, "text/plain", text);
+}
+
+static void sendResult(AsyncWebServerRequest *request, int code, const char* status, const char* message) {
+    sendJson(request, code, [status, message](JsonWriter<Print>& json) {
+        json.field(JSON_KEY("status"), status);
+        json.field(JSON_KEY("message"), message);
+    });
+}
+
+// snprintf onto the end of `buffer` (for messages built up piece by piece)
+static void appendf(char* buffer, size_t size, const char* format, ...) __attribute__((format(printf, 3, 4)));
+static void appendf(char* buffer, size_t size, const char* format, ...) {
+    size_t used = strlen(buffer);
+    if (used + 1 >= size) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer + used, size - used, format, args);
+    va_end(args);
+}
+
 void handleGetSettings(AsyncWebServerRequest *request) {
-    StaticJsonDocument<1024> doc;
-    
-    const BobcatSettings& settings = g_settingsManager.getSettings();
-    
-    // Engine Parameters (convert milliseconds to seconds for UI)
-    doc["glowDuration"] = settings.glowPlugDuration / 1000;
-    doc["crankingTimeout"] = settings.crankingTimeout / 1000;
-    doc["cooldownDuration"] = settings.cooldownDuration / 1000;
-    
-    // Alarm Thresholds
-    doc["maxTemp"] = settings.maxCoolantTemp;
-    doc["minOilPressure"] = settings.minOilPressure;
-    doc["minHydPressure"] = settings.minHydPressure;
-    doc["minVoltage"] = settings.minBatteryVoltage;
-    doc["maxVoltage"] = settings.maxBatteryVoltage;
-    
-    // WiFi Configuration (don't send password for security)
-    doc["wifiSSID"] = settings.wifiSSID;
-    
-    // Sensor Calibration (only threshold is user-configurable)
-    doc["fuelLevelLowThreshold"] = settings.fuelLevelLowThreshold;
-    doc["pressureScale"] = settings.pressureScale;
-    doc["hydPressureScale"] = settings.hydPressureScale;
-    
-    String jsonResponse;
-    serializeJson(doc, jsonResponse);
-    request->send(200, "application/json", jsonResponse);
+    const BobcatSettings settings = g_settingsManager.getSettings();
+
+    // Every SETTING_READ field of the schema, in UI units (seconds for
+    // durations); the password is never sent
+    sendJson(request, 200, [&settings](JsonWriter<Print>& json) {
+        for (const SettingDescriptor& setting : SETTINGS) {
+            if (setting.flags & SETTING_READ) {
+                writeSettingJson(json, setting, settings);
+            }
+        }
+    });
+}
+
+// Calibration puts skip values that are already stored; each returns the
+// number of flash writes it made
+static uint32_t putCalibrationFloat(Preferences& prefs, const char* key, float value) {
+    if (prefs.isKey(key) && prefs.getFloat(key) == value) {
+        return 0;
+    }
+    return prefs.putFloat(key, value) > 0 ? 1 : 0;
+}
+
+static uint32_t putCalibrationInt(Preferences& prefs, const char* key, int32_t value) {
+    if (prefs.isKey(key) && prefs.getInt(key) == value) {
+        return 0;
+    }
+    return prefs.putInt(key, value) > 0 ? 1 : 0;
 }
 
+// Numbers may arrive as JSON numbers or as strings (the old one-key form)
+static float settingNumber(JsonVariant value) {
+    const char* text = value.as<const char*>();
+    return text ? atof(text) : value.as<float>();
+}
+
+// Write one value into `settings` through its schema entry; false when the
+// value is outside the setting's limits
+static bool setSettingFromJson(BobcatSettings& settings, const SettingDescriptor& setting, JsonVariant value) {
+    if (setting.type == SETTING_TEXT) {
+        const char* text = value.as<const char*>();
+        return setSettingText(settings, setting, text ? text : "");
+    }
+    return setSettingValue(settings, setting, settingNumber(value));
+}
+
+static const SettingDescriptor* writableSetting(const char* key) {
+    const SettingDescriptor* setting = findSetting(key, strlen(key));
+    return (setting != nullptr && (setting->flags & SETTING_WRITE)) ? setting : nullptr;
+}
+
+// POST /api/settings: either {"key": ..., "value": ...} (one setting, text
+// reply) or an object of any number of settings, validated together and
+// written to flash once after SETTINGS_COMMIT_DELAY
 void onSetSettingBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    // Bodies that span several chunks are refused once, on the first chunk;
+    // the later chunks of the same request must not reply again
+    if (len != total) {
+        if (index == 0) {
+            request->send(413, "text/plain", "Settings request too large");
+        }
+        return;
+    }
     DynamicJsonDocument doc(1024);
-    if (deserializeJson(doc, (const char*)data)) {
+    if (deserializeJson(doc, (const char*)data, len)) {
         request->send(400, "text/plain", "Invalid JSON");
         return;
     }
 
-    const char* key = doc["key"];
-    const char* value = doc["value"];
+    BobcatSettings candidate = g_settingsManager.getSettings();
+    char text[96];
 
-    if (key && value) {
-        bool success = false;
-        String message = "Setting updated";
-        
-        // Convert value to appropriate type and update settings
-        if (strcmp(key, "glowDuration") == 0) {
-            uint32_t seconds = atoi(value);
-            const BobcatSettings& current = g_settingsManager.getSettings();
-            success = g_settingsManager.updateEngineSettings(seconds * 1000, current.crankingTimeout, current.cooldownDuration);
-        } else if (strcmp(key, "crankingTimeout") == 0) {
-            uint32_t seconds = atoi(value);
-            const BobcatSettings& current = g_settingsManager.getSettings();
-            success = g_settingsManager.updateEngineSettings(current.glowPlugDuration, seconds * 1000, current.cooldownDuration);
-        } else if (strcmp(key, "cooldownDuration") == 0) {
-            uint32_t seconds = atoi(value);
-            const BobcatSettings& current = g_settingsManager.getSettings();
-            success = g_settingsManager.updateEngineSettings(current.glowPlugDuration, current.crankingTimeout, seconds * 1000);
-        } else if (strcmp(key, "maxTemp") == 0) {
-            int16_t temp = atoi(value);
-            const BobcatSettings& current = g_settingsManager.getSettings();
-            success = g_settingsManager.updateAlarmThresholds(temp, current.minOilPressure, current.minBatteryVoltage, current.maxBatteryVoltage);
-        } else if (strcmp(key, "minOilPressure") == 0) {
-            int16_t pressure = atoi(value);
-            const BobcatSettings& current = g_settingsManager.getSettings();
-            success = g_settingsManager.updateAlarmThresholds(current.maxCoolantTemp, pressure, current.minBatteryVoltage, current.maxBatteryVoltage);
-        } else if (strcmp(key, "minHydPressure") == 0) {
-            int16_t pressure = atoi(value);
-            success = g_settingsManager.updateHydraulicThreshold(pressure);
-        } else if (strcmp(key, "minVoltage") == 0) {
-            float voltage = atof(value);
-            const BobcatSettings& current = g_settingsManager.getSettings();
-            success = g_settingsManager.updateAlarmThresholds(current.maxCoolantTemp, current.minOilPressure, voltage, current.maxBatteryVoltage);
-        } else if (strcmp(key, "maxVoltage") == 0) {
-            float voltage = atof(value);
-            const BobcatSettings& current = g_settingsManager.getSettings();
-            success = g_settingsManager.updateAlarmThresholds(current.maxCoolantTemp, current.minOilPressure, current.minBatteryVoltage, voltage);
-        } else if (strcmp(key, "wifiSSID") == 0) {
-            const BobcatSettings& current = g_settingsManager.getSettings();
-            success = g_settingsManager.updateWifiSettings(value, current.wifiPassword);
-        } else if (strcmp(key, "wifiPassword") == 0) {
-            const BobcatSettings& current = g_settingsManager.getSettings();
-            success = g_settingsManager.updateWifiSettings(current.wifiSSID, value);
-        } else if (strcmp(key, "fuelLevelLowThreshold") == 0) {
-            uint8_t threshold = atoi(value);
-            const BobcatSettings& current = g_settingsManager.getSettings();
-            success = g_settingsManager.updateSensorCalibration(current.tempSensorOffset, current.pressureScale, current.fuelLevelEmpty, current.fuelLevelFull, threshold);
+    const char* key = doc["key"];
+    if (key) {
+        const SettingDescriptor* setting = writableSetting(key);
+        if (doc["value"].isNull()) {
+            request->send(400, "text/plain", "Missing key or value in JSON");
+        } else if (setting == nullptr) {
+            snprintf(text, sizeof(text), "Unknown setting key: %s", key);
+            request->send(400, "text/plain", text);
+        } else if (!setSettingFromJson(candidate, *setting, doc["value"]) || !g_settingsManager.applySettings(candidate)) {
+            snprintf(text, sizeof(text), "Failed to update setting: %s", key);
+            request->send(400, "text/plain", text);
         } else {
-            message = "Unknown setting key: " + String(key);
+            wifiSettingsChanged();
+            request->send(200, "text/plain", "Setting updated");
         }
-        
-        if (success) {
-            g_settingsManager.saveSettings();
-            request->send(200, "text/plain", message);
-        } else {
-            request->send(400, "text/plain", "Failed to update setting: " + String(key));
+        return;
+    }
+
+    // Keys not in the schema (or read-only) are ignored
+    int applied = 0;
+    for (JsonPair pair : doc.as<JsonObject>()) {
+        const SettingDescriptor* setting = writableSetting(pair.key().c_str());
+        if (setting == nullptr) {
+            continue;
         }
+        if (!setSettingFromJson(candidate, *setting, pair.value())) {
+            snprintf(text, sizeof(text), "Settings rejected - %s is out of range; nothing was changed", setting->name);
+            sendResult(request, 400, "error", text);
+            return;
+        }
+        applied++;
+    }
+    if (applied == 0) {
+        sendResult(request, 400, "error", "No known settings in request");
+    } else if (!g_settingsManager.applySettings(candidate)) {
+        sendResult(request, 400, "error", "Settings rejected - values are inconsistent; nothing was changed");
     } else {
-        request->send(400, "text/plain", "Missing key or value in JSON");
+        wifiSettingsChanged();
+        snprintf(text, sizeof(text), "%d settings saved", applied);
+        sendResult(request, 200, "success", text);
     }
 }
 
 void handleStatus(AsyncWebServerRequest *request) {
-    AsyncResponseStream *response = request->beginResponseStream("application/json");
-    DynamicJsonDocument json(1024);
-
-    json["systemState"] = systemStateToString(g_systemState.currentState);
+    sendJson(request, 200, [](JsonWriter<Print>& json) {
+        json.field(JSON_KEY("systemState"), systemStateToString(g_systemState.currentState));
 
-    if (WiFi.status() == WL_CONNECTED) {
-        json["homeNetworkStatus"] = WiFi.localIP().toString();
-    } else {
-        json["homeNetworkStatus"] = "Not Connected";
-    }
-    json["apStatus"] = "Active at " + WiFi.softAPIP().toString();
-
-    serializeJson(json, *response);
-    request->send(response);
+        if (WiFi.status() == WL_CONNECTED) {
+            IPAddress ip = WiFi.localIP();
+            json.fieldf(JSON_KEY("homeNetworkStatus"), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+        } else {
+            json.field(JSON_KEY("homeNetworkStatus"), "Not Connected");
+        }
+        IPAddress apIp = WiFi.softAPIP();
+        json.fieldf(JSON_KEY("apStatus"), "Active at %u.%u.%u.%u", apIp[0], apIp[1], apIp[2], apIp[3]);
+    });
 }
 
 // Main function to set up the web server
 void setupWebServer() {
     // Initialize LittleFS
-    if (!LittleFS.begin()) {
+    startBootPhase(BOOT_PHASE_FILESYSTEM);
+    bool mounted = LittleFS.begin();
+    endBootPhase(BOOT_PHASE_FILESYSTEM);
+    if (!mounted) {
         Serial.println("An Error has occurred while mounting LittleFS");
         return;
     }
 
-    // Set WiFi to dual mode (Station + Access Point)
+    // Access point first: it is up within milliseconds and is all the
+    // controller needs. The home network joins in the background.
+    startBootPhase(BOOT_PHASE_WIFI_AP);
     WiFi.mode(WIFI_AP_STA);
-    
-    // Try to connect to home network first
-    Serial.println("Connecting to home network...");
-    WiFi.begin(home_ssid, home_password);
-    
-    // Wait up to 10 seconds for connection
-    int wifi_timeout = 0;
-    while (WiFi.status() != WL_CONNECTED && wifi_timeout < 20) {
-        delay(500);
-        Serial.print(".");
-        wifi_timeout++;
-    }
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println();
-        Serial.println("Connected to home network!");
-        Serial.print("Home network IP: ");
-        Serial.println(WiFi.localIP());
-        Serial.print("SSID: ");
-        Serial.println(home_ssid);
-    } else {
-        Serial.println();
-        Serial.println("Failed to connect to home network - continuing with AP only");
-    }
-    
-    // Always start the Access Point (standalone mode)
     WiFi.softAP(ssid, password);
-    Serial.println("Access Point Started");
-    Serial.print("AP SSID: ");
-    Serial.println(ssid);
-    Serial.print("AP IP address: ");
-    Serial.println(WiFi.softAPIP());
-    
-    // Print connection summary
-    Serial.println("=== WiFi Status ===");
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.print("Home Network: CONNECTED (");
-        Serial.print(WiFi.localIP());
-        Serial.println(")");
-    } else {
-        Serial.println("Home Network: DISCONNECTED");
-    }
     Serial.print("Access Point: ACTIVE (");
+    Serial.print(ssid);
+    Serial.print(" at ");
     Serial.print(WiFi.softAPIP());
     Serial.println(")");
-    Serial.println("==================");
+    startWifiStation();
+    endBootPhase(BOOT_PHASE_WIFI_AP);
 
     // Define the routes for the web server
+    startBootPhase(BOOT_PHASE_ROUTES);
 
     // Captive portal - redirect all requests to our main page
     server.onNotFound([](AsyncWebServerRequest *request){
@@ -256,22 +293,19 @@ void setupWebServer() {
     // Handle the start button press (keep for backward compatibility)
     server.on("/start", HTTP_GET, [](AsyncWebServerRequest *request){
         Serial.println("Legacy start endpoint called");
-        virtualStartButton();
-        request->send(200, "text/plain", "Start request received");
+        sendLegacyCommand(request, CMD_LEGACY_START, "Start request received");
     });
 
     // Handle the power on button press (keep for backward compatibility)
     server.on("/power_on", HTTP_GET, [](AsyncWebServerRequest *request){
         Serial.println("Legacy power_on endpoint called");
-        virtualPowerOnButton();
-        request->send(200, "text/plain", "Power on request received");
+        sendLegacyCommand(request, CMD_POWER_ON, "Power on request received");
     });
 
     // Handle the power off button press (keep for backward compatibility)
     server.on("/power_off", HTTP_GET, [](AsyncWebServerRequest *request){
         Serial.println("Legacy power_off endpoint called");
-        virtualPowerOffButton();
-        request->send(200, "text/plain", "Power off request received");
+        sendLegacyCommand(request, CMD_POWER_OFF, "Power off request received");
     });
 
     // Note: No engine stop endpoint - engine must be stopped manually with lever
@@ -279,278 +313,231 @@ void setupWebServer() {
     // Handle the lights toggle (keep for backward compatibility)
     server.on("/toggle_lights", HTTP_GET, [](AsyncWebServerRequest *request){
         Serial.println("Legacy toggle_lights endpoint called");
-        virtualLightsButton();
-        request->send(200, "text/plain", "Lights toggled");
+        sendLegacyCommand(request, CMD_TOGGLE_LIGHTS, "Lights toggled");
     });
 
     // Handle the override button press (keep for backward compatibility)
     server.on("/override", HTTP_GET, [](AsyncWebServerRequest *request){
         Serial.println("Legacy override endpoint called");
-        overrideStart();
-        request->send(200, "text/plain", "Override request received");
+        sendLegacyCommand(request, CMD_OVERRIDE_START, "Override request received");
     });
 
-    // Handle unified control endpoint for the new dashboard
+    // Handle unified control endpoint for the new dashboard; actions are
+    // looked up in the compile-time table in include/control_actions.h
     server.on("/control", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
         [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
-            // Parse JSON command
-            StaticJsonDocument<256> doc;
-            DeserializationError error = deserializeJson(doc, (char*)data, len);
-            
-            if (error) {
+            // Parse the command in place (bodies are a few dozen bytes, one
+            // chunk); a multi-chunk body is refused once, on its first chunk
+            if (len != total) {
+                if (index == 0) {
+                    request->send(400, "application/json", "{\"success\":false,\"message\":\"Invalid JSON\"}");
+                }
+                return;
+            }
+            ControlActions::Request command;
+            if (!ControlActions::parse((const char*)data, len, command)) {
                 Serial.println("Failed to parse JSON command");
                 request->send(400, "application/json", "{\"success\":false,\"message\":\"Invalid JSON\"}");
                 return;
             }
-            
-            String action = doc["action"];
+
             Serial.print("Web command received: ");
-            Serial.println(action);
-            
-            // Update activity timer for any web command
-            updateActivityTimer();
-            
+            Serial.write((const uint8_t*)command.action, command.actionLength);
+            Serial.println();
+
             bool success = true;
-            String message = "Command executed";
-            
-            // Execute the requested action
-            if (action == "key_position") {
-                int requestedPosition = doc["position"];
-                Serial.print("Key position command: ");
-                Serial.print(g_systemState.keyPosition);
-                Serial.print(" -> ");
-                Serial.println(requestedPosition);
-                
-                // Simply accept the command - let the state machine handle all logic
-                if (requestedPosition >= 0 && requestedPosition <= 3) {
-                    g_systemState.keyPosition = requestedPosition;
-                    message = "Key position command accepted: " + String(requestedPosition);
-                    Serial.print("Key position set to: ");
-                    Serial.println(requestedPosition);
-                } else {
-                    success = false;
-                    message = "Invalid key position: " + String(requestedPosition);
-                }
-            } else if (action == "key_start_hold") {
-                bool held = doc["held"];
-                Serial.print("Start key ");
-                Serial.println(held ? "held" : "released");
-                
-                g_systemState.keyStartHeld = held;
-                if (held) {
-                    g_systemState.startHoldTime = millis();
-                    g_systemState.keyPosition = 3; // Move to START position
-                } else {
-                    g_systemState.keyPosition = 2; // Return to GLOW position when released
-                }
-                message = held ? "Start key held" : "Start key released";
-            } else if (action == "emergency_stop") {
-                // Force emergency stop state
-                g_systemState.emergencyStopPressed = true;
-                Serial.println("EMERGENCY STOP activated via web interface");
-                message = "Emergency stop activated";
-            } else if (action == "lights") {
-                g_systemState.lightsTogglePressed = true;
-                message = "Lights toggled";
-            } else if (action == "start") {
-                // Legacy support - keep for backward compatibility
-                virtualStartButton();
-                message = "Legacy start command";
-            } else if (action == "power_on") {
-                // Legacy support
-                virtualPowerOnButton();
-                message = "Legacy power on command";
-            } else if (action == "shutdown") {
-                // Legacy support
-                virtualPowerOffButton();
-                message = "Legacy shutdown command";
-            } else if (action == "sleep_now") {
-                // Immediate sleep command
-                if (checkSleepConditions(true)) { // Pass true for manual sleep
-                    message = "Entering sleep mode immediately";
-                    Serial.println("Manual sleep command received");
-                    // Send response first, then sleep
-                    StaticJsonDocument<256> response;
-                    response["success"] = true;
-                    response["message"] = message;
-                    String jsonResponse;
-                    serializeJson(response, jsonResponse);
-                    request->send(200, "application/json", jsonResponse);
-                    delay(100); // Give time for response to send
-                    enterDeepSleep();
-                    return; // Won't reach here
+            const char* message = "Command executed";
+            char text[64];   // Formatted messages
+            uint32_t sequence = 0;
+
+            // Validate here, then hand the command to the control loop
+            const ControlActions::Action* action = ControlActions::find(command.action, command.actionLength);
+            if (action == nullptr) {
+                success = false;
+                snprintf(text, sizeof(text), "Unknown action: %.*s", (int)command.actionLength,
+                         command.action ? command.action : "");
+                message = text;
+            } else if (action->arg == ControlActions::ARG_POSITION) {
+                if (command.position >= 0 && command.position <= 3) {
+                    sequence = submitCommand(action->command, command.position);
+                    snprintf(text, sizeof(text), "Key position command accepted: %d", (int)command.position);
                 } else {
                     success = false;
-                    message = "Cannot sleep - unsafe conditions (engine running or system active)";
+                    snprintf(text, sizeof(text), "Invalid key position: %d", (int)command.position);
                 }
-            } else if (action == "toggle_sleep_mode") {
-                // Toggle sleep mode enable/disable
-                g_systemState.sleepModeEnabled = !g_systemState.sleepModeEnabled;
-                message = g_systemState.sleepModeEnabled ? "Sleep mode enabled" : "Sleep mode disabled";
+                message = text;
+            } else if (action->arg == ControlActions::ARG_HELD) {
+                sequence = submitCommand(action->command, command.held ? 1 : 0);
+                message = command.held ? "Start key held" : "Start key released";
+            } else if (action->command == CMD_SLEEP_NOW && !checkSleepConditions(true)) {
+                // Pre-check so the client gets an immediate answer; the control
+                // loop checks again before actually sleeping
+                success = false;
+                message = "Cannot sleep - unsafe conditions (engine running or system active)";
             } else {
+                sequence = submitCommand(action->command);
+                message = action->message;
+                if (action->command == CMD_TOGGLE_SLEEP_MODE) {
+                    message = g_systemState.sleepModeEnabled ? "Sleep mode disabled" : "Sleep mode enabled";
+                }
+            }
+
+            bool queueFull = success && sequence == 0;
+            if (queueFull) {
                 success = false;
-                message = "Unknown action: " + action;
+                message = "Command queue full - try again";
             }
-            
-            // Send response
-            StaticJsonDocument<256> response;
-            response["success"] = success;
-            response["message"] = message;
-            
-            String jsonResponse;
-            serializeJson(response, jsonResponse);
-            request->send(success ? 200 : 400, "application/json", jsonResponse);
-        });
 
-    // Provide the system status as a JSON object
-    server.on("/status", HTTP_GET, [](AsyncWebServerRequest *request){
-        StaticJsonDocument<512> doc;
-        doc["state"] = systemStateToString(g_systemState.currentState);
-        doc["status"] = systemStateToString(g_systemState.currentState); // Keep for backward compatibility
-        doc["temperature"] = readEngineTemp();
-        doc["pressure"] = readOilPressure();
-        doc["battery"] = readBatteryVoltage();
-        doc["battery_voltage"] = readBatteryVoltage();
-        doc["engine_temp"] = readEngineTemp();
-        doc["oil_pressure"] = readOilPressure();
-        doc["hyd_pressure"] = readHydraulicPressure();
-        
-        // Add state flags for dashboard
-        doc["lights_on"] = digitalRead(LIGHTS_PIN);
-        doc["main_power_on"] = digitalRead(MAIN_POWER_PIN);
-        doc["glow_plugs_on"] = digitalRead(GLOW_PLUGS_PIN);
-        doc["starter_on"] = digitalRead(STARTER_PIN);
-        doc["engine_fault"] = (g_systemState.currentState == ERROR);
-        doc["low_oil_pressure"] = (g_systemState.currentState == LOW_OIL_PRESSURE);
-        doc["high_temperature"] = (g_systemState.currentState == HIGH_TEMPERATURE);
-        doc["low_battery"] = (readBatteryVoltage() < 11.5);
-        
-        // Fuel level from sensor (or mock if not connected)
-        doc["fuel_level"] = readFuelLevel();
-        doc["engine_hours"] = 1234;
-        
-        // Add glow plug countdown (whenever glow plugs are on and timer is running)
-        bool glowPlugsActive = digitalRead(GLOW_PLUGS_PIN);
-        doc["glow_active"] = glowPlugsActive;
-        
-        if (glowPlugsActive && g_systemState.glowPlugStartTime > 0) {
-            unsigned long elapsed = millis() - g_systemState.glowPlugStartTime;
-            if (elapsed < GLOW_PLUG_DURATION) {
-                unsigned long remaining = (GLOW_PLUG_DURATION - elapsed) / 1000;
-                doc["countdown"] = remaining;
-            } else {
-                doc["countdown"] = 0;  // Timer expired but still on
+            // Send response, formatted on the stack
+            char body[160];
+            JsonBufferSink sink(body, sizeof(body));
+            JsonWriter<JsonBufferSink> json(sink);
+            json.beginObject();
+            json.field(JSON_KEY("success"), success);
+            json.field(JSON_KEY("message"), message);
+            if (sequence != 0) {
+                json.field(JSON_KEY("seq"), sequence);
             }
-        } else {
-            doc["countdown"] = 0;
-        }
-        
-        // Add key position information
-        doc["key_position"] = g_systemState.keyPosition;
-        doc["start_key_held"] = g_systemState.keyStartHeld;
-        
-        // Add power management information
-        doc["sleep_mode_enabled"] = g_systemState.sleepModeEnabled;
-        unsigned long timeSinceActivity = millis() - g_systemState.lastActivityTime;
-        doc["time_since_activity"] = timeSinceActivity / 1000; // Convert to seconds
-        doc["sleep_eligible"] = checkSleepConditions();
-        doc["time_until_sleep"] = max(0UL, (SLEEP_TIMEOUT - timeSinceActivity) / 1000); // Seconds until sleep
-        
-        // Add WiFi status information
-        doc["wifi_connected"] = (WiFi.status() == WL_CONNECTED);
-        if (WiFi.status() == WL_CONNECTED) {
-            doc["wifi_ip"] = WiFi.localIP().toString();
-            doc["wifi_ssid"] = WiFi.SSID();
-        }
-        doc["ap_ip"] = WiFi.softAPIP().toString();
-        doc["ap_clients"] = WiFi.softAPgetStationNum();
+            json.endObject();
+            request->send(success ? 200 : (queueFull ? 503 : 400), "application/json", body);
+        });
 
-        String jsonResponse;
-        serializeJson(doc, jsonResponse);
-        request->send(200, "application/json", jsonResponse);
+    // Outcome of a queued control command
+    server.on("/api/command", HTTP_GET, [](AsyncWebServerRequest *request){
+        if (!request->hasParam("seq")) {
+            request->send(400, "application/json", "{\"success\":false,\"message\":\"Missing seq parameter\"}");
+            return;
+        }
+        uint32_t sequence = request->getParam("seq")->value().toInt();
+        sendJson(request, 200, [sequence](JsonWriter<Print>& json) {
+            json.field(JSON_KEY("seq"), sequence);
+            json.field(JSON_KEY("result"), commandResultToString(getCommandResult(sequence)));
+            json.field(JSON_KEY("last_applied"), lastAppliedCommandSequence());
+        });
     });
 
+    // System status: /status (cached body, ETag, ?since= long-poll) and the
+    // /events push stream that replaces polling it
+    setupStatusEndpoints(server);
+
     // Raw sensor data endpoint for calibration
     server.on("/api/raw-sensors", HTTP_GET, [](AsyncWebServerRequest *request){
-        StaticJsonDocument<768> doc;
-        
-        // Read raw ADC values (0-4095)
-        int batteryRaw = analogRead(BATTERY_VOLTAGE_PIN);
-        int temperatureRaw = analogRead(ENGINE_TEMP_PIN);
-        int pressureRaw = analogRead(OIL_PRESSURE_PIN);
-        int fuelRaw = analogRead(FUEL_LEVEL_PIN);
-        int hydRaw = analogRead(HYD_PRESSURE_PIN);
-        
-        doc["battery_raw"] = batteryRaw;
-        doc["temperature_raw"] = temperatureRaw;
-        doc["pressure_raw"] = pressureRaw;
-        doc["fuel_raw"] = fuelRaw;
-        doc["hydraulic_raw"] = hydRaw;
-        
-        // Sensor diagnostics
-        doc["battery_status"] = (batteryRaw > 100 && batteryRaw < 4000) ? "OK" : "CHECK";
-        doc["temperature_status"] = (temperatureRaw > 10 && temperatureRaw < 4000) ? "OK" : "CHECK";
-    doc["pressure_status"] = (pressureRaw < 4000) ? "OK" : "BROKEN";
-    doc["hydraulic_status"] = (hydRaw < 4000) ? "OK" : "BROKEN";
-        doc["fuel_status"] = (fuelRaw > 10 && fuelRaw < 4090) ? "OK" : "CHECK";
-        
-        // Detailed diagnostics for pressure sensor
-        if (pressureRaw > 4000) {
-            doc["pressure_diagnostic"] = "SENSOR DISCONNECTED/BROKEN - Reading mega ohms";
-        } else if (pressureRaw < 10) {
-            doc["pressure_diagnostic"] = "SENSOR SHORT CIRCUIT - Very low resistance";
-        } else {
-            doc["pressure_diagnostic"] = "Normal operation";
+        SensorSnapshot sensors = getSensorSnapshot();
+        
+        // Raw ADC values (0-4095) from the latest sample
+        int batteryRaw = sensors.batteryRaw;
+        int temperatureRaw = sensors.temperatureRaw;
+        int pressureRaw = sensors.pressureRaw;
+        int fuelRaw = sensors.fuelRaw;
+        int hydRaw = sensors.hydraulicRaw;
+        
+        sendJson(request, 200, [&](JsonWriter<Print>& json) {
+            json.field(JSON_KEY("battery_raw"), batteryRaw);
+            json.field(JSON_KEY("temperature_raw"), temperatureRaw);
+            json.field(JSON_KEY("pressure_raw"), pressureRaw);
+            json.field(JSON_KEY("fuel_raw"), fuelRaw);
+            json.field(JSON_KEY("hydraulic_raw"), hydRaw);
+
+            // Sensor diagnostics
+            json.field(JSON_KEY("battery_status"), (batteryRaw > 100 && batteryRaw < 4000) ? "OK" : "CHECK");
+            json.field(JSON_KEY("temperature_status"), (temperatureRaw > 10 && temperatureRaw < 4000) ? "OK" : "CHECK");
+            json.field(JSON_KEY("pressure_status"), (pressureRaw < 4000) ? "OK" : "BROKEN");
+            json.field(JSON_KEY("hydraulic_status"), (hydRaw < 4000) ? "OK" : "BROKEN");
+            json.field(JSON_KEY("fuel_status"), (fuelRaw > 10 && fuelRaw < 4090) ? "OK" : "CHECK");
+
+            // Detailed diagnostics for pressure sensor
+            if (pressureRaw > 4000) {
+                json.field(JSON_KEY("pressure_diagnostic"), "SENSOR DISCONNECTED/BROKEN - Reading mega ohms");
+            } else if (pressureRaw < 10) {
+                json.field(JSON_KEY("pressure_diagnostic"), "SENSOR SHORT CIRCUIT - Very low resistance");
+            } else {
+                json.field(JSON_KEY("pressure_diagnostic"), "Normal operation");
+            }
+
+            // Include current runtime calibration constants (from preferences, not static config)
+            const CalibrationConstants calibration = getCalibration();
+            json.field(JSON_KEY("battery_divider"), calibration.batteryDivider, 6);
+            json.field(JSON_KEY("temp_offset"), TEMP_SENSOR_OFFSET);  // Not calibrated yet
+            json.field(JSON_KEY("temp_scale"), calibration.tempScale, 6);
+            json.field(JSON_KEY("pressure_offset"), OIL_PRESSURE_OFFSET);  // Not calibrated yet
+            json.field(JSON_KEY("pressure_scale"), calibration.pressureScale, 6);
+            json.field(JSON_KEY("hyd_pressure_scale"), calibration.hydPressureScale, 6);
+            json.field(JSON_KEY("fuel_empty"), calibration.fuelEmpty);
+            json.field(JSON_KEY("fuel_full"), calibration.fuelFull);
+            json.field(JSON_KEY("calibration_generation"), calibrationGeneration());
+
+            // Include calculated values for comparison
+            json.field(JSON_KEY("battery_calculated"), sensors.batteryVoltage);
+            json.field(JSON_KEY("temperature_calculated"), sensors.engineTemp);
+            json.field(JSON_KEY("pressure_calculated"), sensors.oilPressureOk ? 100.0 : 0.0);
+            json.field(JSON_KEY("fuel_calculated"), sensors.fuelLevel);
+            json.field(JSON_KEY("hydraulic_calculated"), sensors.hydPressureOk ? 100.0 : 0.0);
+            json.field(JSON_KEY("sample_age_ms"), millis() - sensors.timestampMs);
+            json.field(JSON_KEY("adc_dma_running"), isAdcDmaRunning());
+            json.field(JSON_KEY("adc_dma_frames"), adcDmaFramesRead());
+            json.field(JSON_KEY("log_records_dropped"), logRecordsDropped());
+            json.field(JSON_KEY("trace_records_dropped"), traceRecordsDropped());
+
+            // Flash writes (settings are committed after a quiet period)
+            const FlashWriteStats flash = g_settingsManager.getFlashStats();
+            json.field(JSON_KEY("settings_commits"), flash.settingsCommits);
+            json.field(JSON_KEY("settings_coalesced"), flash.coalescedChanges);
+            json.field(JSON_KEY("settings_pending"), g_settingsManager.isDirty());
+            json.field(JSON_KEY("settings_commit_us"), flash.lastCommitUs);
+            json.field(JSON_KEY("settings_commit_max_us"), flash.maxCommitUs);
+            json.field(JSON_KEY("calibration_writes"), flash.calibrationWrites);
+            json.field(JSON_KEY("settings_generation"), g_settingsManager.generation());
+            json.field(JSON_KEY("boot_to_first_tick_ms"), bootMilestoneUs(BOOT_FIRST_TICK) / 1000);
+        });
+    });
+
+    // Control input trace for host replay (see include/trace.h);
+    // ?reset=1 starts a fresh recording after the download
+    server.on("/api/trace", HTTP_GET, [](AsyncWebServerRequest *request){
+        // The copy is taken up front; the control task keeps recording meanwhile
+        std::shared_ptr<std::vector<uint8_t>> trace = std::make_shared<std::vector<uint8_t>>();
+        size_t len = 0;
+        for (int attempt = 0; attempt < 3 && len == 0; attempt++) {
+            trace->resize(traceExportSize());   // Grows if a tick finished in between
+            len = traceExport(trace->data(), trace->size());
         }
-        
-        // Include current runtime calibration constants (from preferences, not static config)
-        doc["battery_divider"] = runtime_battery_divider;
-        doc["temp_offset"] = TEMP_SENSOR_OFFSET;  // Not calibrated yet
-        doc["temp_scale"] = runtime_temp_scale;
-        doc["pressure_offset"] = OIL_PRESSURE_OFFSET;  // Not calibrated yet
-        doc["pressure_scale"] = runtime_pressure_scale;
-        doc["hyd_pressure_scale"] = runtime_hyd_pressure_scale;
-        doc["fuel_empty"] = runtime_fuel_empty;
-        doc["fuel_full"] = runtime_fuel_full;
-        
-        // Include calculated values for comparison
-        doc["battery_calculated"] = readBatteryVoltage();
-        doc["temperature_calculated"] = readEngineTemp();
-        doc["pressure_calculated"] = readOilPressure();
-        doc["fuel_calculated"] = readFuelLevel();
-        doc["hydraulic_calculated"] = readHydraulicPressure();
-        
-        String jsonResponse;
-        serializeJson(doc, jsonResponse);
-        request->send(200, "application/json", jsonResponse);
+        trace->resize(len);
+        if (request->hasParam("reset")) {
+            traceReset();
+        }
+
+        AsyncWebServerResponse *response = request->beginResponse("application/octet-stream", trace->size(),
+            [trace](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                size_t len = std::min(maxLen, trace->size() - index);
+                memcpy(buffer, trace->data() + index, len);
+                return len;
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=\"bobcat.trace\"");
+        request->send(response);
     });
 
     // Simple calibration endpoint - all logic in C++
     server.on("/api/auto-calibrate", HTTP_POST, [](AsyncWebServerRequest *request){
-        StaticJsonDocument<256> responseDoc;
-        
         if (!request->hasParam("sensor", true) || !request->hasParam("actual_value", true)) {
-            responseDoc["status"] = "error";
-            responseDoc["message"] = "Missing sensor or actual_value parameter";
-            String jsonResponse;
-            serializeJson(responseDoc, jsonResponse);
-            request->send(400, "application/json", jsonResponse);
+            sendResult(request, 400, "error", "Missing sensor or actual_value parameter");
             return;
         }
         
-        String sensor = request->getParam("sensor", true)->value();
+        const String& sensor = request->getParam("sensor", true)->value();
         float actualValue = request->getParam("actual_value", true)->value().toFloat();
         
-        // Get current raw sensor readings
-        int batteryRaw = analogRead(BATTERY_VOLTAGE_PIN);
-        int temperatureRaw = analogRead(ENGINE_TEMP_PIN);
-        int pressureRaw = analogRead(OIL_PRESSURE_PIN);
-        int fuelRaw = analogRead(FUEL_LEVEL_PIN);
-        int hydRaw = analogRead(HYD_PRESSURE_PIN);
+        // Current raw sensor readings from the latest sample
+        SensorSnapshot sensors = getSensorSnapshot();
+        int batteryRaw = sensors.batteryRaw;
+        int temperatureRaw = sensors.temperatureRaw;
+        int pressureRaw = sensors.pressureRaw;
+        int fuelRaw = sensors.fuelRaw;
+        int hydRaw = sensors.hydraulicRaw;
         
         bool calibrationApplied = false;
-        String calibrationDetails = "";
+        char calibrationDetails[64] = "";
         
+        uint32_t writes = 0;
         Preferences prefs;
         prefs.begin("calibration", false);
         
@@ -558,8 +545,8 @@ void setupWebServer() {
             // Battery voltage calibration: new_divider = actual_voltage / raw_adc_value
             float newDivider = actualValue / batteryRaw;
             if (newDivider > 0.0001 && newDivider < 1.0) {
-                prefs.putFloat("battery_div", newDivider);
-                calibrationDetails = "Battery divider: " + String(newDivider, 6);
+                writes += putCalibrationFloat(prefs, "battery_div", newDivider);
+                snprintf(calibrationDetails, sizeof(calibrationDetails), "Battery divider: %.6f", newDivider);
                 calibrationApplied = true;
             }
         }
@@ -568,8 +555,8 @@ void setupWebServer() {
             float baseTemp = 150.0;
             float newScale = (baseTemp - actualValue) / temperatureRaw;
             if (newScale > 0.001 && newScale < 10.0) {
-                prefs.putFloat("temp_scale", newScale);
-                calibrationDetails = "Temperature scale: " + String(newScale, 6);
+                writes += putCalibrationFloat(prefs, "temp_scale", newScale);
+                snprintf(calibrationDetails, sizeof(calibrationDetails), "Temperature scale: %.6f", newScale);
                 calibrationApplied = true;
             }
         }
@@ -577,16 +564,16 @@ void setupWebServer() {
             // Pressure calibration: scale = actual_pressure / raw_adc
             float newScale = actualValue / pressureRaw;
             if (newScale > 0.001 && newScale < 10.0) {
-                prefs.putFloat("pressure_scale", newScale);
-                calibrationDetails = "Pressure scale: " + String(newScale, 6);
+                writes += putCalibrationFloat(prefs, "pressure_scale", newScale);
+                snprintf(calibrationDetails, sizeof(calibrationDetails), "Pressure scale: %.6f", newScale);
                 calibrationApplied = true;
             }
         }
         else if (sensor == "hydraulic" && hydRaw < 4000) {
             float newScale = actualValue / hydRaw;
             if (newScale > 0.001 && newScale < 10.0) {
-                prefs.putFloat("hyd_pressure_scale", newScale);
-                calibrationDetails = "Hydraulic pressure scale: " + String(newScale, 6);
+                writes += putCalibrationFloat(prefs, "hyd_pressure_scale", newScale);
+                snprintf(calibrationDetails, sizeof(calibrationDetails), "Hydraulic pressure scale: %.6f", newScale);
                 calibrationApplied = true;
             }
         }
@@ -594,13 +581,13 @@ void setupWebServer() {
             // Fuel level calibration
             if (actualValue <= 10) {
                 // Low fuel reading - set as empty
-                prefs.putInt("fuel_empty", fuelRaw);
-                calibrationDetails = "Fuel empty: " + String(fuelRaw);
+                writes += putCalibrationInt(prefs, "fuel_empty", fuelRaw);
+                snprintf(calibrationDetails, sizeof(calibrationDetails), "Fuel empty: %d", fuelRaw);
                 calibrationApplied = true;
             } else if (actualValue >= 90) {
                 // High fuel reading - set as full
-                prefs.putInt("fuel_full", fuelRaw);
-                calibrationDetails = "Fuel full: " + String(fuelRaw);
+                writes += putCalibrationInt(prefs, "fuel_full", fuelRaw);
+                snprintf(calibrationDetails, sizeof(calibrationDetails), "Fuel full: %d", fuelRaw);
                 calibrationApplied = true;
             } else {
                 // Mid-range - interpolate between current empty/full
@@ -615,164 +602,267 @@ void setupWebServer() {
                 int newEmpty = (int)(currentEmpty * scaleFactor);
                 int newFull = (int)(currentFull * scaleFactor);
                 
-                prefs.putInt("fuel_empty", newEmpty);
-                prefs.putInt("fuel_full", newFull);
-                calibrationDetails = "Fuel empty: " + String(newEmpty) + ", full: " + String(newFull);
+                writes += putCalibrationInt(prefs, "fuel_empty", newEmpty);
+                writes += putCalibrationInt(prefs, "fuel_full", newFull);
+                snprintf(calibrationDetails, sizeof(calibrationDetails), "Fuel empty: %d, full: %d", newEmpty, newFull);
                 calibrationApplied = true;
             }
         }
         
         prefs.end();
+        g_settingsManager.recordCalibrationWrites(writes);
         
         if (calibrationApplied) {
             // Reload calibration constants immediately
             loadCalibrationConstants();
-            responseDoc["status"] = "success";
-            responseDoc["message"] = "Calibration applied: " + calibrationDetails;
+            char message[96];
+            snprintf(message, sizeof(message), "Calibration applied: %s", calibrationDetails);
+            sendResult(request, 200, "success", message);
         } else {
-            responseDoc["status"] = "error";
-            responseDoc["message"] = "Calibration failed - invalid sensor data or value out of range";
+            sendResult(request, 200, "error", "Calibration failed - invalid sensor data or value out of range");
         }
-        
-        String jsonResponse;
-        serializeJson(responseDoc, jsonResponse);
-        request->send(200, "application/json", jsonResponse);
     });
 
     // Update calibration constants endpoint
     server.on("/api/calibration", HTTP_POST, [](AsyncWebServerRequest *request){
-        StaticJsonDocument<512> responseDoc;
         bool updated = false;
-        String updatedConstants = "";
+        char updatedConstants[192] = "";
+        uint32_t writes = 0;
+
+        // One Preferences session for every parameter in the request
+        Preferences prefs;
+        prefs.begin("calibration", false);
         
         // Handle form-encoded data
         if (request->hasParam("battery_divider", true)) {
-            String value = request->getParam("battery_divider", true)->value();
+            const String& value = request->getParam("battery_divider", true)->value();
             float newDivider = value.toFloat();
             if (newDivider > 0.0001 && newDivider < 1.0) { // Much wider range
-                // Store in preferences for next restart
-                Preferences prefs;
-                prefs.begin("calibration", false);
-                prefs.putFloat("battery_div", newDivider);
-                prefs.end();
-                updatedConstants += "Battery divider: " + String(newDivider, 6) + " ";
+                writes += putCalibrationFloat(prefs, "battery_div", newDivider);
+                appendf(updatedConstants, sizeof(updatedConstants), "Battery divider: %.6f ", newDivider);
                 updated = true;
             }
         }
         
         if (request->hasParam("temp_scale", true)) {
-            String value = request->getParam("temp_scale", true)->value();
+            const String& value = request->getParam("temp_scale", true)->value();
             float newScale = value.toFloat();
             if (newScale > 0.001 && newScale < 10.0) { // Much wider range
-                Preferences prefs;
-                prefs.begin("calibration", false);
-                prefs.putFloat("temp_scale", newScale);
-                prefs.end();
-                updatedConstants += "Temp scale: " + String(newScale, 6) + " ";
+                writes += putCalibrationFloat(prefs, "temp_scale", newScale);
+                appendf(updatedConstants, sizeof(updatedConstants), "Temp scale: %.6f ", newScale);
                 updated = true;
             }
         }
         
         if (request->hasParam("pressure_scale", true)) {
-            String value = request->getParam("pressure_scale", true)->value();
+            const String& value = request->getParam("pressure_scale", true)->value();
             float newScale = value.toFloat();
             if (newScale > 0.001 && newScale < 10.0) { // Much wider range
-                Preferences prefs;
-                prefs.begin("calibration", false);
-                prefs.putFloat("pressure_scale", newScale);
-                prefs.end();
-                updatedConstants += "Pressure scale: " + String(newScale, 6) + " ";
+                writes += putCalibrationFloat(prefs, "pressure_scale", newScale);
+                appendf(updatedConstants, sizeof(updatedConstants), "Pressure scale: %.6f ", newScale);
                 updated = true;
             }
         }
         if (request->hasParam("hyd_pressure_scale", true)) {
-            String value = request->getParam("hyd_pressure_scale", true)->value();
+            const String& value = request->getParam("hyd_pressure_scale", true)->value();
             float newScale = value.toFloat();
             if (newScale > 0.001 && newScale < 10.0) {
-                Preferences prefs;
-                prefs.begin("calibration", false);
-                prefs.putFloat("hyd_pressure_scale", newScale);
-                prefs.end();
-                updatedConstants += "Hydraulic pressure scale: " + String(newScale, 6) + " ";
+                writes += putCalibrationFloat(prefs, "hyd_pressure_scale", newScale);
+                appendf(updatedConstants, sizeof(updatedConstants), "Hydraulic pressure scale: %.6f ", newScale);
                 updated = true;
             }
         }
         
         if (request->hasParam("fuel_empty", true)) {
-            String value = request->getParam("fuel_empty", true)->value();
+            const String& value = request->getParam("fuel_empty", true)->value();
             int newEmpty = value.toInt();
             if (newEmpty >= 0 && newEmpty <= 4095) {
-                Preferences prefs;
-                prefs.begin("calibration", false);
-                prefs.putInt("fuel_empty", newEmpty);
-                prefs.end();
-                updatedConstants += "Fuel empty: " + String(newEmpty) + " ";
+                writes += putCalibrationInt(prefs, "fuel_empty", newEmpty);
+                appendf(updatedConstants, sizeof(updatedConstants), "Fuel empty: %d ", newEmpty);
                 updated = true;
             }
         }
         
         if (request->hasParam("fuel_full", true)) {
-            String value = request->getParam("fuel_full", true)->value();
+            const String& value = request->getParam("fuel_full", true)->value();
             int newFull = value.toInt();
             if (newFull >= 0 && newFull <= 4095) {
-                Preferences prefs;
-                prefs.begin("calibration", false);
-                prefs.putInt("fuel_full", newFull);
-                prefs.end();
-                updatedConstants += "Fuel full: " + String(newFull) + " ";
+                writes += putCalibrationInt(prefs, "fuel_full", newFull);
+                appendf(updatedConstants, sizeof(updatedConstants), "Fuel full: %d ", newFull);
                 updated = true;
             }
         }
         
+        prefs.end();
+        g_settingsManager.recordCalibrationWrites(writes);
+
         if (updated) {
             // Reload calibration constants immediately to apply changes
             loadCalibrationConstants();
-            responseDoc["status"] = "success";
-            responseDoc["message"] = "Calibration updated: " + updatedConstants + "Applied immediately.";
+            char message[240];
+            snprintf(message, sizeof(message), "Calibration updated: %sApplied immediately.", updatedConstants);
+            sendResult(request, 200, "success", message);
         } else {
-            responseDoc["status"] = "error";
-            responseDoc["message"] = "No valid calibration parameters provided or values out of range";
+            sendResult(request, 200, "error", "No valid calibration parameters provided or values out of range");
         }
-        
-        String jsonResponse;
-        serializeJson(responseDoc, jsonResponse);
-        request->send(200, "application/json", jsonResponse);
     });
 
     // Reset calibration to defaults
     server.on("/api/reset-calibration", HTTP_POST, [](AsyncWebServerRequest *request){
-        StaticJsonDocument<256> doc;
         Preferences prefs;
         prefs.begin("calibration", false);
         // Clear all calibration keys in this namespace
         prefs.clear();
         prefs.end();
+        g_settingsManager.recordCalibrationWrites(1);
         // Reload runtime constants from defaults (or stored values if any)
         loadCalibrationConstants();
-        doc["status"] = "success";
-        doc["message"] = "Calibration reset to defaults";
-        String jsonResponse;
-        serializeJson(doc, jsonResponse);
-        request->send(200, "application/json", jsonResponse);
+        sendResult(request, 200, "success", "Calibration reset to defaults");
     });
 
     // WiFi information endpoint
     server.on("/wifi", HTTP_GET, [](AsyncWebServerRequest *request){
-        StaticJsonDocument<256> doc;
-        doc["mode"] = "AP_STA";
-        doc["home_connected"] = (WiFi.status() == WL_CONNECTED);
-        if (WiFi.status() == WL_CONNECTED) {
-            doc["home_ip"] = WiFi.localIP().toString();
-            doc["home_ssid"] = WiFi.SSID();
-            doc["home_rssi"] = WiFi.RSSI();
+        sendJson(request, 200, [](JsonWriter<Print>& json) {
+            json.field(JSON_KEY("mode"), "AP_STA");
+            json.field(JSON_KEY("home_connected"), (WiFi.status() == WL_CONNECTED));
+            if (WiFi.status() == WL_CONNECTED) {
+                IPAddress ip = WiFi.localIP();
+                json.fieldf(JSON_KEY("home_ip"), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+                json.field(JSON_KEY("home_ssid"), WiFi.SSID().c_str());
+                json.field(JSON_KEY("home_rssi"), (int)WiFi.RSSI());
+            }
+            WifiStationStats station = getWifiStationStats();
+            json.field(JSON_KEY("home_attempts"), station.attempts);
+            json.field(JSON_KEY("home_connects"), station.connects);
+            json.field(JSON_KEY("home_disconnects"), station.disconnects);
+            json.field(JSON_KEY("home_timeouts"), station.timeouts);
+            json.field(JSON_KEY("home_last_reason"), (unsigned)station.lastReason);
+            json.field(JSON_KEY("home_retry_delay_ms"), station.retryDelayMs);
+            json.field(JSON_KEY("home_last_connect_ms"), station.lastConnectMs);
+            json.field(JSON_KEY("home_first_connect_at_ms"), station.firstConnectAtMs);
+            json.field(JSON_KEY("home_fast_connect"), station.fastConnect);
+            json.field(JSON_KEY("home_static_ip"), station.staticAddress);
+            json.field(JSON_KEY("ap_ssid"), ssid);
+            IPAddress apIp = WiFi.softAPIP();
+            json.fieldf(JSON_KEY("ap_ip"), "%u.%u.%u.%u", apIp[0], apIp[1], apIp[2], apIp[3]);
+            json.field(JSON_KEY("ap_clients"), (int)WiFi.softAPgetStationNum());
+        });
+    });
+
+    // Boot phase durations and when the controller became usable (µs of
+    // uptime, 0 = not yet), for this boot and the one before it
+    server.on("/api/boot-profile", HTTP_GET, [](AsyncWebServerRequest *request){
+        sendJson(request, 200, [](JsonWriter<Print>& json) {
+            writeBootProfileJson(json, currentBootProfile());
+            json.field(JSON_KEY("resume"), resumeResultName(lastResumeResult()));
+            json.field(JSON_KEY("sleep_cycles"), deepSleepCycles());
+            json.field(JSON_KEY("station_fast_connect"), getWifiStationStats().fastConnect);
+            BootProfile previous;
+            if (previousBootProfile(previous)) {
+                json.beginObject(JSON_KEY("previous"));
+                writeBootProfileJson(json, previous);
+                json.endObject();
+            } else {
+                json.fieldNull(JSON_KEY("previous"));
+            }
+        });
+    });
+
+    // Power profile, time spent in each since boot (ms) and the average
+    // current that implies from the nominal per-profile figures
+    server.on("/api/power", HTTP_GET, [](AsyncWebServerRequest *request){
+        sendJson(request, 200, [](JsonWriter<Print>& json) {
+            PowerStats power = getPowerStats();
+            uint32_t total = power.profileMs[POWER_IDLE] + power.profileMs[POWER_CLIENT] + power.profileMs[POWER_ENGINE];
+            json.field(JSON_KEY("profile"), powerProfileName(power.profile));
+            json.field(JSON_KEY("cpu_mhz"), (unsigned long)getCpuFrequencyMhz());
+            json.field(JSON_KEY("frequency_scaling"), power.frequencyScaling);
+            json.field(JSON_KEY("light_sleep"), power.lightSleep);
+            json.field(JSON_KEY("transitions"), (unsigned long)power.transitions);
+            json.beginObject(JSON_KEY("time_ms"));
+            json.field(JSON_KEY("idle"), (unsigned long)power.profileMs[POWER_IDLE]);
+            json.field(JSON_KEY("client"), (unsigned long)power.profileMs[POWER_CLIENT]);
+            json.field(JSON_KEY("engine"), (unsigned long)power.profileMs[POWER_ENGINE]);
+            json.endObject();
+            // Share of the time at full clock
+            json.field(JSON_KEY("active_duty"), total > 0 ? 1.0 - (double)power.profileMs[POWER_IDLE] / total : 0.0, 3);
+            json.field(JSON_KEY("estimated_current_ma"), estimatedAverageCurrentMa(power), 1);
+
+            // What the ULP saw during the last deep sleep (battery in V,
+            // history oldest first, one entry per ULP_HISTORY_WINDOW)
+            const SleepMonitorReport& sleep = sleepMonitorReport();
+            const CalibrationConstants calibration = getCalibration();
+            json.beginObject(JSON_KEY("deep_sleep"));
+            json.field(JSON_KEY("monitored"), sleep.valid);
+            if (sleep.valid) {
+                json.field(JSON_KEY("wake_reason"), ulpWakeReasonName(sleep.wakeReason));
+                json.field(JSON_KEY("samples"), (unsigned int)sleep.samples);
+                json.field(JSON_KEY("asleep_s"), (unsigned long)sleep.samples * ULP_SAMPLE_INTERVAL / 1000);
+                json.field(JSON_KEY("last_v"), convertBatteryVoltage(sleep.lastRaw, calibration));
+                json.field(JSON_KEY("min_v"), convertBatteryVoltage(sleep.minRaw, calibration));
+                json.field(JSON_KEY("max_v"), convertBatteryVoltage(sleep.maxRaw, calibration));
+                json.beginArray(JSON_KEY("history"));
+                for (uint8_t i = 0; i < sleep.windows; i++) {
+                    json.beginObject();
+                    json.field(JSON_KEY("min_v"), convertBatteryVoltage(sleep.history[i].minRaw, calibration));
+                    json.field(JSON_KEY("max_v"), convertBatteryVoltage(sleep.history[i].maxRaw, calibration));
+                    json.endObject();
+                }
+                json.endArray();
+            }
+            json.endObject();
+        });
+    });
+
+    // Control-loop timing and the tasks on both cores since the last
+    // ?reset=1 (or boot). cpu_pct is null for tasks that don't time
+    // themselves; stack_free is the high-water mark in bytes
+    server.on("/api/tasks", HTTP_GET, [](AsyncWebServerRequest *request){
+        bool reset = request->hasParam("reset");
+        sendJson(request, 200, [](JsonWriter<Print>& json) {
+            ControlTimingStats control = getControlTimingStats();
+            json.field(JSON_KEY("window_ms"), (unsigned long)taskMonitorWindowMs());
+            json.beginObject(JSON_KEY("control"));
+            json.field(JSON_KEY("core"), CONTROL_CORE);
+            json.field(JSON_KEY("priority"), CONTROL_TASK_PRIORITY);
+            json.field(JSON_KEY("passes"), (unsigned long)control.passes);
+            json.field(JSON_KEY("pass_max_us"), (unsigned long)control.passMaxUs);
+            json.field(JSON_KEY("pass_avg_us"), control.passes > 0 ? (unsigned long)(control.passTotalUs / control.passes) : 0UL);
+            json.field(JSON_KEY("deadline_wakes"), (unsigned long)control.deadlineWakes);
+            json.field(JSON_KEY("late_max_us"), (unsigned long)control.lateMaxUs);
+            json.field(JSON_KEY("late_avg_us"), control.deadlineWakes > 0 ? (unsigned long)(control.lateTotalUs / control.deadlineWakes) : 0UL);
+            json.endObject();
+
+            json.beginArray(JSON_KEY("tasks"));
+            for (uint8_t i = 0; i < MONITORED_TASK_COUNT; i++) {
+                MonitoredTask task = (MonitoredTask)i;
+                TaskHandle_t handle = xTaskGetHandle(monitoredTaskName(task));
+                if (handle == nullptr) {
+                    continue;   // Not running (e.g. ADC DMA fell back to analogRead())
+                }
+                BaseType_t core = xTaskGetAffinity(handle);
+                float cpu = taskCpuPercent(task);
+                json.beginObject();
+                json.field(JSON_KEY("name"), monitoredTaskName(task));
+                if (core == tskNO_AFFINITY) {
+                    json.fieldNull(JSON_KEY("core"));
+                } else {
+                    json.field(JSON_KEY("core"), (int)core);
+                }
+                json.field(JSON_KEY("priority"), (unsigned int)uxTaskPriorityGet(handle));
+                json.field(JSON_KEY("stack_free"), (unsigned int)uxTaskGetStackHighWaterMark(handle));
+                if (cpu < 0.0f) {
+                    json.fieldNull(JSON_KEY("cpu_pct"));
+                } else {
+                    json.field(JSON_KEY("cpu_pct"), cpu, 2);
+                }
+                json.endObject();
+            }
+            json.endArray();
+        });
+        if (reset) {
+            resetTaskMonitor();
         }
-        doc["ap_ssid"] = ssid;
-        doc["ap_ip"] = WiFi.softAPIP().toString();
-        doc["ap_clients"] = WiFi.softAPgetStationNum();
-        
-        String jsonResponse;
-        serializeJson(doc, jsonResponse);
-        request->send(200, "application/json", jsonResponse);
     });
 
     // Settings page endpoint
@@ -813,8 +903,13 @@ void setupWebServer() {
 
     // Initialize ElegantOTA
     ElegantOTA.begin(&server);
+    endBootPhase(BOOT_PHASE_ROUTES);
 
     // Start the server
+    startBootPhase(BOOT_PHASE_SERVER);
     server.begin();
-    Serial.println("Web server started");
+    endBootPhase(BOOT_PHASE_SERVER);
+    markBootMilestone(BOOT_HTTP_READY);
+    Serial.printf("Web server started (%lu ms after %s)\n", (unsigned long)(bootMilestoneUs(BOOT_HTTP_READY) / 1000),
+                  bootFromDeepSleep() ? "wake" : "boot");
 }
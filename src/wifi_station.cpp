@@ -0,0 +1,242 @@
+/*
+ * WiFi Station Implementation for Bobcat Ignition Controller
+ * WiFi event callbacks only post notification bits; every decision (when
+ * to retry, with which settings) is taken on the station task, which owns
+ * all the state below
+ */
+
+#include "wifi_station.h"
+#include "boot_profile.h"
+#include "config.h"
+#include "hal.h"
+#include "settings.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include <stddef.h>
+#include <string.h>
+
+// Notification bits for the station task
+constexpr uint32_t STATION_GOT_IP = 1 << 0;
+constexpr uint32_t STATION_DROPPED = 1 << 1;
+constexpr uint32_t STATION_SETTINGS = 1 << 2;
+
+// The station part of BobcatSettings
+struct StationConfig {
+    char ssid[sizeof(BobcatSettings::homeSSID)];
+    char password[sizeof(BobcatSettings::homePassword)];
+    char staticIP[sizeof(BobcatSettings::homeStaticIP)];
+    char gateway[sizeof(BobcatSettings::homeGateway)];
+    char subnet[sizeof(BobcatSettings::homeSubnet)];
+};
+
+// Last good access point. RTC memory survives deep sleep but not a power
+// cycle, so the CRC is what tells a real entry from leftover bits. The
+// address is not cached: a lease installed as a static address would never
+// be renewed and could later be handed to another host.
+struct StationCache {
+    uint32_t network;       // CRC32 of the StationConfig it was made with
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t crc;           // Of everything above
+};
+
+RTC_DATA_ATTR static StationCache stationCache;
+
+static TaskHandle_t stationTask = nullptr;
+static WifiStationStats stats;
+static volatile uint8_t dropReason = 0;   // Written by the event callback
+static StationConfig active;
+
+static void notifyStation(uint32_t bits) {
+    if (stationTask != nullptr) {
+        xTaskNotify(stationTask, bits, eSetBits);
+    }
+}
+
+static void onStationEvent(arduino_event_id_t event, arduino_event_info_t info) {
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+        notifyStation(STATION_GOT_IP);
+    } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+        // Our own disconnect() before switching networks is not a drop
+        if (info.wifi_sta_disconnected.reason == WIFI_REASON_ASSOC_LEAVE) {
+            return;
+        }
+        dropReason = info.wifi_sta_disconnected.reason;
+        notifyStation(STATION_DROPPED);
+    }
+}
+
+// True if the settings differ from the configuration in use
+static bool loadConfig() {
+    BobcatSettings settings = g_settingsManager.getSettings();
+    StationConfig next;
+    memset(&next, 0, sizeof(next));
+    strlcpy(next.ssid, settings.homeSSID, sizeof(next.ssid));
+    strlcpy(next.password, settings.homePassword, sizeof(next.password));
+    strlcpy(next.staticIP, settings.homeStaticIP, sizeof(next.staticIP));
+    strlcpy(next.gateway, settings.homeGateway, sizeof(next.gateway));
+    strlcpy(next.subnet, settings.homeSubnet, sizeof(next.subnet));
+    if (memcmp(&next, &active, sizeof(next)) == 0) {
+        return false;
+    }
+    active = next;
+    return true;
+}
+
+static uint32_t networkId() {
+    return halCrc32(0, &active, sizeof(active));
+}
+
+static bool cacheValid() {
+    return stationCache.crc == halCrc32(0, &stationCache, offsetof(StationCache, crc)) &&
+           stationCache.network == networkId();
+}
+
+static void saveCache() {
+    memcpy(stationCache.bssid, WiFi.BSSID(), sizeof(stationCache.bssid));
+    stationCache.channel = (uint8_t)WiFi.channel();
+    stationCache.network = networkId();
+    stationCache.crc = halCrc32(0, &stationCache, offsetof(StationCache, crc));
+}
+
+static IPAddress toAddress(const char* text) {
+    uint8_t octets[4];
+    return parseIPv4(text, octets) ? IPAddress(octets[0], octets[1], octets[2], octets[3]) : IPAddress();
+}
+
+// `fast`: directed connect from the cache (first attempt after a wake).
+// False if there is no home network to join.
+static bool beginAttempt(uint32_t& attemptStartedAt, bool fast) {
+    if (active.ssid[0] == '\0') {
+        Serial.println("WiFi: no home network configured - access point only");
+        return false;
+    }
+    stats.attempts++;
+    stats.staticAddress = active.staticIP[0] != '\0';
+    attemptStartedAt = millis();
+
+    // Addressing: the configured static address, else DHCP (all zeros),
+    // fast attempt or not
+    if (stats.staticAddress) {
+        IPAddress gateway = toAddress(active.gateway);
+        WiFi.config(toAddress(active.staticIP), gateway, toAddress(active.subnet), gateway);
+    } else {
+        WiFi.config(IPAddress(), IPAddress(), IPAddress());
+    }
+
+    const char* password = active.password[0] != '\0' ? active.password : nullptr;
+    if (fast) {
+        WiFi.begin(active.ssid, password, stationCache.channel, stationCache.bssid);
+    } else {
+        WiFi.begin(active.ssid, password);
+    }
+    return true;
+}
+
+static void stationLoop(void*) {
+    uint32_t attemptStartedAt = 0;
+    uint32_t retryAt = millis();
+    bool retryPending = true;   // First attempt straight away
+    bool attemptPending = false; // Waiting for GOT_IP or DROPPED
+    loadConfig();
+    bool fast = bootFromDeepSleep() && cacheValid();
+    bool attemptFast = false;
+    stats.retryDelayMs = WIFI_RECONNECT_MIN_DELAY;
+
+    for (;;) {
+        TickType_t wait = portMAX_DELAY;
+        if (retryPending || attemptPending) {
+            uint32_t deadline = retryPending ? retryAt : attemptStartedAt + WIFI_ATTEMPT_TIMEOUT;
+            int32_t remaining = (int32_t)(deadline - millis());
+            wait = remaining > 0 ? pdMS_TO_TICKS(remaining) : 0;
+        }
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, wait);
+
+        // An association or DHCP exchange that never reports back is a
+        // failed attempt like any other
+        if (attemptPending && !(events & (STATION_GOT_IP | STATION_DROPPED)) &&
+            millis() - attemptStartedAt >= WIFI_ATTEMPT_TIMEOUT) {
+            stats.timeouts++;
+            dropReason = 0;
+            WiFi.disconnect();
+            events |= STATION_DROPPED;
+        }
+
+        if (events & STATION_GOT_IP) {
+            uint32_t now = millis();
+            stats.connects++;
+            stats.lastConnectMs = now - attemptStartedAt;
+            stats.fastConnect = attemptFast;
+            if (stats.firstConnectAtMs == 0) {
+                stats.firstConnectAtMs = now;
+            }
+            markBootMilestone(BOOT_STATION_IP);
+            stats.retryDelayMs = WIFI_RECONNECT_MIN_DELAY;
+            retryPending = false;
+            attemptPending = false;
+            saveCache();
+            Serial.printf("WiFi: connected to %s as %s (%lu ms%s)\n", active.ssid,
+                          WiFi.localIP().toString().c_str(), (unsigned long)stats.lastConnectMs,
+                          attemptFast ? ", cached channel" : "");
+        }
+
+        if ((events & STATION_DROPPED) && !retryPending) {
+            attemptPending = false;
+            stats.disconnects++;
+            stats.lastReason = dropReason;
+            if (attemptFast) {
+                // The AP moved or changed channel: scan from now on
+                stationCache.crc = 0;
+                retryAt = millis();
+            } else {
+                retryAt = millis() + stats.retryDelayMs;
+                stats.retryDelayMs = stats.retryDelayMs * 2 < WIFI_RECONNECT_MAX_DELAY
+                                         ? stats.retryDelayMs * 2 : WIFI_RECONNECT_MAX_DELAY;
+            }
+            retryPending = true;
+            Serial.printf("WiFi: home network unavailable (reason %u), retry in %ld ms\n",
+                          (unsigned)stats.lastReason, (long)(retryAt - millis()));
+        }
+
+        if ((events & STATION_SETTINGS) && loadConfig()) {
+            Serial.println("WiFi: home network settings changed - reconnecting");
+            if (WiFi.status() == WL_CONNECTED) {
+                WiFi.disconnect();
+            }
+            stats.retryDelayMs = WIFI_RECONNECT_MIN_DELAY;
+            retryAt = millis();
+            retryPending = true;
+            attemptPending = false;
+        }
+
+        if (retryPending && (int32_t)(millis() - retryAt) >= 0) {
+            retryPending = false;   // The outcome arrives as GOT_IP or DROPPED
+            attemptFast = fast && cacheValid();
+            fast = false;
+            attemptPending = beginAttempt(attemptStartedAt, attemptFast);
+        }
+    }
+}
+
+void startWifiStation() {
+    if (stationTask != nullptr) {
+        return;
+    }
+    // Reconnects are ours (with backoff); don't let the core retry in a
+    // tight loop or rewrite the credentials to NVS on every begin()
+    WiFi.setAutoReconnect(false);
+    WiFi.persistent(false);
+    WiFi.onEvent(onStationEvent, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    WiFi.onEvent(onStationEvent, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    xTaskCreatePinnedToCore(stationLoop, "station", WIFI_TASK_STACK_SIZE, nullptr,
+                            WIFI_TASK_PRIORITY, &stationTask, NETWORK_CORE);
+}
+
+void wifiSettingsChanged() {
+    notifyStation(STATION_SETTINGS);
+}
+
+WifiStationStats getWifiStationStats() {
+    return stats;
+}